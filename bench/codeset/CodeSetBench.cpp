@@ -0,0 +1,201 @@
+// IrCodeSet memory use and lookup speed on the host.
+//
+//   pio run -e bench-codeset -t exec
+//
+// Memory is reported as the ESP32 would hold it (4-byte chunk pointers),
+// next to the host's own memoryBytes(). The run fails if the layout
+// stops paying off: an empty set must hold no chunks, a chunk must cost
+// its bitmap and nothing more, full chunks must all share the one in
+// flash (so a linear sweep keeps at most one chunk live), and a set must
+// survive serialize()/deserialize(). Timings are host numbers and only
+// reported; the O(1) paths are the point, not the nanoseconds.
+
+#include <Arduino.h>
+#include <IrCodeSet.h>
+
+#include <chrono>
+#include <vector>
+
+namespace
+{
+
+constexpr uint32_t kNecCodes = 1UL << 16;
+constexpr uint32_t kNecExtendedCodes = 1UL << 24;
+constexpr uint32_t kChunkBytes = IrCodeSet::kChunkBits / 8;
+constexpr uint32_t kLinearCodes = 3000000;
+constexpr uint32_t kRandomCodes = 1000000;
+
+int failures = 0;
+
+void expect(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        printf("  FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+uint32_t chunksFor(uint32_t capacity)
+{
+    return (capacity + IrCodeSet::kChunkBits - 1) / IrCodeSet::kChunkBits;
+}
+
+// Chunk table on the target: a 4-byte pointer and a 2-byte count each.
+size_t targetTableBytes(uint32_t capacity)
+{
+    return chunksFor(capacity) * (4 + sizeof(uint16_t));
+}
+
+size_t hostTableBytes(uint32_t capacity)
+{
+    return chunksFor(capacity) * (sizeof(uint32_t*) + sizeof(uint16_t));
+}
+
+// Bitmap bytes in live (allocated, not full) chunks.
+size_t liveChunkBytes(const IrCodeSet& set)
+{
+    return set.memoryBytes() - hostTableBytes(set.capacity());
+}
+
+double nanosecondsSince(std::chrono::steady_clock::time_point start, uint32_t operations)
+{
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / operations;
+}
+
+uint32_t nextRandom(uint32_t& state)
+{
+    // xorshift32: cheap enough not to swamp what is being timed.
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void empty()
+{
+    printf("Empty sets\n");
+    const uint32_t capacities[] = {1UL << 12, kNecCodes, kNecExtendedCodes};
+    for (uint32_t capacity : capacities)
+    {
+        IrCodeSet set(capacity);
+        printf("  %8lu codes: %4lu chunks, %5lu bytes on target (%lu on host)\n",
+               static_cast<unsigned long>(capacity), static_cast<unsigned long>(chunksFor(capacity)),
+               static_cast<unsigned long>(targetTableBytes(capacity)),
+               static_cast<unsigned long>(set.memoryBytes()));
+        expect(liveChunkBytes(set) == 0, "an empty set holds no chunks");
+    }
+}
+
+void perChunk()
+{
+    printf("Bytes per chunk\n");
+    IrCodeSet set(kNecExtendedCodes);
+    set.set(12345);
+    size_t oneChunk = liveChunkBytes(set);
+    size_t serialized = set.serializedSize();
+    set.set(IrCodeSet::kChunkBits * 7 + 1);
+    size_t twoChunks = liveChunkBytes(set);
+
+    printf("  %lu codes per chunk, %lu bytes each live, %lu bytes serialized with one\n",
+           static_cast<unsigned long>(IrCodeSet::kChunkBits), static_cast<unsigned long>(oneChunk),
+           static_cast<unsigned long>(serialized));
+    expect(oneChunk == kChunkBytes, "a live chunk costs exactly its bitmap");
+    expect(twoChunks == 2 * kChunkBytes, "chunks are allocated independently");
+}
+
+void linearSweep()
+{
+    printf("Linear sweep, %lu codes of extended NEC\n", static_cast<unsigned long>(kLinearCodes));
+    IrCodeSet set(kNecExtendedCodes);
+    size_t peakLive = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t code = 0; code < kLinearCodes; ++code)
+    {
+        set.set(code);
+        if (code % 1024 == 0)
+        {
+            peakLive = max(peakLive, liveChunkBytes(set));
+        }
+    }
+    double setNs = nanosecondsSince(start, kLinearCodes);
+
+    uint32_t fullChunks = kLinearCodes / IrCodeSet::kChunkBits;
+    printf("  %lu full chunks shared, peak %lu live bytes, now %lu bytes on target\n",
+           static_cast<unsigned long>(fullChunks), static_cast<unsigned long>(peakLive),
+           static_cast<unsigned long>(targetTableBytes(set.capacity()) + liveChunkBytes(set)));
+    printf("  %lu bytes serialized, %.1f ns per set\n", static_cast<unsigned long>(set.serializedSize()), setNs);
+    expect(set.count() == kLinearCodes, "every code counted once");
+    expect(peakLive <= kChunkBytes, "at most one chunk live during the sweep");
+    expect(liveChunkBytes(set) <= kChunkBytes, "full chunks point at the shared one");
+
+    // Three bytes per full chunk, the one partial bitmap, and the capacity.
+    size_t expected = sizeof(uint32_t) + fullChunks * 3 +
+                      ((kLinearCodes % IrCodeSet::kChunkBits) != 0 ? 3 + kChunkBytes : 0);
+    expect(set.serializedSize() == expected, "full chunks serialize to three bytes");
+}
+
+void randomCodes()
+{
+    printf("Random codes, %lu of extended NEC\n", static_cast<unsigned long>(kRandomCodes));
+    IrCodeSet set(kNecExtendedCodes);
+    std::vector<uint32_t> codes(kRandomCodes);
+    uint32_t state = 0x2545F491;
+    for (uint32_t& code : codes)
+    {
+        code = nextRandom(state) % kNecExtendedCodes;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t code : codes)
+    {
+        set.set(code);
+    }
+    double setNs = nanosecondsSince(start, kRandomCodes);
+
+    // Half hits (the codes just set), half mostly misses.
+    uint32_t hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < kRandomCodes; ++i)
+    {
+        uint32_t code = (i & 1) ? codes[i] : nextRandom(state) % kNecExtendedCodes;
+        hits += set.test(code) ? 1 : 0;
+    }
+    double testNs = nanosecondsSince(start, kRandomCodes);
+
+    printf("  %lu distinct, %lu bytes on target\n", static_cast<unsigned long>(set.count()),
+           static_cast<unsigned long>(targetTableBytes(set.capacity()) + liveChunkBytes(set)));
+    printf("  %.1f ns per set, %.1f ns per test, %.1f M lookups/s\n", setNs, testNs, 1000.0 / testNs);
+    expect(hits >= kRandomCodes / 2, "every code set tests as set");
+
+    std::vector<uint8_t> bytes(set.serializedSize());
+    IrCodeSet copy;
+    expect(set.serialize(bytes.data(), bytes.size()) == bytes.size() &&
+               copy.deserialize(bytes.data(), bytes.size()),
+           "set serializes and reads back");
+    bool same = copy.count() == set.count();
+    for (uint32_t i = 0; same && i < kRandomCodes; i += 97)
+    {
+        same = copy.test(codes[i]);
+    }
+    expect(same, "the copy holds the same codes");
+}
+
+} // namespace
+
+int main()
+{
+    empty();
+    perChunk();
+    linearSweep();
+    randomCodes();
+
+    if (failures != 0)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
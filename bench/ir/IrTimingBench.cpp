@@ -0,0 +1,228 @@
+// IR waveform and throughput on a virtual clock.
+//
+//   pio run -e bench-ir -t exec
+//
+// The fake RMT driver records every frame with its start time while the
+// clock only moves when the simulated loop says so: drawing costs what
+// the counting M5GFX says the SPI transfer would take, and loop() waits
+// between passes as it does on the device. Frames are checked against
+// the protocol specs, and each scenario reports the timing error, the
+// inter-frame gaps and the frames/s that actually leave the LED, next to
+// how often the screen redrew meanwhile. The run fails if any frame is
+// malformed or sent too close to the previous one, if a hold's period
+// jitters by a millisecond or more, or if the screen redraws faster than
+// its refresh rate.
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <Preferences.h>
+#include <IrBruteforce.h>
+#include <IrRepeatSender.h>
+#include <IrTransmitter.h>
+#include <IrWaveformCheck.h>
+
+namespace
+{
+
+constexpr double kSpiHz = 40000000.0;     // M5GFX write clock on the Plus2
+constexpr uint32_t kLoopOverheadUs = 200; // button and state handling
+constexpr uint32_t kTaskTickUs = 1000;    // FreeRTOS tick the IR task polls at
+constexpr uint32_t kRunUs = 5000000;
+constexpr uint32_t kRefreshHz = 10;
+
+int failures = 0;
+
+void expect(bool ok, const char* what)
+{
+    if (!ok)
+    {
+        printf("  FAIL: %s\n", what);
+        failures++;
+    }
+}
+
+// One device: screen, transmitter and whether the IR task runs it.
+struct Rig
+{
+    M5GFX screen;
+    IrTransmitter transmitter;
+    bool task;
+
+    explicit Rig(bool withTask)
+    : transmitter(19)
+    , task(withTask)
+    {
+        nativeUseVirtualClock(1000000);
+        nativeErasePreferences();
+        screen.setRotation(3);
+        transmitter.begin();
+        transmitter.driver().setAutoFinish(true);
+    }
+
+    // Lets `us` pass. The IR task keeps ticking meanwhile (it runs on the
+    // other core); without it nothing moves until loop() comes round.
+    void pass(uint32_t us)
+    {
+        if (!task)
+        {
+            nativeAdvanceMicros(us);
+            return;
+        }
+        while (us > 0)
+        {
+            uint32_t step = min(us, kTaskTickUs);
+            nativeAdvanceMicros(step);
+            transmitter.tick();
+            us -= step;
+        }
+    }
+
+    // One loop() pass around `work`, timed like main.cpp's.
+    template <typename Work>
+    void loopPass(Work work)
+    {
+        if (!task)
+        {
+            transmitter.tick();
+        }
+
+        screen.resetStats();
+        work();
+        if (task)
+        {
+            // commit() wakes the task straight away.
+            transmitter.tick();
+        }
+
+        uint32_t drawUs = static_cast<uint32_t>(screen.stats().spiBytes * 8 * 1000000.0 / kSpiHz);
+        pass(drawUs + kLoopOverheadUs);
+        pass((task || transmitter.isIdle()) ? 10000 : 1000);
+    }
+};
+
+void necSingle()
+{
+    Rig rig(true);
+    rig.transmitter.sendNEC(0x12, 0x34);
+    while (!rig.transmitter.isIdle())
+    {
+        rig.pass(kTaskTickUs);
+    }
+
+    IrCaptureReport report = irAnalyzeCapture(rig.transmitter.driver(), kIrNecSpec);
+    irPrintCaptureReport("NEC 0x12/0x34", report);
+
+    IrFrameCheck check = irCheckFrame(rig.transmitter.driver().capture(0), kIrNecSpec);
+    expect(check.ok && check.data == 0x12ED34CBULL, "frame decodes to 12 ED 34 CB");
+    expect(report.badFrames == 0, "frame within NEC timing");
+}
+
+void necQueued()
+{
+    Rig rig(true);
+    for (uint8_t i = 0; i < IrTransmitter::kQueueDepth; ++i)
+    {
+        rig.transmitter.sendNEC(0x00, i);
+    }
+    while (!rig.transmitter.isIdle())
+    {
+        rig.pass(kTaskTickUs);
+    }
+
+    IrCaptureReport report = irAnalyzeCapture(rig.transmitter.driver(), kIrNecSpec);
+    irPrintCaptureReport("NEC x8 queued, standard pacing", report);
+    expect(report.badFrames == 0 && report.gapViolations == 0, "frames well formed and spaced");
+    expect(report.periodViolations == 0, "108 ms NEC period kept");
+}
+
+void bruteforce(const char* title, bool task, bool turbo, IrProtocolId protocol, const IrPulseSpec& spec)
+{
+    Rig rig(task);
+    IrBruteforce sweep(rig.screen, rig.transmitter);
+    sweep.setProtocol(protocol);
+    sweep.setTurbo(turbo);
+    sweep.setRefreshHz(kRefreshHz);
+    sweep.start();
+    while (sweep.setupRow() != IrBruteforce::SetupRow::Start)
+    {
+        sweep.moveSetupCursor(1);
+    }
+    sweep.activateSetupRow();
+
+    uint32_t startUs = micros();
+    while (micros() - startUs < kRunUs && sweep.isRunning())
+    {
+        rig.loopPass([&] { sweep.tick(); });
+    }
+    float refreshes = sweep.refreshesPerSecond();
+    sweep.stop();
+
+    IrCaptureReport report = irAnalyzeCapture(rig.transmitter.driver(), spec, !turbo);
+    irPrintCaptureReport(title, report);
+    printf("  %lu codes queued in %.1f s, screen %.1f refreshes/s\n",
+           static_cast<unsigned long>(sweep.codesSent()), kRunUs / 1e6, refreshes);
+    expect(refreshes <= kRefreshHz + 0.5f, "progress redraws held to the refresh rate");
+    expect(report.badFrames == 0, "every frame within spec timing");
+    expect(report.gapViolations == 0, "no frame closer than the minimum gap");
+    expect(report.periodViolations == 0, "protocol period kept");
+}
+
+void hold(const char* title, IrProtocolId protocol, IrRepeatSender::HoldMode mode, const IrPulseSpec& spec)
+{
+    Rig rig(true);
+    IrRepeatSender sender(rig.screen, rig.transmitter);
+    sender.setProtocol(protocol);
+    sender.setHoldMode(mode);
+    sender.setRefreshHz(kRefreshHz);
+    sender.draw();
+    sender.startSending();
+
+    uint32_t startUs = micros();
+    while (micros() - startUs < kRunUs)
+    {
+        rig.loopPass([&] { sender.tick(); });
+    }
+    IrHoldStats stats = sender.holdStats();
+    float refreshes = sender.refreshesPerSecond();
+    sender.stopSending();
+
+    bool repeatCodes = mode == IrRepeatSender::HoldMode::RepeatCodes &&
+                       irProtocolInfo(protocol).repeat == IrRepeatPolicy::RepeatCode;
+    IrCaptureReport report = irAnalyzeCapture(rig.transmitter.driver(), spec);
+    irPrintCaptureReport(title, report);
+    printf("  hold timer: %lu frames, period %.2f ms, jitter %lu us, screen %.1f refreshes/s\n",
+           static_cast<unsigned long>(stats.frames), stats.periodUs / 1000.0,
+           static_cast<unsigned long>(stats.jitterUs()), refreshes);
+    expect(report.badFrames == 0 && report.gapViolations == 0, "frames well formed and spaced");
+    expect(report.periodViolations == 0, "protocol period kept");
+    expect(report.repeatFrames == (repeatCodes ? report.frames - 1 : 0),
+           repeatCodes ? "one full frame, then repeat codes" : "full frames only");
+    expect(stats.frames == report.frames, "hold counted every frame sent");
+    expect(stats.jitterUs() < 1000, "period jitter under a millisecond");
+    expect(refreshes <= kRefreshHz + 0.5f, "status redraws held to the refresh rate");
+}
+
+} // namespace
+
+int main()
+{
+    necSingle();
+    necQueued();
+    bruteforce("Bruteforce NEC, 100 ms delay, loop ticks IR", false, false, IrProtocolId::Nec, kIrNecSpec);
+    bruteforce("Bruteforce NEC turbo, loop ticks IR", false, true, IrProtocolId::Nec, kIrNecSpec);
+    bruteforce("Bruteforce NEC turbo, IR task", true, true, IrProtocolId::Nec, kIrNecSpec);
+    bruteforce("Bruteforce Samsung32 turbo, IR task", true, true, IrProtocolId::Samsung32, kIrSamsung32Spec);
+    bruteforce("Bruteforce Sony12 turbo, IR task", true, true, IrProtocolId::Sony12, kIrSony12Spec);
+    hold("Hold NEC, repeat codes, hold timer", IrProtocolId::Nec, IrRepeatSender::HoldMode::RepeatCodes, kIrNecSpec);
+    hold("Hold NEC, full frames, hold timer", IrProtocolId::Nec, IrRepeatSender::HoldMode::FullFrames, kIrNecSpec);
+    hold("Hold Samsung32, hold timer", IrProtocolId::Samsung32, IrRepeatSender::HoldMode::RepeatCodes,
+         kIrSamsung32Spec);
+    hold("Hold Sony12, hold timer", IrProtocolId::Sony12, IrRepeatSender::HoldMode::RepeatCodes, kIrSony12Spec);
+
+    if (failures != 0)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
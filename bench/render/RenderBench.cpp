@@ -0,0 +1,420 @@
+// Redraw cost of each screen, measured with the counting M5GFX stand-in.
+//
+//   pio run -e bench-render -t exec                   compare with baseline
+//   .pio/build/bench-render/program --update           rewrite the baseline
+//
+// Every operation is run a number of times and its average cost per call
+// is printed. The buffered/ operations draw into a FrameBuffer and count
+// only what present() sends to the panel. The run fails when an operation's SPI bytes per call grow
+// more than kTolerance past baseline.txt, so a change that makes a screen
+// redraw more than it used to is caught before it reaches the device.
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <Preferences.h>
+#include <FrameBuffer.h>
+#include <GlyphAtlas.h>
+#include <IrBruteforce.h>
+#include <IrCodeLibrary.h>
+#include <IrCodeLibraryBuilder.h>
+#include <IrCodeSender.h>
+#include <IrRemote.h>
+#include <IrRepeatSender.h>
+#include <IrTransmitter.h>
+#include <ScrollList.h>
+#include <TextField.h>
+#include <ValueEditor.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+constexpr const char* kDefaultBaseline = "bench/render/baseline.txt";
+constexpr double kTolerance = 0.02;
+constexpr double kSpiHz = 40000000.0; // M5GFX write clock on the Plus2
+constexpr int kCalls = 64;
+
+struct Result
+{
+    std::string name;
+    int calls;
+    M5GFX::Stats total;
+};
+
+std::vector<Result> results;
+
+template <typename Op>
+void measure(M5GFX& screen, const char* name, int calls, Op op)
+{
+    screen.resetStats();
+    for (int i = 0; i < calls; ++i)
+    {
+        op(i);
+    }
+    results.push_back(Result{name, calls, screen.stats()});
+}
+
+const char* const kItems[] = {
+    "Brightness", "Lamp Remote", "IR Bruteforce", "IR Send", "IR Repeat", "Code Library",
+};
+
+const char* const kLongItems[] = {
+    "One", "Two", "Three", "Four", "Five", "Six", "Seven", "Eight", "Nine", "Ten", "Eleven", "Twelve",
+};
+
+const IrCommand kCommands[] = {
+    {"White/Yellow", {IrProtocolId::Nec, 0x00, 0x18}},
+    {"Yellow>White", {IrProtocolId::Nec, 0x00, 0x30}},
+    {"Colorful 1", {IrProtocolId::Nec, 0x00, 0x38}},
+    {"Colorful 2", {IrProtocolId::Nec, 0x00, 0x4A}},
+    {"Off", {IrProtocolId::Nec, 0x00, 0x62}},
+};
+
+// A library the size the partition is meant for: thousands of commands
+// over a few hundred profiles.
+constexpr int kLibraryProfiles = 200;
+constexpr int kLibraryCommands = 40;
+
+void flashCodeLibrary()
+{
+    IrCodeLibraryBuilder builder;
+    char profile[24];
+    char name[24];
+    for (int p = 0; p < kLibraryProfiles; ++p)
+    {
+        snprintf(profile, sizeof(profile), "Device %03d", p);
+        for (int c = 0; c < kLibraryCommands; ++c)
+        {
+            snprintf(name, sizeof(name), "Button %02d", c);
+            builder.add(profile, name, IrProtocolId::Nec, static_cast<uint16_t>(p), static_cast<uint16_t>(c));
+        }
+    }
+    std::vector<uint8_t> image = builder.build();
+    nativeSetPartition(IrCodeLibrary::kPartitionLabel, ESP_PARTITION_TYPE_DATA, IrCodeLibrary::kPartitionSubtype,
+                       image.data(), image.size());
+}
+
+// Rather than wait out the frame spacing the backlog is dropped: only the
+// drawing is being measured.
+void drainTransmitter(IrTransmitter& transmitter)
+{
+    transmitter.tick();
+    if (transmitter.driver().busy())
+    {
+        transmitter.driver().finish();
+    }
+    transmitter.clear();
+}
+
+// Runs the sweep a millisecond at a time until the paced progress view
+// redraws (buffered: until present() sends something).
+void nextRefresh(M5GFX& screen, IrBruteforce& bruteforce, IrTransmitter& transmitter, FrameBuffer* frame)
+{
+    uint32_t before = screen.stats().windows;
+    for (int ticks = 0; screen.stats().windows == before && bruteforce.isRunning() && ticks < 100000; ++ticks)
+    {
+        nativeAdvanceMicros(1000);
+        drainTransmitter(transmitter);
+        bruteforce.tick();
+        if (frame != nullptr)
+        {
+            frame->present();
+        }
+    }
+}
+
+void runScreens(M5GFX& screen)
+{
+    IrTransmitter transmitter(19);
+    transmitter.begin();
+
+    ScrollList list(screen, kItems, sizeof(kItems) / sizeof(kItems[0]));
+    measure(screen, "list/draw", kCalls, [&](int) { list.draw(); });
+    list.draw();
+    measure(screen, "list/move", kCalls, [&](int) {
+        if (list.moveDown(true))
+        {
+            list.update();
+        }
+    });
+
+    // Longer than the screen, so moving scrolls.
+    ScrollList longList(screen, kLongItems, sizeof(kLongItems) / sizeof(kLongItems[0]));
+    longList.draw();
+    measure(screen, "list/scroll", kCalls, [&](int) {
+        if (longList.moveDown(true))
+        {
+            longList.update();
+        }
+    });
+
+    ValueEditor editor(screen);
+    editor.setLabel("Brightness");
+    editor.setSuffix("%");
+    editor.setRange(0, 100);
+    editor.setStep(5);
+    editor.setValue(50);
+    measure(screen, "editor/draw", kCalls, [&](int) { editor.draw(); });
+    measure(screen, "editor/step", kCalls, [&](int i) {
+        if ((i / 10) % 2 ? editor.decrease() : editor.increase())
+        {
+            editor.draw();
+        }
+    });
+
+    IrCommandArray commands(kCommands, sizeof(kCommands) / sizeof(kCommands[0]));
+    IrRemote remote(screen, transmitter, commands);
+    measure(screen, "remote/draw", kCalls, [&](int) { remote.draw(); });
+    remote.draw();
+    measure(screen, "remote/move", kCalls, [&](int) {
+        if (remote.moveDown(true))
+        {
+            remote.update();
+        }
+    });
+    measure(screen, "remote/send", kCalls, [&](int) {
+        remote.sendSelected();
+        drainTransmitter(transmitter);
+    });
+
+    flashCodeLibrary();
+    IrCodeLibrary library;
+    library.begin();
+    IrLibraryProfile profile(library);
+    IrRemote libraryRemote(screen, transmitter, profile);
+    libraryRemote.setTitle(profile.name());
+    measure(screen, "library/draw", kCalls, [&](int) { libraryRemote.draw(); });
+    libraryRemote.draw();
+    measure(screen, "library/move", kCalls, [&](int) {
+        if (libraryRemote.moveDown(true))
+        {
+            libraryRemote.update();
+        }
+    });
+    measure(screen, "library/profile", kCalls, [&](int i) {
+        profile.select(static_cast<size_t>(i) * 7 % library.profileCount());
+        libraryRemote.setTitle(profile.name());
+        libraryRemote.reset();
+        libraryRemote.draw();
+    });
+
+    IrCodeSender sender(screen, transmitter);
+    measure(screen, "send/draw", kCalls, [&](int) { sender.draw(); });
+    measure(screen, "send/next", kCalls, [&](int) { sender.next(); });
+    measure(screen, "send/send", kCalls, [&](int) {
+        sender.send();
+        drainTransmitter(transmitter);
+    });
+    sender.cycleEntry();
+    measure(screen, "send/digit", kCalls, [&](int i) {
+        if (i % 8 == 7)
+        {
+            sender.nextDigit();
+        }
+        else
+        {
+            sender.next();
+        }
+    });
+
+    IrRepeatSender repeater(screen, transmitter);
+    measure(screen, "repeat/draw", kCalls, [&](int) { repeater.draw(); });
+    measure(screen, "repeat/next", kCalls, [&](int) { repeater.next(); });
+
+    IrBruteforce bruteforce(screen, transmitter);
+    bruteforce.setTurbo(true);
+    bruteforce.start();
+    measure(screen, "brute/setup-move", kCalls, [&](int i) { bruteforce.moveSetupCursor((i / 6) % 2 ? -1 : 1); });
+
+    while (bruteforce.setupRow() != IrBruteforce::SetupRow::Start)
+    {
+        bruteforce.moveSetupCursor(1);
+    }
+    bruteforce.activateSetupRow();
+
+    // One paced progress redraw per call.
+    measure(screen, "brute/progress", kCalls, [&](int) {
+        nextRefresh(screen, bruteforce, transmitter, nullptr);
+    });
+    bruteforce.stop();
+}
+
+// The screens main.cpp draws through the back buffer.
+void runBuffered(M5GFX& screen)
+{
+    IrTransmitter transmitter(19);
+    transmitter.begin();
+
+    FrameBuffer frame(screen);
+    if (!frame.begin())
+    {
+        fprintf(stderr, "no memory for the frame buffer\n");
+        return;
+    }
+
+    ValueEditor editor(frame.canvas());
+    editor.setLabel("Brightness");
+    editor.setSuffix("%");
+    editor.setRange(0, 100);
+    editor.setStep(5);
+    editor.setValue(50);
+    editor.draw();
+    frame.present();
+    measure(screen, "buffered/editor-step", kCalls, [&](int i) {
+        if ((i / 10) % 2 ? editor.decrease() : editor.increase())
+        {
+            editor.draw();
+        }
+        frame.present();
+    });
+
+    // The unbuffered run left a checkpoint, which would open the resume
+    // prompt instead of the setup screen.
+    nativeErasePreferences();
+    IrBruteforce bruteforce(frame.canvas(), transmitter);
+    bruteforce.setTurbo(true);
+    bruteforce.start();
+    frame.present();
+    measure(screen, "buffered/brute-setup-move", kCalls, [&](int i) {
+        bruteforce.moveSetupCursor((i / 6) % 2 ? -1 : 1);
+        frame.present();
+    });
+
+    while (bruteforce.setupRow() != IrBruteforce::SetupRow::Start)
+    {
+        bruteforce.moveSetupCursor(1);
+    }
+    bruteforce.activateSetupRow();
+    frame.present();
+
+    measure(screen, "buffered/brute-progress", kCalls, [&](int) {
+        nextRefresh(screen, bruteforce, transmitter, &frame);
+    });
+    bruteforce.stop();
+}
+
+std::map<std::string, double> loadBaseline(const char* path)
+{
+    std::map<std::string, double> baseline;
+    FILE* file = fopen(path, "r");
+    if (file == nullptr)
+    {
+        return baseline;
+    }
+
+    char name[64];
+    double spiBytes;
+    while (fscanf(file, "%63s %lf", name, &spiBytes) == 2)
+    {
+        baseline[name] = spiBytes;
+    }
+    fclose(file);
+    return baseline;
+}
+
+bool saveBaseline(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    for (const Result& result : results)
+    {
+        fprintf(file, "%s %.0f\n", result.name.c_str(), static_cast<double>(result.total.spiBytes) / result.calls);
+    }
+    fclose(file);
+    return true;
+}
+
+// Returns how many operations regressed.
+int report(const std::map<std::string, double>& baseline)
+{
+    int regressions = 0;
+
+    printf("%-26s %6s %6s %9s %6s %9s %6s %10s %7s %10s %7s\n", "per call", "calls", "fills", "fill px", "glyphs",
+           "glyph px", "blits", "SPI bytes", "ms", "baseline", "change");
+    for (const Result& result : results)
+    {
+        double calls = result.calls;
+        double spiBytes = result.total.spiBytes / calls;
+        printf("%-26s %6d %6.1f %9.0f %6.1f %9.0f %6.1f %10.0f %7.2f", result.name.c_str(), result.calls,
+               result.total.fills / calls, result.total.fillPixels / calls, result.total.glyphs / calls,
+               result.total.glyphPixels / calls, result.total.images / calls, spiBytes,
+               spiBytes * 8 * 1000 / kSpiHz);
+
+        auto it = baseline.find(result.name);
+        if (it == baseline.end() || it->second <= 0)
+        {
+            printf(" %10s\n", "-");
+            continue;
+        }
+
+        double change = (spiBytes - it->second) / it->second;
+        bool regressed = change > kTolerance;
+        printf(" %10.0f %+6.1f%%%s\n", it->second, change * 100, regressed ? "  REGRESSED" : "");
+        if (regressed)
+        {
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const char* baselinePath = kDefaultBaseline;
+    bool update = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--update") == 0)
+        {
+            update = true;
+        }
+        else
+        {
+            baselinePath = argv[i];
+        }
+    }
+
+    nativeUseVirtualClock(1000000);
+
+    // As main.cpp sets it up.
+    GlyphAtlas atlas;
+    if (atlas.begin())
+    {
+        TextField::setGlyphAtlas(&atlas);
+    }
+
+    M5GFX screen;
+    screen.init();
+    screen.setRotation(3);
+    runScreens(screen);
+    runBuffered(screen);
+
+    int regressions = report(loadBaseline(baselinePath));
+
+    if (update)
+    {
+        if (!saveBaseline(baselinePath))
+        {
+            fprintf(stderr, "cannot write %s\n", baselinePath);
+            return 2;
+        }
+        printf("baseline written to %s\n", baselinePath);
+        return 0;
+    }
+
+    if (regressions != 0)
+    {
+        printf("%d operation(s) over baseline by more than %.0f%%\n", regressions, kTolerance * 100);
+        return 1;
+    }
+    return 0;
+}
@@ -11,14 +11,18 @@ Button::Button(uint8_t pin, uint16_t debounce_ms)
 :  _pin(pin)
 ,  _delay(debounce_ms)
 ,  _state(HIGH)
-,  _ignore_until(0)
+,  _changed_at(0)
 ,  _has_changed(false)
+,  _edge_driven(false)
+,  _level(HIGH)
+,  _press_latched(false)
 {
 }
 
 void Button::begin()
 {
 	pinMode(_pin, INPUT_PULLUP);
+	_changed_at = millis() - _delay;
 }
 
 // 
@@ -27,23 +31,25 @@ void Button::begin()
 
 bool Button::read()
 {
-	// ignore pin changes until after this delay time
-	if (_ignore_until > millis())
-	{
-		// ignore any changes during this period
-	}
-	
-	// pin has changed 
-	else if (digitalRead(_pin) != _state)
-	{
-		_ignore_until = millis() + _delay;
-		_state = !_state;
-		_has_changed = true;
-	}
-	
+	bool level = _edge_driven ? _level : digitalRead(_pin);
+	accept(level, millis());
 	return _state;
 }
 
+void Button::on_edge(bool level, uint32_t time_ms)
+{
+	_edge_driven = true;
+	_level = level;
+	
+	// debounce on the edge's own timestamp, not on when it is handled
+	accept(level, time_ms);
+}
+
+bool Button::settling() const
+{
+	return _edge_driven && _level != _state;
+}
+
 // has the button been toggled from on -> off, or vice versa
 bool Button::toggled()
 {
@@ -57,19 +63,51 @@ bool Button::has_changed()
 	if (_has_changed)
 	{
 		_has_changed = false;
+		_press_latched = false;
 		return true;
 	}
 	return false;
 }
 
 // has the button gone from off -> on
+// (latched, so a tap released before anyone looked still counts once)
 bool Button::pressed()
 {
-	return (read() == PRESSED && has_changed());
+	read();
+	if (_press_latched)
+	{
+		_press_latched = false;
+		_has_changed = false;
+		return true;
+	}
+	return false;
 }
 
 // has the button gone from on -> off
 bool Button::released()
 {
 	return (read() == RELEASED && has_changed());
-}
\ No newline at end of file
+}
+
+// 
+// private methods
+// 
+
+bool Button::accept(bool level, uint32_t time_ms)
+{
+	// ignore pin changes for this delay time after the last one (elapsed
+	// time is unsigned, so this survives millis() wrapping)
+	if (time_ms - _changed_at < _delay || level == _state)
+	{
+		return false;
+	}
+	
+	_changed_at = time_ms;
+	_state = level;
+	_has_changed = true;
+	if (_state == PRESSED)
+	{
+		_press_latched = true;
+	}
+	return true;
+}
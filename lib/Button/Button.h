@@ -19,6 +19,12 @@ class Button
 		bool released();
 		bool has_changed();
 		
+		// feed a timestamped pin edge (e.g. from ButtonInput); from then on
+		// read() debounces these instead of polling the pin
+		void on_edge(bool level, uint32_t time_ms);
+		// true while the pin and the debounced state disagree
+		bool settling() const;
+		
 		const static bool PRESSED = LOW;
 		const static bool RELEASED = HIGH;
 	
@@ -26,8 +32,13 @@ class Button
 		uint8_t  _pin;
 		uint16_t _delay;
 		bool     _state;
-		uint32_t _ignore_until;
+		uint32_t _changed_at;
 		bool     _has_changed;
+		bool     _edge_driven;
+		bool     _level;
+		bool     _press_latched;
+		
+		bool accept(bool level, uint32_t time_ms);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "ButtonGestures.h"
+
+ButtonGestures::ButtonGestures(Button* const* buttons, size_t count)
+: states_()
+, count_((count < kMaxButtons) ? count : kMaxButtons)
+, repeatDelayMs_(500)
+, repeatIntervalMs_(33)
+, longPressMs_(3000)
+, eventHead_(0)
+, eventCount_(0)
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        buttons_[i] = buttons[i];
+    }
+}
+
+void ButtonGestures::setRepeat(uint32_t delayMs, uint32_t intervalMs)
+{
+    repeatDelayMs_ = delayMs;
+    repeatIntervalMs_ = intervalMs;
+}
+
+void ButtonGestures::setLongPressMs(uint32_t longPressMs)
+{
+    longPressMs_ = longPressMs;
+}
+
+void ButtonGestures::tick(uint32_t now)
+{
+    for (uint8_t i = 0; i < count_; ++i)
+    {
+        Button& button = *buttons_[i];
+        bool down = (button.read() == Button::PRESSED);
+
+        // pressed() is latched, so this also catches a tap that was
+        // released again before this tick.
+        if (button.pressed())
+        {
+            if (states_[i].down)
+            {
+                release(i, now);
+            }
+            press(i, now);
+        }
+        button.has_changed();
+
+        if (!states_[i].down)
+        {
+            continue;
+        }
+
+        if (!down)
+        {
+            release(i, now);
+        }
+        else
+        {
+            holdTimers(i, now);
+        }
+    }
+}
+
+bool ButtonGestures::poll(GestureEvent& event)
+{
+    if (eventCount_ == 0)
+    {
+        return false;
+    }
+
+    event = events_[eventHead_];
+    eventHead_ = (eventHead_ + 1) % kQueueDepth;
+    eventCount_--;
+    return true;
+}
+
+void ButtonGestures::suppressHeld()
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        states_[i].consumed = states_[i].down;
+    }
+    eventCount_ = 0;
+}
+
+bool ButtonGestures::held(uint8_t button) const
+{
+    return button < count_ && states_[button].down;
+}
+
+bool ButtonGestures::anyHeld() const
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        if (states_[i].down)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ButtonGestures::press(uint8_t button, uint32_t now)
+{
+    State& state = states_[button];
+    state.down = true;
+    state.consumed = false;
+    state.longFired = false;
+    state.pressMs = now;
+    state.lastRepeatMs = now;
+
+    emit(GestureEvent{GestureType::Press, button, button, false, 1, 0});
+
+    for (uint8_t other = 0; other < count_; ++other)
+    {
+        if (other != button && states_[other].down && !states_[other].consumed)
+        {
+            state.consumed = true;
+            states_[other].consumed = true;
+            emit(GestureEvent{GestureType::Chord, button, other, false, 1, now - states_[other].pressMs});
+            return;
+        }
+    }
+}
+
+void ButtonGestures::release(uint8_t button, uint32_t now)
+{
+    State& state = states_[button];
+    state.down = false;
+    emit(GestureEvent{GestureType::Release, button, button, state.consumed || state.longFired, 1,
+                      now - state.pressMs});
+}
+
+void ButtonGestures::holdTimers(uint8_t button, uint32_t now)
+{
+    State& state = states_[button];
+    if (state.consumed)
+    {
+        return;
+    }
+
+    uint32_t heldMs = now - state.pressMs;
+    if (!state.longFired && heldMs >= longPressMs_)
+    {
+        state.longFired = true;
+        emit(GestureEvent{GestureType::LongPress, button, button, false, 1, heldMs});
+    }
+
+    if (heldMs >= repeatDelayMs_ && now - state.lastRepeatMs >= repeatIntervalMs_)
+    {
+        state.lastRepeatMs = now;
+        emit(GestureEvent{GestureType::Repeat, button, button, false, repeatSteps(heldMs), heldMs});
+    }
+}
+
+uint16_t ButtonGestures::repeatSteps(uint32_t heldMs) const
+{
+    // x4 per kAccelerateEveryMs of repeating: 1, 4, 16, 64, 256.
+    uint32_t shift = 2 * ((heldMs - repeatDelayMs_) / kAccelerateEveryMs);
+    if (shift >= 8)
+    {
+        return kMaxRepeatSteps;
+    }
+    return static_cast<uint16_t>(1U << shift);
+}
+
+void ButtonGestures::emit(const GestureEvent& event)
+{
+    if (eventCount_ == kQueueDepth)
+    {
+        return;
+    }
+
+    events_[(eventHead_ + eventCount_) % kQueueDepth] = event;
+    eventCount_++;
+}
@@ -0,0 +1,86 @@
+#ifndef BUTTON_GESTURES_H
+#define BUTTON_GESTURES_H
+
+#include <Arduino.h>
+#include <Button.h>
+
+enum class GestureType : uint8_t
+{
+    Press,
+    Release,
+    Repeat,    // while held, after the repeat delay
+    LongPress, // once per press, after the long-press time
+    Chord,     // a second button went down while the first was held
+};
+
+struct GestureEvent
+{
+    GestureType type;
+    uint8_t button;  // index into the buttons given to ButtonGestures
+    uint8_t other;   // Chord: the button that was already held
+    bool consumed;   // Release: a LongPress or Chord already used this press
+    uint16_t steps;  // Repeat: how far to move; grows the longer it is held
+    uint32_t heldMs; // time since the press
+};
+
+// Turns a few debounced Buttons into typed events. tick() samples each
+// button once and queues whatever happened; the screens then poll() for
+// events instead of each keeping its own hold and repeat timers.
+//
+// Repeat events start after the repeat delay at a fixed interval; their
+// step count multiplies every kAccelerateEveryMs of holding, so a held
+// button can cross a large code space in seconds. Once a press is used by
+// a Chord (or suppressHeld()) it raises nothing more until released.
+class ButtonGestures
+{
+  public:
+    static constexpr size_t kMaxButtons = 4;
+    static constexpr size_t kQueueDepth = 8;
+    static constexpr uint32_t kAccelerateEveryMs = 1000;
+    static constexpr uint16_t kMaxRepeatSteps = 256;
+
+    ButtonGestures(Button* const* buttons, size_t count);
+
+    void setRepeat(uint32_t delayMs, uint32_t intervalMs);
+    void setLongPressMs(uint32_t longPressMs);
+
+    void tick(uint32_t now);
+    bool poll(GestureEvent& event);
+
+    // Marks every held button as consumed and drops queued events, so a
+    // press that switched screens does not act again on the new one.
+    void suppressHeld();
+
+    bool held(uint8_t button) const;
+    bool anyHeld() const;
+
+  private:
+    struct State
+    {
+        bool down;
+        bool consumed;
+        bool longFired;
+        uint32_t pressMs;
+        uint32_t lastRepeatMs;
+    };
+
+    void press(uint8_t button, uint32_t now);
+    void release(uint8_t button, uint32_t now);
+    void holdTimers(uint8_t button, uint32_t now);
+    uint16_t repeatSteps(uint32_t heldMs) const;
+    void emit(const GestureEvent& event);
+
+    Button* buttons_[kMaxButtons];
+    State states_[kMaxButtons];
+    size_t count_;
+
+    uint32_t repeatDelayMs_;
+    uint32_t repeatIntervalMs_;
+    uint32_t longPressMs_;
+
+    GestureEvent events_[kQueueDepth];
+    size_t eventHead_;
+    size_t eventCount_;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#ifdef ESP32
+
+#include "ButtonInput.h"
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <esp_timer.h>
+
+ButtonInput::ButtonInput(const uint8_t* pins, size_t count)
+: queue_(nullptr)
+, count_((count < kMaxPins) ? count : kMaxPins)
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        slots_[i] = PinSlot{this, pins[i], HIGH};
+    }
+}
+
+bool ButtonInput::begin()
+{
+    if (queue_ == nullptr)
+    {
+        queue_ = xQueueCreate(kQueueDepth, sizeof(ButtonEdge));
+        if (queue_ == nullptr)
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < count_; ++i)
+    {
+        pinMode(slots_[i].pin, INPUT_PULLUP);
+        slots_[i].level = digitalRead(slots_[i].pin);
+        attachInterruptArg(slots_[i].pin, &ButtonInput::onInterrupt, &slots_[i], CHANGE);
+    }
+    return true;
+}
+
+bool ButtonInput::next(ButtonEdge& edge, uint32_t timeoutMs)
+{
+    if (queue_ == nullptr)
+    {
+        delay(timeoutMs);
+        return false;
+    }
+    return xQueueReceive(queue_, &edge, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+}
+
+bool ButtonInput::anyPressed() const
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        if (gpio_get_level(static_cast<gpio_num_t>(slots_[i].pin)) == LOW)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ButtonInput::lightSleep(uint32_t timeoutMs)
+{
+    // A held button would wake us straight away.
+    if (anyPressed())
+    {
+        return false;
+    }
+
+    // The edge interrupts stay masked while the pins are switched to the
+    // level trigger light sleep needs.
+    for (size_t i = 0; i < count_; ++i)
+    {
+        gpio_num_t pin = static_cast<gpio_num_t>(slots_[i].pin);
+        gpio_intr_disable(pin);
+        gpio_wakeup_enable(pin, GPIO_INTR_LOW_LEVEL);
+    }
+    esp_sleep_enable_gpio_wakeup();
+    if (timeoutMs != 0)
+    {
+        esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(timeoutMs) * 1000);
+    }
+
+    bool slept = esp_light_sleep_start() == ESP_OK;
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_ALL);
+    for (size_t i = 0; i < count_; ++i)
+    {
+        gpio_num_t pin = static_cast<gpio_num_t>(slots_[i].pin);
+        gpio_wakeup_disable(pin);
+        gpio_set_intr_type(pin, GPIO_INTR_ANYEDGE);
+        gpio_intr_enable(pin);
+    }
+
+    // The press that woke us raised no edge interrupt.
+    queueCurrentLevels();
+    return slept;
+}
+
+bool ButtonInput::pushEdge(PinSlot& slot, uint8_t level, uint32_t timeMs)
+{
+    if (level == slot.level)
+    {
+        return false;
+    }
+
+    ButtonEdge edge{slot.pin, level, timeMs};
+    if (xQueueSend(queue_, &edge, 0) != pdTRUE)
+    {
+        return false;
+    }
+    slot.level = level;
+    return true;
+}
+
+void ButtonInput::queueCurrentLevels()
+{
+    uint32_t now = millis();
+    for (size_t i = 0; i < count_; ++i)
+    {
+        uint8_t level = gpio_get_level(static_cast<gpio_num_t>(slots_[i].pin)) ? HIGH : LOW;
+
+        // Slots are shared with the ISR; keep it out while we compare.
+        gpio_intr_disable(static_cast<gpio_num_t>(slots_[i].pin));
+        pushEdge(slots_[i], level, now);
+        gpio_intr_enable(static_cast<gpio_num_t>(slots_[i].pin));
+    }
+}
+
+void IRAM_ATTR ButtonInput::onInterrupt(void* arg)
+{
+    PinSlot* slot = static_cast<PinSlot*>(arg);
+    uint8_t level = gpio_get_level(static_cast<gpio_num_t>(slot->pin)) ? HIGH : LOW;
+    if (level == slot->level)
+    {
+        return;
+    }
+
+    ButtonEdge edge{slot->pin, level, static_cast<uint32_t>(esp_timer_get_time() / 1000)};
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(slot->owner->queue_, &edge, &woken) == pdTRUE)
+    {
+        slot->level = level;
+    }
+    if (woken == pdTRUE)
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef BUTTON_INPUT_H
+#define BUTTON_INPUT_H
+
+#include <Arduino.h>
+
+#ifdef ESP32
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#endif
+
+// One pin change as seen by the GPIO interrupt.
+struct ButtonEdge
+{
+    uint8_t pin;
+    uint8_t level;   // HIGH or LOW after the change
+    uint32_t timeMs; // millis() when it happened
+};
+
+// Interrupt-driven button pins. Every edge is timestamped in the ISR and
+// queued, so the loop can block in next() instead of polling and still
+// debounce on when an edge happened rather than when it got looked at.
+// Off-target builds get a fake whose edges are injected by hand.
+class ButtonInput
+{
+  public:
+    static constexpr size_t kMaxPins = 4;
+    static constexpr size_t kQueueDepth = 16;
+
+    ButtonInput(const uint8_t* pins, size_t count);
+
+    // Configures the pins as pulled-up inputs and attaches the interrupts.
+    bool begin();
+
+    // Waits up to `timeoutMs` for the next edge. Returns false on timeout.
+    bool next(ButtonEdge& edge, uint32_t timeoutMs);
+
+    // Any pin currently held low.
+    bool anyPressed() const;
+
+    // Light-sleeps until a button goes low or `timeoutMs` passes (0 = no
+    // timeout). Skipped, returning false, while a button is held. Edges
+    // for whatever is pressed on wake are queued as usual.
+    bool lightSleep(uint32_t timeoutMs);
+
+#ifndef ESP32
+    // Fake input: queue an edge as the ISR would.
+    bool inject(uint8_t pin, uint8_t level, uint32_t timeMs);
+#endif
+
+  private:
+    struct PinSlot
+    {
+        ButtonInput* owner;
+        uint8_t pin;
+        uint8_t level; // last level queued, to drop repeats
+    };
+
+    bool pushEdge(PinSlot& slot, uint8_t level, uint32_t timeMs);
+
+#ifdef ESP32
+    static void IRAM_ATTR onInterrupt(void* arg);
+    void queueCurrentLevels();
+
+    QueueHandle_t queue_;
+#else
+    ButtonEdge edges_[kQueueDepth];
+    size_t edgeHead_;
+    size_t edgeCount_;
+#endif
+
+    PinSlot slots_[kMaxPins];
+    size_t count_;
+};
+
+#endif
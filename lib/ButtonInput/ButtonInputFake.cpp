@@ -0,0 +1,84 @@
+#ifndef ESP32
+
+#include "ButtonInput.h"
+
+ButtonInput::ButtonInput(const uint8_t* pins, size_t count)
+: edgeHead_(0)
+, edgeCount_(0)
+, count_((count < kMaxPins) ? count : kMaxPins)
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        slots_[i] = PinSlot{this, pins[i], HIGH};
+    }
+}
+
+bool ButtonInput::begin()
+{
+    return true;
+}
+
+bool ButtonInput::next(ButtonEdge& edge, uint32_t timeoutMs)
+{
+    if (edgeCount_ == 0)
+    {
+        delay(timeoutMs);
+        return false;
+    }
+
+    edge = edges_[edgeHead_];
+    edgeHead_ = (edgeHead_ + 1) % kQueueDepth;
+    edgeCount_--;
+    return true;
+}
+
+bool ButtonInput::anyPressed() const
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        if (slots_[i].level == LOW)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ButtonInput::lightSleep(uint32_t timeoutMs)
+{
+    if (anyPressed())
+    {
+        return false;
+    }
+
+    // Nothing wakes the fake early.
+    delay(timeoutMs);
+    return true;
+}
+
+bool ButtonInput::inject(uint8_t pin, uint8_t level, uint32_t timeMs)
+{
+    for (size_t i = 0; i < count_; ++i)
+    {
+        if (slots_[i].pin == pin)
+        {
+            return pushEdge(slots_[i], level, timeMs);
+        }
+    }
+    return false;
+}
+
+bool ButtonInput::pushEdge(PinSlot& slot, uint8_t level, uint32_t timeMs)
+{
+    if (level == slot.level || edgeCount_ == kQueueDepth)
+    {
+        return false;
+    }
+
+    edges_[(edgeHead_ + edgeCount_) % kQueueDepth] = ButtonEdge{slot.pin, level, timeMs};
+    edgeCount_++;
+    slot.level = level;
+    return true;
+}
+
+#endif
@@ -0,0 +1,186 @@
+#include "FrameBuffer.h"
+#include <stdlib.h>
+
+FrameBuffer::FrameBuffer(M5GFX& display)
+: display_(display)
+, canvas_(&display)
+, hashes_(nullptr)
+, blocksPerRow_(0)
+, stale_(true)
+, transferring_(false)
+{
+}
+
+FrameBuffer::~FrameBuffer()
+{
+    end();
+}
+
+bool FrameBuffer::begin()
+{
+    if (active())
+    {
+        return true;
+    }
+
+    int32_t width = display_.width();
+    int32_t height = display_.height();
+    blocksPerRow_ = (width + kBlockWidth - 1) / kBlockWidth;
+    hashes_ = static_cast<uint32_t*>(calloc(static_cast<size_t>(blocksPerRow_) * height, sizeof(uint32_t)));
+    if (hashes_ == nullptr)
+    {
+        return false;
+    }
+
+    canvas_.setColorDepth(16);
+    canvas_.setPsram(false);
+    if (canvas_.createSprite(width, height) == nullptr)
+    {
+        canvas_.setPsram(true);
+        if (canvas_.createSprite(width, height) == nullptr)
+        {
+            free(hashes_);
+            hashes_ = nullptr;
+            return false;
+        }
+    }
+
+    stale_ = true;
+    return true;
+}
+
+void FrameBuffer::end()
+{
+    if (!active())
+    {
+        return;
+    }
+
+    waitPresented();
+    canvas_.deleteSprite();
+    free(hashes_);
+    hashes_ = nullptr;
+}
+
+bool FrameBuffer::active() const
+{
+    return hashes_ != nullptr;
+}
+
+lgfx::LovyanGFX& FrameBuffer::canvas()
+{
+    return canvas_;
+}
+
+void FrameBuffer::invalidate()
+{
+    stale_ = true;
+}
+
+bool FrameBuffer::present()
+{
+    if (!active())
+    {
+        return false;
+    }
+
+    waitPresented();
+
+    const uint16_t* pixels = static_cast<const uint16_t*>(canvas_.getBuffer());
+    int32_t width = canvas_.width();
+    int32_t height = canvas_.height();
+    bool changed = false;
+
+    // Rows [top, y) changed somewhere in blocks [firstBlock, lastBlock].
+    int32_t top = -1;
+    int32_t firstBlock = 0;
+    int32_t lastBlock = 0;
+    for (int32_t y = 0; y <= height; ++y)
+    {
+        int32_t rowFirst = blocksPerRow_;
+        int32_t rowLast = -1;
+        if (y < height)
+        {
+            const uint16_t* row = pixels + static_cast<size_t>(y) * width;
+            uint32_t* seen = hashes_ + static_cast<size_t>(y) * blocksPerRow_;
+            for (int32_t block = 0; block < blocksPerRow_; ++block)
+            {
+                int32_t x = block * kBlockWidth;
+                uint32_t hash = hashBlock(row + x, std::min(kBlockWidth, width - x));
+                if (hash != seen[block] || stale_)
+                {
+                    seen[block] = hash;
+                    rowFirst = std::min(rowFirst, block);
+                    rowLast = block;
+                }
+            }
+        }
+
+        if (rowLast >= 0)
+        {
+            if (top < 0)
+            {
+                top = y;
+                firstBlock = rowFirst;
+                lastBlock = rowLast;
+            }
+            else
+            {
+                firstBlock = std::min(firstBlock, rowFirst);
+                lastBlock = std::max(lastBlock, rowLast);
+            }
+        }
+        else if (top >= 0)
+        {
+            pushRegion(pixels, top, y, firstBlock, lastBlock);
+            changed = true;
+            top = -1;
+        }
+    }
+
+    stale_ = false;
+    return changed;
+}
+
+void FrameBuffer::waitPresented()
+{
+    if (!transferring_)
+    {
+        return;
+    }
+
+    display_.waitDMA();
+    display_.endWrite();
+    transferring_ = false;
+}
+
+uint32_t FrameBuffer::hashBlock(const uint16_t* pixels, int32_t count) const
+{
+    // FNV-1a
+    uint32_t hash = 2166136261UL;
+    for (int32_t i = 0; i < count; ++i)
+    {
+        hash = (hash ^ pixels[i]) * 16777619UL;
+    }
+    return hash;
+}
+
+void FrameBuffer::pushRegion(const uint16_t* pixels, int32_t top, int32_t bottom,
+                             int32_t firstBlock, int32_t lastBlock)
+{
+    if (!transferring_)
+    {
+        display_.startWrite();
+        transferring_ = true;
+    }
+
+    // The clip rect narrows the push to the changed blocks; the source
+    // rows stay full canvas width.
+    int32_t width = canvas_.width();
+    int32_t left = firstBlock * kBlockWidth;
+    int32_t right = std::min(width, (lastBlock + 1) * kBlockWidth);
+    display_.setClipRect(left, top, right - left, bottom - top);
+    display_.pushImageDMA(0, top, width, bottom - top,
+                          reinterpret_cast<const lgfx::swap565_t*>(pixels + static_cast<size_t>(top) * width));
+    display_.clearClipRect();
+}
@@ -0,0 +1,63 @@
+#ifndef FRAME_BUFFER_H
+#define FRAME_BUFFER_H
+
+#include <Arduino.h>
+#include <M5GFX.h>
+
+// Optional back buffer for the display. Screens built on canvas() draw
+// into a full-screen 16-bit M5Canvas in RAM instead of the panel, so a
+// clear and redraw is never seen half done. present() then sends only
+// what changed by DMA and returns while the transfer runs.
+//
+// Changes are found by hashing the canvas in kBlockWidth-pixel blocks
+// per row and comparing with the hashes of the last present. Each run of
+// changed rows is pushed as one rectangle spanning its changed blocks.
+//
+// The buffer (width x height x 2 bytes, 64.8 KB landscape) is only held
+// between begin() and end(), so screens that do not need it cost no RAM.
+class FrameBuffer
+{
+  public:
+    static constexpr int32_t kBlockWidth = 24;
+
+    explicit FrameBuffer(M5GFX& display);
+    ~FrameBuffer();
+
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    // Allocates the canvas at the display's current size, from internal
+    // RAM if possible (DMA reads it directly) and PSRAM otherwise. Returns
+    // false without the memory; the canvas then draws nothing.
+    bool begin();
+    void end();
+    bool active() const;
+
+    lgfx::LovyanGFX& canvas();
+
+    // The panel no longer shows the canvas (another screen drew on it), so
+    // the next present() sends all of it.
+    void invalidate();
+
+    // Starts sending the changed regions. Returns true if anything changed.
+    bool present();
+
+    // The canvas must not be drawn on while a present() is being sent.
+    // Blocks until it has been; call before drawing again.
+    void waitPresented();
+
+  private:
+    uint32_t hashBlock(const uint16_t* pixels, int32_t count) const;
+    void pushRegion(const uint16_t* pixels, int32_t top, int32_t bottom,
+                    int32_t firstBlock, int32_t lastBlock);
+
+    M5GFX& display_;
+    M5Canvas canvas_;
+
+    uint32_t* hashes_;  // per row, per block, as last presented
+    int32_t blocksPerRow_;
+    bool stale_;        // the panel shows something else
+    bool transferring_; // bus held for a DMA started by present()
+};
+
+#endif
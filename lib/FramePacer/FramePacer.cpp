@@ -0,0 +1,66 @@
+#include "FramePacer.h"
+
+FramePacer::FramePacer(uint32_t rateHz)
+: rateHz_(0)
+, intervalMs_(0)
+, dirty_(false)
+, lastPresentMs_(0)
+, windowStartMs_(0)
+, windowFrames_(0)
+, achievedHz_(0.0f)
+{
+    setRateHz(rateHz);
+}
+
+void FramePacer::setRateHz(uint32_t rateHz)
+{
+    rateHz_ = rateHz;
+    intervalMs_ = (rateHz == 0) ? 0 : 1000 / rateHz;
+}
+
+uint32_t FramePacer::rateHz() const
+{
+    return rateHz_;
+}
+
+void FramePacer::invalidate()
+{
+    dirty_ = true;
+}
+
+bool FramePacer::dirty() const
+{
+    return dirty_;
+}
+
+bool FramePacer::due(uint32_t nowMs) const
+{
+    return dirty_ && rateHz_ != 0 && nowMs - lastPresentMs_ >= intervalMs_;
+}
+
+void FramePacer::presented(uint32_t nowMs)
+{
+    dirty_ = false;
+    lastPresentMs_ = nowMs;
+
+    uint32_t elapsed = nowMs - windowStartMs_;
+    if (elapsed >= 2 * kWindowMs)
+    {
+        // Idle for a while: start counting afresh.
+        windowStartMs_ = nowMs;
+        windowFrames_ = 0;
+        achievedHz_ = 0.0f;
+    }
+    else if (elapsed >= kWindowMs)
+    {
+        achievedHz_ = windowFrames_ * 1000.0f / elapsed;
+        windowStartMs_ = nowMs;
+        windowFrames_ = 0;
+    }
+    windowFrames_++;
+}
+
+float FramePacer::achievedHz() const
+{
+    return achievedHz_;
+}
@@ -0,0 +1,45 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <Arduino.h>
+
+// Paces a screen's refreshes independently of how often its state
+// changes. Changes only invalidate(); the owner redraws when due() and
+// then calls presented(), so any number of changes between two
+// refreshes cost one redraw. A rate of 0 stops refreshing altogether,
+// for when nobody can see the screen.
+class FramePacer
+{
+  public:
+    explicit FramePacer(uint32_t rateHz = 10);
+
+    void setRateHz(uint32_t rateHz);
+    uint32_t rateHz() const;
+
+    void invalidate();
+    bool dirty() const;
+
+    // Invalidated, refreshing is on and a full interval has passed since
+    // the last refresh.
+    bool due(uint32_t nowMs) const;
+
+    // A refresh was drawn, paced or not.
+    void presented(uint32_t nowMs);
+
+    // Refreshes per second actually drawn, over the last whole second.
+    float achievedHz() const;
+
+  private:
+    static constexpr uint32_t kWindowMs = 1000;
+
+    uint32_t rateHz_;
+    uint32_t intervalMs_;
+    bool dirty_;
+    uint32_t lastPresentMs_;
+
+    uint32_t windowStartMs_;
+    uint32_t windowFrames_;
+    float achievedHz_;
+};
+
+#endif
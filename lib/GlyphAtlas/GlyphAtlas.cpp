@@ -0,0 +1,133 @@
+#include "GlyphAtlas.h"
+
+namespace
+{
+
+// pushImage() takes a uint16_t image in the panel's byte order (what a
+// sprite holds), not the CPU's RGB565 that colours are given in.
+inline uint16_t panelOrder(uint16_t color)
+{
+    return static_cast<uint16_t>((color << 8) | (color >> 8));
+}
+
+} // namespace
+
+GlyphAtlas::GlyphAtlas()
+: masks_{}
+, ready_(false)
+{
+}
+
+bool GlyphAtlas::begin()
+{
+    if (ready_)
+    {
+        return true;
+    }
+
+    M5Canvas canvas;
+    canvas.setColorDepth(16);
+    if (canvas.createSprite(kGlyphWidth, kGlyphHeight) == nullptr)
+    {
+        return false;
+    }
+
+    // Any lit pixel, whatever byte order the sprite keeps, is non-zero.
+    const uint16_t* pixels = static_cast<const uint16_t*>(canvas.getBuffer());
+    canvas.setTextSize(1);
+    canvas.setTextColor(TFT_WHITE, TFT_BLACK);
+    for (size_t glyph = 0; glyph < kGlyphCount; ++glyph)
+    {
+        canvas.fillScreen(TFT_BLACK);
+        canvas.setCursor(0, 0);
+        canvas.print(kCharacters[glyph]);
+
+        for (int row = 0; row < kGlyphHeight; ++row)
+        {
+            uint8_t mask = 0;
+            for (int column = 0; column < kGlyphWidth; ++column)
+            {
+                if (pixels[row * kGlyphWidth + column] != 0)
+                {
+                    mask |= 1u << column;
+                }
+            }
+            masks_[glyph][row] = mask;
+        }
+    }
+
+    canvas.deleteSprite();
+    ready_ = true;
+    return true;
+}
+
+bool GlyphAtlas::ready() const
+{
+    return ready_;
+}
+
+bool GlyphAtlas::covers(const char* text, size_t length, uint8_t textSize) const
+{
+    if (!ready_ || textSize == 0 || textSize > kMaxTextSize)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (indexOf(text[i]) < 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GlyphAtlas::draw(lgfx::LovyanGFX& screen, int32_t x, int32_t y, char c, uint8_t textSize,
+                      uint16_t color, uint16_t background)
+{
+    int glyph = indexOf(c);
+    if (!ready_ || glyph < 0 || textSize == 0 || textSize > kMaxTextSize || color == background)
+    {
+        return false;
+    }
+
+    uint16_t on = panelOrder(color);
+    uint16_t off = panelOrder(background);
+    int width = kGlyphWidth * textSize;
+    uint16_t* out = cell_;
+    for (int row = 0; row < kGlyphHeight; ++row)
+    {
+        uint8_t mask = masks_[glyph][row];
+        uint16_t* line = out;
+        for (int column = 0; column < kGlyphWidth; ++column)
+        {
+            uint16_t pixel = (mask & (1u << column)) ? on : off;
+            for (int i = 0; i < textSize; ++i)
+            {
+                *out++ = pixel;
+            }
+        }
+        // The remaining rows of this scaled row are copies of the first.
+        for (int i = 1; i < textSize; ++i)
+        {
+            memcpy(out, line, width * sizeof(uint16_t));
+            out += width;
+        }
+    }
+
+    screen.pushImage(x, y, width, kGlyphHeight * textSize, cell_);
+    return true;
+}
+
+int GlyphAtlas::indexOf(char c)
+{
+    for (size_t glyph = 0; glyph < kGlyphCount; ++glyph)
+    {
+        if (kCharacters[glyph] == c)
+        {
+            return static_cast<int>(glyph);
+        }
+    }
+    return -1;
+}
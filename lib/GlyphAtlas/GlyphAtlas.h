@@ -0,0 +1,46 @@
+#ifndef GLYPH_ATLAS_H
+#define GLYPH_ATLAS_H
+
+#include <Arduino.h>
+#include <M5GFX.h>
+
+// The characters numeric fields are made of, rendered once from the
+// built-in 6x8 font into 1-bit masks (8 bytes a glyph). draw() expands a
+// mask to the text size and colours and pushes it as one image, which
+// skips the font lookup and rasterizer on every redraw. The cell is
+// painted in full, background included, exactly as print() with a
+// background colour would.
+class GlyphAtlas
+{
+  public:
+    static constexpr char kCharacters[] = "0123456789ABCDEF #%./:-x";
+    static constexpr int kGlyphWidth = 6;
+    static constexpr int kGlyphHeight = 8;
+    static constexpr uint8_t kMaxTextSize = 3;
+
+    GlyphAtlas();
+
+    // Renders the masks through a glyph-sized M5Canvas. Returns false if
+    // the canvas could not be allocated; the atlas then stays empty.
+    bool begin();
+    bool ready() const;
+
+    // Every character of `text` can be drawn at `textSize`.
+    bool covers(const char* text, size_t length, uint8_t textSize) const;
+
+    // Returns false, drawing nothing, if covers() would not hold or the
+    // background is transparent (same as the colour).
+    bool draw(lgfx::LovyanGFX& screen, int32_t x, int32_t y, char c, uint8_t textSize,
+              uint16_t color, uint16_t background);
+
+  private:
+    static constexpr size_t kGlyphCount = sizeof(kCharacters) - 1;
+
+    static int indexOf(char c);
+
+    uint8_t masks_[kGlyphCount][kGlyphHeight]; // bit n of a row = column n
+    bool ready_;
+    uint16_t cell_[kGlyphWidth * kMaxTextSize * kGlyphHeight * kMaxTextSize];
+};
+
+#endif
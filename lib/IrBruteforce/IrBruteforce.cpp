@@ -1,15 +1,61 @@
 #include "IrBruteforce.h"
+#include <FieldFormat.h>
 
-IrBruteforce::IrBruteforce(M5GFX& screen, uint16_t irPin)
+IrBruteforce::IrBruteforce(lgfx::LovyanGFX& screen, IrTransmitter& transmitter)
 : screen_(screen)
-, irSender_(irPin)
+, transmitter_(transmitter)
 , delayMs_(100)
 , lastSendMs_(0)
+, turbo_(false)
+, protocol_(&irProtocolInfo(IrProtocolId::Nec))
 , running_(false)
-, address_(0)
-, command_(0)
+, order_()
+, nextIndex_(0)
+, lastCode_{0, 0}
 , codesSent_(0)
+, sent_()
+, sentProtocol_(0)
+, skipSent_(true)
+, queued_{}
+, queuedHead_(0)
+, bisecting_(false)
+, replayed_(false)
+, replayedHalf_(IrHitBisector::Half::Lower)
+, replayNext_(0)
+, replayEnd_(0)
+, hitCount_(0)
+, saved_{}
+, promptingResume_(false)
+, inSetup_(false)
+, setupRow_(0)
+, rangeEditor_(screen)
+, editField_(RangeField::None)
+, rateWindowStartMs_(0)
+, rateWindowFrames_(0)
+, codesPerSecond_(0.0f)
+, refresh_()
+, shown_(View::None)
+, titleField_(screen, 8, 4, 2, TFT_YELLOW)
+, addressField_(screen, 8, 30, 2, TFT_WHITE)
+, commandField_(screen, 8, 50, 2, TFT_WHITE)
+, countField_(screen, 8, 76, 2, TFT_WHITE)
+, rateField_(screen, 8, 96, 2, TFT_WHITE)
+, etaField_(screen, 8, 114, 1, TFT_WHITE)
+, hitsField_(screen, 120, 114, 1, TFT_GREEN)
+, refreshField_(screen, 180, 124, 1, TFT_DARKGREY)
+, lineFields_{
+      {screen, 8, kLineTop + 0 * kLineHeight, 2, TFT_WHITE},
+      {screen, 8, kLineTop + 1 * kLineHeight, 2, TFT_WHITE},
+      {screen, 8, kLineTop + 2 * kLineHeight, 2, TFT_WHITE},
+      {screen, 8, kLineTop + 3 * kLineHeight, 2, TFT_WHITE},
+      {screen, 8, kLineTop + 4 * kLineHeight, 2, TFT_WHITE},
+      {screen, 8, kLineTop + 5 * kLineHeight, 2, TFT_WHITE},
+      {screen, 8, kLineTop + 6 * kLineHeight, 2, TFT_WHITE},
+  }
+, resultField_(screen, 8, 52, 3, TFT_GREEN)
 {
+    order_.setKind(IrSweepOrder::Kind::DictionaryFirst);
+    matchSentToProtocol();
 }
 
 void IrBruteforce::setDelayMs(uint32_t delayMs)
@@ -17,20 +63,388 @@ void IrBruteforce::setDelayMs(uint32_t delayMs)
     delayMs_ = delayMs;
 }
 
+void IrBruteforce::setTurbo(bool turbo)
+{
+    turbo_ = turbo;
+}
+
+bool IrBruteforce::turbo() const
+{
+    return turbo_;
+}
+
+void IrBruteforce::setRefreshHz(uint32_t hz)
+{
+    refresh_.setRateHz(hz);
+}
+
+void IrBruteforce::setProtocol(IrProtocolId id)
+{
+    protocol_ = &irProtocolInfo(id);
+    matchSentToProtocol();
+    if (!usesDictionary())
+    {
+        order_.setKind(IrSweepOrder::Kind::Linear);
+    }
+    order_.setRanges(IrSweepRange{0, protocol_->maxAddress()},
+                     IrSweepRange{0, protocol_->maxCommand()});
+}
+
+IrProtocolId IrBruteforce::protocol() const
+{
+    return protocol_->id;
+}
+
+void IrBruteforce::setSkipSent(bool skip)
+{
+    skipSent_ = skip;
+}
+
+bool IrBruteforce::skipSent() const
+{
+    return skipSent_;
+}
+
+void IrBruteforce::setOrder(IrSweepOrder::Kind kind)
+{
+    order_.setKind(usesDictionary() ? kind : IrSweepOrder::Kind::Linear);
+}
+
+IrSweepOrder::Kind IrBruteforce::order() const
+{
+    return order_.kind();
+}
+
+void IrBruteforce::setRanges(IrSweepRange addresses, IrSweepRange commands)
+{
+    if (addresses.last > protocol_->maxAddress())
+    {
+        addresses.last = protocol_->maxAddress();
+    }
+    if (commands.last > protocol_->maxCommand())
+    {
+        commands.last = protocol_->maxCommand();
+    }
+    order_.setRanges(addresses, commands);
+}
+
 void IrBruteforce::start()
 {
-    irSender_.begin();
-    address_ = 0;
-    command_ = 0;
-    codesSent_ = 0;
-    lastSendMs_ = 0;
-    running_ = true;
-    drawProgress();
+    running_ = false;
+    bisecting_ = false;
+    // Another screen was up in between.
+    shown_ = View::None;
+
+    // The set in RAM is never older than the one in flash: flash is only
+    // written from it. Reading flash over a non-empty set would throw away
+    // whatever was sent since the last save; an empty one (a fresh boot,
+    // or a different protocol picked since) has nothing to lose.
+    uint8_t sentProtocol;
+    if (sent_.count() == 0 && checkpoint_.loadSent(sent_, sentProtocol))
+    {
+        sentProtocol_ = sentProtocol;
+        if (sentProtocol != static_cast<uint8_t>(protocol_->id))
+        {
+            setProtocol(static_cast<IrProtocolId>(sentProtocol));
+        }
+    }
+    matchSentToProtocol();
+
+    if (checkpoint_.load(saved_))
+    {
+        IrSweepOrder saved;
+        saved.setKind(static_cast<IrSweepOrder::Kind>(saved_.order));
+        saved.setRanges(IrSweepRange{saved_.addressFirst, saved_.addressLast},
+                        IrSweepRange{saved_.commandFirst, saved_.commandLast});
+        if (saved_.nextIndex < saved.positions() &&
+            (saved_.nextIndex > 0 || saved_.hitCount > 0))
+        {
+            promptingResume_ = true;
+            drawResumePrompt();
+            return;
+        }
+    }
+
+    restart();
+}
+
+void IrBruteforce::resumeSaved()
+{
+    if (!promptingResume_)
+    {
+        return;
+    }
+
+    turbo_ = saved_.turbo != 0;
+    delayMs_ = saved_.delayMs;
+    protocol_ = &irProtocolInfo(static_cast<IrProtocolId>(saved_.protocol));
+    matchSentToProtocol();
+    order_.setKind(static_cast<IrSweepOrder::Kind>(saved_.order));
+    order_.setRanges(IrSweepRange{saved_.addressFirst, saved_.addressLast},
+                     IrSweepRange{saved_.commandFirst, saved_.commandLast});
+    hitCount_ = saved_.hitCount;
+    memcpy(hits_, saved_.hits, sizeof(hits_));
+    begin(saved_.nextIndex);
+}
+
+void IrBruteforce::restart()
+{
+    promptingResume_ = false;
+    inSetup_ = true;
+    editField_ = RangeField::None;
+    setupRow_ = static_cast<int>(SetupRow::Start);
+    drawSetup();
+}
+
+bool IrBruteforce::isPromptingResume() const
+{
+    return promptingResume_;
+}
+
+bool IrBruteforce::isInSetup() const
+{
+    return inSetup_;
+}
+
+void IrBruteforce::moveSetupCursor(int delta)
+{
+    static constexpr int kRows = static_cast<int>(SetupRow::Back) + 1;
+    setupRow_ = (setupRow_ + delta + kRows) % kRows;
+    drawSetup();
+}
+
+IrBruteforce::SetupRow IrBruteforce::setupRow() const
+{
+    return static_cast<SetupRow>(setupRow_);
+}
+
+void IrBruteforce::activateSetupRow()
+{
+    if (!inSetup_)
+    {
+        return;
+    }
+
+    switch (setupRow())
+    {
+        case SetupRow::Protocol:
+        {
+            static constexpr int kProtocols = static_cast<int>(IrProtocolId::Count);
+            int next = (static_cast<int>(protocol_->id) + 1) % kProtocols;
+            setProtocol(static_cast<IrProtocolId>(next));
+            if (usesDictionary())
+            {
+                order_.setKind(IrSweepOrder::Kind::DictionaryFirst);
+            }
+            drawSetup();
+            break;
+        }
+
+        case SetupRow::Order:
+            setOrder(order_.kind() == IrSweepOrder::Kind::Linear
+                         ? IrSweepOrder::Kind::DictionaryFirst
+                         : IrSweepOrder::Kind::Linear);
+            drawSetup();
+            break;
+
+        case SetupRow::Addresses:
+            editRange(RangeField::AddressFirst);
+            break;
+
+        case SetupRow::Commands:
+            editRange(RangeField::CommandFirst);
+            break;
+
+        case SetupRow::SkipSent:
+            skipSent_ = !skipSent_;
+            drawSetup();
+            break;
+
+        case SetupRow::Start:
+            checkpoint_.clear();
+            if (!skipSent_)
+            {
+                sent_.clear();
+            }
+            else if (rangeFullySent())
+            {
+                // Skipping would queue nothing and finish at once; send
+                // the range again instead, as the setup screen said.
+                skipSent_ = false;
+            }
+            hitCount_ = 0;
+            begin(0);
+            break;
+
+        case SetupRow::Back:
+            break;
+    }
+}
+
+bool IrBruteforce::isEditingRange() const
+{
+    return editField_ != RangeField::None;
+}
+
+bool IrBruteforce::adjustRange(int delta)
+{
+    if (editField_ == RangeField::None)
+    {
+        return false;
+    }
+
+    bool changed = rangeEditor_.adjust(delta);
+    if (changed)
+    {
+        rangeEditor_.draw();
+    }
+    return changed;
+}
+
+void IrBruteforce::confirmRange()
+{
+    IrSweepRange addresses = order_.addresses();
+    IrSweepRange commands = order_.commands();
+    uint16_t value = static_cast<uint16_t>(rangeEditor_.value());
+
+    switch (editField_)
+    {
+        case RangeField::None:
+            return;
+
+        case RangeField::AddressFirst:
+            addresses.first = value;
+            order_.setRanges(addresses, commands);
+            editRange(RangeField::AddressLast);
+            return;
+
+        case RangeField::AddressLast:
+            addresses.last = value;
+            break;
+
+        case RangeField::CommandFirst:
+            commands.first = value;
+            order_.setRanges(addresses, commands);
+            editRange(RangeField::CommandLast);
+            return;
+
+        case RangeField::CommandLast:
+            commands.last = value;
+            break;
+    }
+
+    order_.setRanges(addresses, commands);
+    editField_ = RangeField::None;
+    drawSetup();
+}
+
+bool IrBruteforce::usesDictionary() const
+{
+    return protocol_->id == IrProtocolId::Nec;
+}
+
+uint32_t IrBruteforce::keyOf(const IrCode& code) const
+{
+    return (static_cast<uint32_t>(code.address) << protocol_->commandBits) | code.command;
+}
+
+void IrBruteforce::matchSentToProtocol()
+{
+    if (sentProtocol_ != static_cast<uint8_t>(protocol_->id) ||
+        sent_.capacity() != protocol_->codeSpace())
+    {
+        sent_.reset(protocol_->codeSpace());
+        sentProtocol_ = static_cast<uint8_t>(protocol_->id);
+    }
+}
+
+bool IrBruteforce::rangeFullySent() const
+{
+    // Fewer codes sent than the range holds settles it without a scan.
+    if (sent_.count() < order_.totalCodes())
+    {
+        return false;
+    }
+
+    IrSweepRange addresses = order_.addresses();
+    IrSweepRange commands = order_.commands();
+    for (uint32_t address = addresses.first; address <= addresses.last; ++address)
+    {
+        for (uint32_t command = commands.first; command <= commands.last; ++command)
+        {
+            IrCode code{static_cast<uint16_t>(address), static_cast<uint16_t>(command)};
+            if (!sent_.test(keyOf(code)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int IrBruteforce::addressDigits() const
+{
+    return (protocol_->addressBits + 3) / 4;
+}
+
+int IrBruteforce::commandDigits() const
+{
+    return (protocol_->commandBits + 3) / 4;
+}
+
+void IrBruteforce::editRange(RangeField field)
+{
+    bool isAddress = (field == RangeField::AddressFirst || field == RangeField::AddressLast);
+    IrSweepRange range = isAddress ? order_.addresses() : order_.commands();
+    uint16_t max = isAddress ? protocol_->maxAddress() : protocol_->maxCommand();
+
+    editField_ = field;
+    shown_ = View::None; // the editor takes the whole screen
+    rangeEditor_.setHex(true);
+    rangeEditor_.setStep(1);
+
+    switch (field)
+    {
+        case RangeField::AddressFirst:
+            rangeEditor_.setLabel("Addr first");
+            break;
+        case RangeField::AddressLast:
+            rangeEditor_.setLabel("Addr last");
+            break;
+        case RangeField::CommandFirst:
+            rangeEditor_.setLabel("Cmd first");
+            break;
+        case RangeField::CommandLast:
+            rangeEditor_.setLabel("Cmd last");
+            break;
+        case RangeField::None:
+            return;
+    }
+
+    bool isFirst = (field == RangeField::AddressFirst || field == RangeField::CommandFirst);
+    rangeEditor_.setRange(isFirst ? 0x00 : range.first, max);
+    rangeEditor_.setValue(isFirst ? range.first : range.last);
+    rangeEditor_.draw();
 }
 
 void IrBruteforce::stop()
 {
+    if (running_)
+    {
+        dropQueued();
+    }
+    if (running_ || bisecting_)
+    {
+        checkpoint(true);
+        checkpoint_.saveSent(sent_, sentProtocol_);
+    }
+
     running_ = false;
+    bisecting_ = false;
+    promptingResume_ = false;
+    inSetup_ = false;
+    editField_ = RangeField::None;
+    transmitter_.clear();
 }
 
 bool IrBruteforce::isRunning() const
@@ -40,61 +454,172 @@ bool IrBruteforce::isRunning() const
 
 bool IrBruteforce::tick()
 {
+    if (bisecting_)
+    {
+        feedReplay();
+        return true;
+    }
+
     if (!running_)
     {
         return false;
     }
 
     uint32_t now = millis();
-    if (now - lastSendMs_ < delayMs_)
+    updateRate(now);
+
+    if (nextIndex_ >= order_.positions())
     {
-        return true;
+        if (!transmitter_.isIdle())
+        {
+            return true;
+        }
+
+        finish();
+        return false;
     }
 
-    sendCurrentCode();
-    codesSent_++;
-    lastSendMs_ = now;
+    size_t queued = turbo_ ? queueTurbo() : queuePaced(now);
+    if (queued != 0)
+    {
+        codesSent_ += queued;
+        checkpoint(false);
+        refresh_.invalidate();
+    }
 
-    drawProgress();
+    if (refresh_.due(now))
+    {
+        drawProgress();
+    }
+    return true;
+}
 
-    // Advance to next code
-    command_++;
-    if (command_ > 0xFF)
+void IrBruteforce::markHit()
+{
+    // Only a running sweep has a hit to find; once it is done (or
+    // stopped) there is nothing left to freeze.
+    if (bisecting_ || !running_)
     {
-        command_ = 0;
-        address_++;
-        if (address_ > 0xFF)
-        {
-            // Done -- all codes sent
-            running_ = false;
-            screen_.fillScreen(TFT_BLACK);
-            screen_.setTextSize(2);
-            screen_.setTextColor(TFT_GREEN, TFT_BLACK);
-            screen_.setCursor(8, 40);
-            screen_.print("Done!");
-            screen_.setTextColor(TFT_WHITE, TFT_BLACK);
-            screen_.setCursor(8, 70);
-            screen_.print("Press Select");
-            return false;
-        }
+        return;
     }
 
-    return true;
+    // Frames still waiting in the queue never reached the target: take
+    // them out of the candidates so the sweep sends them later.
+    dropQueued();
+
+    if (!bisector_.begin())
+    {
+        return;
+    }
+
+    bisecting_ = true;
+    replayed_ = false;
+    replayNext_ = 0;
+    replayEnd_ = 0;
+
+    if (bisector_.isolated())
+    {
+        saveHit(bisector_.result());
+    }
+    drawBisect();
+}
+
+void IrBruteforce::replay(IrHitBisector::Half half)
+{
+    if (!bisecting_ || bisector_.isolated())
+    {
+        return;
+    }
+
+    transmitter_.clear();
+    replayNext_ = bisector_.halfBegin(half);
+    replayEnd_ = bisector_.halfEnd(half);
+    replayed_ = true;
+    replayedHalf_ = half;
+    drawBisect();
+}
+
+void IrBruteforce::keepReplayed()
+{
+    if (!bisecting_)
+    {
+        return;
+    }
+
+    if (bisector_.isolated())
+    {
+        resume();
+        return;
+    }
+
+    if (!replayed_)
+    {
+        return;
+    }
+
+    transmitter_.clear();
+    replayNext_ = 0;
+    replayEnd_ = 0;
+    bisector_.keep(replayedHalf_);
+    replayed_ = false;
+
+    if (bisector_.isolated())
+    {
+        saveHit(bisector_.result());
+    }
+    drawBisect();
+}
+
+void IrBruteforce::resume()
+{
+    if (!bisecting_)
+    {
+        return;
+    }
+
+    bisecting_ = false;
+    transmitter_.clear();
+    bisector_.reset();
+
+    if (nextIndex_ >= order_.positions())
+    {
+        finish();
+        return;
+    }
+
+    running_ = true;
+    resetRate();
+    drawProgress();
+}
+
+bool IrBruteforce::isBisecting() const
+{
+    return bisecting_;
+}
+
+size_t IrBruteforce::hitCount() const
+{
+    return hitCount_;
+}
+
+const IrCode& IrBruteforce::hit(size_t index) const
+{
+    return hits_[index];
 }
 
 uint16_t IrBruteforce::currentAddress() const
 {
-    return address_;
+    return lastCode_.address;
 }
 
 uint16_t IrBruteforce::currentCommand() const
 {
-    return command_;
+    return lastCode_.command;
 }
 
 uint32_t IrBruteforce::totalCodes() const
 {
-    return kTotalCodes;
+    return order_.totalCodes();
 }
 
 uint32_t IrBruteforce::codesSent() const
@@ -102,45 +627,567 @@ uint32_t IrBruteforce::codesSent() const
     return codesSent_;
 }
 
-void IrBruteforce::sendCurrentCode()
+float IrBruteforce::codesPerSecond() const
+{
+    return codesPerSecond_;
+}
+
+float IrBruteforce::refreshesPerSecond() const
+{
+    return refresh_.achievedHz();
+}
+
+uint32_t IrBruteforce::etaSeconds() const
+{
+    if (codesPerSecond_ <= 0.0f)
+    {
+        return 0;
+    }
+
+    // Frames still in the queue have been counted as sent but are not on
+    // the wire yet.
+    uint32_t remaining = order_.totalCodes() - codesSent_ + static_cast<uint32_t>(transmitter_.pending());
+    return static_cast<uint32_t>(remaining / codesPerSecond_);
+}
+
+void IrBruteforce::begin(uint32_t position)
+{
+    promptingResume_ = false;
+    inSetup_ = false;
+    nextIndex_ = order_.nextSent(position);
+    lastCode_ = IrCode{0, 0};
+    codesSent_ = order_.codesBefore(nextIndex_);
+    queuedHead_ = 0;
+    lastSendMs_ = 0;
+    bisecting_ = false;
+    bisector_.reset();
+    resetRate();
+    running_ = true;
+    drawProgress();
+}
+
+void IrBruteforce::finish()
+{
+    // Done -- all codes sent. Nothing is left to resume, but the codes
+    // stay sent for the next sweep (clear() drops the set too, so it is
+    // written after).
+    running_ = false;
+    checkpoint_.clear();
+    checkpoint_.saveSent(sent_, sentProtocol_);
+    drawDone();
+}
+
+IrBruteforceCheckpoint::State IrBruteforce::snapshot() const
+{
+    IrBruteforceCheckpoint::State state{};
+
+    // Queued frames have not reached the target yet; resume from the first
+    // of them. While bisecting the queue only holds replays.
+    uint32_t index = nextIndex_;
+    size_t pending = transmitter_.pending();
+    if (!bisecting_ && pending > 0)
+    {
+        index = queued_[(queuedHead_ + IrTransmitter::kQueueDepth - pending) % IrTransmitter::kQueueDepth].position;
+    }
+
+    state.turbo = turbo_ ? 1 : 0;
+    state.order = static_cast<uint8_t>(order_.kind());
+    state.protocol = static_cast<uint8_t>(protocol_->id);
+    state.hitCount = static_cast<uint8_t>(hitCount_);
+    state.nextIndex = index;
+    state.delayMs = delayMs_;
+    state.addressFirst = order_.addresses().first;
+    state.addressLast = order_.addresses().last;
+    state.commandFirst = order_.commands().first;
+    state.commandLast = order_.commands().last;
+    memcpy(state.hits, hits_, sizeof(hits_));
+    return state;
+}
+
+void IrBruteforce::checkpoint(bool force)
+{
+    checkpoint_.update(snapshot(), millis(), force);
+}
+
+IrPacing IrBruteforce::pacing() const
+{
+    return turbo_ ? IrPacing::MinimumGap : IrPacing::Standard;
+}
+
+size_t IrBruteforce::queuePaced(uint32_t now)
+{
+    if (now - lastSendMs_ < delayMs_)
+    {
+        return 0;
+    }
+
+    // Keep just one frame queued behind the one on the wire; the
+    // transmitter's own pacing does the rest.
+    if (transmitter_.pending() > 1)
+    {
+        return 0;
+    }
+
+    IrCode code;
+    uint32_t skipped = 0;
+    nextIndex_ = nextUnsent(nextIndex_, code, skipped);
+    codesSent_ += skipped;
+    if (nextIndex_ >= order_.positions() ||
+        protocol_->encodeBatch(&code, 1, transmitter_, pacing()) == 0)
+    {
+        return 0;
+    }
+
+    lastSendMs_ = now;
+    rememberQueued(nextIndex_, codesSent_, code);
+    lastCode_ = code;
+    nextIndex_ = order_.nextSent(nextIndex_ + 1);
+    return 1;
+}
+
+size_t IrBruteforce::queueTurbo()
+{
+    IrCode batch[IrTransmitter::kQueueDepth];
+    uint32_t at[IrTransmitter::kQueueDepth];
+    uint32_t skippedBefore[IrTransmitter::kQueueDepth];
+    size_t count = 0;
+
+    // Look ahead without moving the sweep; only what the transmitter
+    // actually accepts is consumed below.
+    uint32_t position = nextIndex_;
+    uint32_t skipped = 0;
+    uint32_t end = order_.positions();
+    size_t slots = transmitter_.freeSlots();
+    while (count < slots)
+    {
+        position = nextUnsent(position, batch[count], skipped);
+        if (position >= end)
+        {
+            break;
+        }
+        at[count] = position;
+        skippedBefore[count] = skipped;
+        count++;
+        position = order_.nextSent(position + 1);
+    }
+
+    size_t queued = protocol_->encodeBatch(batch, count, transmitter_, pacing());
+    for (size_t i = 0; i < queued; ++i)
+    {
+        rememberQueued(at[i], codesSent_ + skippedBefore[i] + i, batch[i]);
+    }
+
+    if (queued > 0)
+    {
+        lastCode_ = batch[queued - 1];
+    }
+    // Continue from the first code not accepted, or past the whole lookahead.
+    nextIndex_ = (queued < count) ? at[queued] : position;
+    codesSent_ += (queued < count) ? skippedBefore[queued] : skipped;
+    return queued;
+}
+
+void IrBruteforce::feedReplay()
+{
+    if (replayNext_ >= replayEnd_)
+    {
+        return;
+    }
+
+    replayNext_ += protocol_->encodeBatch(&bisector_.code(replayNext_),
+                                          replayEnd_ - replayNext_,
+                                          transmitter_, pacing());
+}
+
+uint32_t IrBruteforce::nextUnsent(uint32_t position, IrCode& code, uint32_t& skipped) const
+{
+    uint32_t end = order_.positions();
+    while (position < end)
+    {
+        order_.codeAt(position, code);
+        if (!skipSent_ || !sent_.test(keyOf(code)))
+        {
+            break;
+        }
+        skipped++;
+        position = order_.nextSent(position + 1);
+    }
+    return position;
+}
+
+void IrBruteforce::rememberQueued(uint32_t position, uint32_t codesSentBefore,
+                                  const IrCode& code)
+{
+    QueuedCode& queued = queued_[queuedHead_];
+    queued.position = position;
+    queued.codesSentBefore = codesSentBefore;
+    queued.code = code;
+    queuedHead_ = (queuedHead_ + 1) % IrTransmitter::kQueueDepth;
+
+    bisector_.record(code);
+    sent_.set(keyOf(code));
+}
+
+size_t IrBruteforce::dropQueued()
+{
+    size_t dropped = transmitter_.clear();
+    if (dropped == 0)
+    {
+        return 0;
+    }
+
+    for (size_t i = 1; i <= dropped; ++i)
+    {
+        const QueuedCode& queued = queued_[(queuedHead_ + IrTransmitter::kQueueDepth - i) % IrTransmitter::kQueueDepth];
+        sent_.erase(keyOf(queued.code));
+    }
+
+    // Back to the oldest dropped code.
+    queuedHead_ = (queuedHead_ + IrTransmitter::kQueueDepth - dropped) % IrTransmitter::kQueueDepth;
+    nextIndex_ = queued_[queuedHead_].position;
+    codesSent_ = queued_[queuedHead_].codesSentBefore;
+    bisector_.forgetNewest(dropped);
+    return dropped;
+}
+
+void IrBruteforce::saveHit(const IrCode& code)
 {
-    // Build the standard NEC 32-bit code:
-    // address | ~address | command | ~command
-    uint32_t code = (static_cast<uint32_t>(address_) << 24) |
-                    (static_cast<uint32_t>(~address_ & 0xFF) << 16) |
-                    (static_cast<uint32_t>(command_) << 8) |
-                    static_cast<uint32_t>(~command_ & 0xFF);
+    for (size_t i = 0; i < hitCount_; ++i)
+    {
+        if (hits_[i].address == code.address && hits_[i].command == code.command)
+        {
+            return;
+        }
+    }
+
+    if (hitCount_ < kMaxHits)
+    {
+        hits_[hitCount_++] = code;
+        checkpoint(false);
+    }
+}
 
-    irSender_.sendNEC(code, 32);
+void IrBruteforce::resetRate()
+{
+    rateWindowStartMs_ = millis();
+    rateWindowFrames_ = transmitter_.framesSent();
+    codesPerSecond_ = 0.0f;
+}
+
+void IrBruteforce::updateRate(uint32_t now)
+{
+    uint32_t elapsed = now - rateWindowStartMs_;
+    if (elapsed < kRateWindowMs)
+    {
+        return;
+    }
+
+    uint32_t frames = transmitter_.framesSent();
+    float rate = (frames - rateWindowFrames_) * 1000.0f / elapsed;
+
+    if (codesPerSecond_ <= 0.0f)
+    {
+        codesPerSecond_ = rate;
+    }
+    else
+    {
+        codesPerSecond_ += kRateSmoothing * (rate - codesPerSecond_);
+    }
+
+    rateWindowStartMs_ = now;
+    rateWindowFrames_ = frames;
 }
 
 void IrBruteforce::drawProgress()
 {
-    screen_.fillScreen(TFT_BLACK);
-    screen_.setTextSize(2);
+    if (showView(View::Progress))
+    {
+        // Hint
+        screen_.setTextSize(1);
+        screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
+        screen_.setCursor(8, 124);
+        screen_.print("Up=hit Down=turbo Sel=stop");
+    }
 
     // Title
-    screen_.setTextColor(TFT_YELLOW, TFT_BLACK);
-    screen_.setCursor(8, 4);
-    screen_.print("IR Bruteforce");
+    titleField_.draw(turbo_ ? "IR Brute TURBO" : "IR Bruteforce");
 
-    // Current code
-    screen_.setTextColor(TFT_WHITE, TFT_BLACK);
-    screen_.setCursor(8, 30);
-    screen_.printf("Addr: 0x%02X", address_);
-    screen_.setCursor(8, 50);
-    screen_.printf("Cmd:  0x%02X", command_);
+    // Current code. Numbers are padded to a fixed width so the text after
+    // them never shifts.
+    char text[TextField::kMaxChars + 1];
+    char* end = formatHex(formatText(text, "Addr: 0x"), lastCode_.address, addressDigits());
+    *end = '\0';
+    addressField_.draw(text);
+    end = formatHex(formatText(text, "Cmd:  0x"), lastCode_.command, commandDigits());
+    *end = '\0';
+    commandField_.draw(text);
 
     // Progress
-    uint32_t percent = (codesSent_ * 100UL) / kTotalCodes;
-    screen_.setCursor(8, 76);
-    screen_.printf("%lu / %lu", codesSent_, kTotalCodes);
-    screen_.setCursor(8, 96);
-    screen_.printf("%lu%%", percent);
-
-    // Hint
-    screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    screen_.setCursor(8, 120);
-    screen_.setTextSize(1);
-    screen_.print("Select = stop");
+    uint32_t total = order_.totalCodes();
+    uint32_t percent = (codesSent_ * 100UL) / total;
+    end = formatDecimal(text, codesSent_, decimalDigits(total));
+    end = formatDecimal(formatText(end, " / "), total);
+    *end = '\0';
+    countField_.draw(text);
+    end = formatDecimal(text, percent, 3);
+    end = formatTenths(formatText(end, "% "), static_cast<uint32_t>(codesPerSecond_ * 10.0f + 0.5f), 4);
+    end = formatText(end, "/s");
+    *end = '\0';
+    rateField_.draw(text);
+
+    // Rate-based ETA
+    uint32_t eta = etaSeconds();
+    if (eta > 0)
+    {
+        end = formatDecimal(formatText(text, "ETA "), eta / 3600);
+        end = formatDecimal(formatText(end, ":"), (eta / 60) % 60, 2, '0');
+        end = formatDecimal(formatText(end, ":"), eta % 60, 2, '0');
+        *end = '\0';
+        etaField_.draw(text);
+    }
+    else
+    {
+        etaField_.draw("ETA --:--:--");
+    }
+    if (hitCount_ > 0)
+    {
+        end = formatDecimal(formatText(text, "Hits: "), static_cast<uint32_t>(hitCount_));
+        *end = '\0';
+        hitsField_.draw(text);
+    }
+    end = formatDecimal(text, static_cast<uint32_t>(refresh_.achievedHz() + 0.5f), 2);
+    end = formatText(end, " fps");
+    *end = '\0';
+    refreshField_.draw(text);
+
+    refresh_.presented(millis());
+}
+
+bool IrBruteforce::showView(View view)
+{
+    if (shown_ == view)
+    {
+        return false;
+    }
+
+    screen_.fillScreen(TFT_BLACK);
+    titleField_.invalidate();
+    addressField_.invalidate();
+    commandField_.invalidate();
+    countField_.invalidate();
+    rateField_.invalidate();
+    etaField_.invalidate();
+    hitsField_.invalidate();
+    refreshField_.invalidate();
+    for (TextField& field : lineFields_)
+    {
+        field.invalidate();
+    }
+    resultField_.invalidate();
+    shown_ = view;
+    return true;
+}
+
+void IrBruteforce::drawBisect()
+{
+    char text[TextField::kMaxChars + 1];
+    char* end;
+
+    if (bisector_.isolated())
+    {
+        if (showView(View::BisectResult))
+        {
+            screen_.setTextSize(1);
+            screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
+            screen_.setCursor(8, 124);
+            screen_.print("Sel=resume sweep");
+        }
+    }
+    else if (showView(View::Bisect))
+    {
+        // Hint
+        screen_.setTextSize(1);
+        screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
+        screen_.setCursor(8, 112);
+        screen_.print("Up/Down = replay A/B");
+        screen_.setCursor(8, 124);
+        screen_.print("Sel=keep played  Hold=quit");
+    }
+
+    titleField_.draw("Hit bisect");
+
+    end = formatText(formatDecimal(text, static_cast<uint32_t>(bisector_.candidates())), " candidates");
+    *end = '\0';
+    lineFields_[0].setColors(TFT_DARKGREY, TFT_BLACK);
+    lineFields_[0].draw(text);
+
+    if (bisector_.isolated())
+    {
+        const IrCode& code = bisector_.result();
+        end = formatHex(text, code.address, addressDigits());
+        *end++ = ':';
+        end = formatHex(end, code.command, commandDigits());
+        *end = '\0';
+        resultField_.draw(text);
+
+        lineFields_[4].setColors(TFT_GREEN, TFT_BLACK);
+        lineFields_[4].draw("Saved");
+        return;
+    }
+
+    // Range covered by each half
+    static constexpr IrHitBisector::Half kHalves[] = {
+        IrHitBisector::Half::Lower,
+        IrHitBisector::Half::Upper,
+    };
+    for (size_t i = 0; i < 2; ++i)
+    {
+        IrHitBisector::Half half = kHalves[i];
+        const IrCode& first = bisector_.code(bisector_.halfBegin(half));
+        const IrCode& last = bisector_.code(bisector_.halfEnd(half) - 1);
+        bool played = replayed_ && replayedHalf_ == half;
+
+        end = text;
+        *end++ = (i == 0) ? 'A' : 'B';
+        *end++ = ' ';
+        end = formatHex(end, first.address, addressDigits());
+        *end++ = ':';
+        end = formatHex(end, first.command, commandDigits());
+        *end++ = '-';
+        end = formatHex(end, last.address, addressDigits());
+        *end++ = ':';
+        end = formatHex(end, last.command, commandDigits());
+        *end = '\0';
+
+        TextField& field = lineFields_[2 + i];
+        field.setColors(played ? TFT_GREEN : TFT_WHITE, TFT_BLACK);
+        field.draw(text);
+    }
+}
+
+void IrBruteforce::drawResumePrompt()
+{
+    if (showView(View::ResumePrompt))
+    {
+        // Hint
+        screen_.setTextSize(1);
+        screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
+        screen_.setCursor(8, 112);
+        screen_.print("Up = resume  Down = restart");
+        screen_.setCursor(8, 124);
+        screen_.print("Sel = back");
+    }
+
+    titleField_.draw("Resume sweep?");
+
+    IrSweepOrder saved;
+    saved.setKind(static_cast<IrSweepOrder::Kind>(saved_.order));
+    saved.setRanges(IrSweepRange{saved_.addressFirst, saved_.addressLast},
+                    IrSweepRange{saved_.commandFirst, saved_.commandLast});
+    IrCode code;
+    saved.codeAt(saved_.nextIndex, code);
+    uint32_t percent = (saved.codesBefore(saved_.nextIndex) * 100UL) / saved.totalCodes();
+    const IrProtocolInfo& protocol = irProtocolInfo(static_cast<IrProtocolId>(saved_.protocol));
+
+    char text[TextField::kMaxChars + 1];
+    char* end = formatHex(formatText(text, "At "), code.address, (protocol.addressBits + 3) / 4);
+    *end++ = ':';
+    end = formatHex(end, code.command, (protocol.commandBits + 3) / 4);
+    end = formatText(formatDecimal(formatText(end, " ("), percent), "%)");
+    *end = '\0';
+    lineFields_[0].setColors(TFT_WHITE, TFT_BLACK);
+    lineFields_[0].draw(text);
+
+    end = formatText(formatText(text, protocol.name), "  Hits: ");
+    end = formatDecimal(end, saved_.hitCount);
+    *end = '\0';
+    lineFields_[1].setColors(TFT_WHITE, TFT_BLACK);
+    lineFields_[1].draw(text);
+
+    end = formatText(text, saved.name());
+    if (saved_.turbo)
+    {
+        end = formatText(end, " turbo");
+    }
+    *end = '\0';
+    lineFields_[2].setColors(TFT_WHITE, TFT_BLACK);
+    lineFields_[2].draw(text);
+}
+
+void IrBruteforce::drawSetup()
+{
+    showView(View::Setup);
+
+    char text[TextField::kMaxChars + 1];
+    char* end = formatText(formatDecimal(formatText(text, "Setup "), order_.totalCodes()), " codes");
+    *end = '\0';
+    titleField_.draw(text);
+
+    // Rows are padded out to the screen edge so the highlight is a full
+    // band, and moving it repaints just the two rows it left and entered.
+    size_t width = min(static_cast<size_t>((screen_.width() - 8) / 12), TextField::kMaxChars);
+    for (int row = 0; row < kLineCount; ++row)
+    {
+        switch (static_cast<SetupRow>(row))
+        {
+            case SetupRow::Protocol:
+                end = formatText(formatText(text, "Proto: "), protocol_->name);
+                break;
+            case SetupRow::Order:
+                end = formatText(formatText(text, "Order: "), order_.name());
+                break;
+            case SetupRow::Addresses:
+                end = formatHex(formatText(text, "Addr: "), order_.addresses().first, addressDigits());
+                *end++ = '-';
+                end = formatHex(end, order_.addresses().last, addressDigits());
+                break;
+            case SetupRow::Commands:
+                end = formatHex(formatText(text, "Cmd:  "), order_.commands().first, commandDigits());
+                *end++ = '-';
+                end = formatHex(end, order_.commands().last, commandDigits());
+                break;
+            case SetupRow::SkipSent:
+                if (skipSent_ && rangeFullySent())
+                {
+                    end = formatText(text, "All sent: resend");
+                }
+                else if (skipSent_)
+                {
+                    end = formatDecimal(formatText(text, "Skip sent: "), sent_.count());
+                }
+                else
+                {
+                    end = formatText(text, "Skip sent: off");
+                }
+                break;
+            case SetupRow::Start:
+                end = formatText(text, "Start");
+                break;
+            case SetupRow::Back:
+                end = formatText(text, "Back");
+                break;
+        }
+        while (static_cast<size_t>(end - text) < width)
+        {
+            *end++ = ' ';
+        }
+        *end = '\0';
+
+        bool isSelected = (row == setupRow_);
+        lineFields_[row].setColors(isSelected ? TFT_BLACK : TFT_WHITE,
+                                   isSelected ? TFT_DARKGREY : TFT_BLACK);
+        lineFields_[row].draw(text);
+    }
+}
+
+void IrBruteforce::drawDone()
+{
+    showView(View::Done);
+    screen_.setTextSize(2);
+    screen_.setTextColor(TFT_GREEN, TFT_BLACK);
+    screen_.setCursor(8, 40);
+    screen_.print("Done!");
+    screen_.setTextColor(TFT_WHITE, TFT_BLACK);
+    screen_.setCursor(8, 70);
+    screen_.print("Press Select");
 }
@@ -3,42 +3,252 @@
 
 #include <Arduino.h>
 #include <M5GFX.h>
-#include <IRsend.h>
+#include <IrTransmitter.h>
+#include <FramePacer.h>
+#include <IrProtocols.h>
+#include <TextField.h>
+#include <ValueEditor.h>
+#include "IrBruteforceCheckpoint.h"
+#include "IrCodeSet.h"
+#include "IrHitBisector.h"
+#include "IrSweepOrder.h"
 
 class IrBruteforce
 {
   public:
-    IrBruteforce(M5GFX& screen, uint16_t irPin);
+    enum class SetupRow
+    {
+        Protocol,
+        Order,
+        Addresses,
+        Commands,
+        SkipSent,
+        Start,
+        Back,
+    };
+
+    IrBruteforce(lgfx::LovyanGFX& screen, IrTransmitter& transmitter);
 
     void setDelayMs(uint32_t delayMs);
 
+    // Protocol to sweep. Resets the ranges to its full code space; the
+    // dictionary order is NEC-only, other protocols sweep linearly.
+    void setProtocol(IrProtocolId id);
+    IrProtocolId protocol() const;
+
+    // Turbo ignores the delay and keeps the transmit queue full, spacing
+    // frames by only the protocol's minimum gap after the previous frame
+    // ends.
+    void setTurbo(bool turbo);
+    bool turbo() const;
+
+    // How often the progress view may redraw while codes go out; the
+    // sweep itself runs at full speed. 0 stops redrawing until the sweep
+    // ends or stops.
+    void setRefreshHz(uint32_t hz);
+
+    void setOrder(IrSweepOrder::Kind kind);
+    IrSweepOrder::Kind order() const;
+
+    // Restrict the sweep to a sub-range of addresses and commands. Clamped
+    // to the protocol's code space.
+    void setRanges(IrSweepRange addresses, IrSweepRange commands);
+
+    // Every code queued is remembered per protocol, and kept in flash when
+    // a sweep stops or finishes. With skipping on, a fresh sweep passes over
+    // codes an earlier one already sent, so changing the order or widening
+    // the ranges never repeats them. A range with nothing left unsent is
+    // shown as such on the setup screen, and starting it turns skipping
+    // off and sends the whole range again.
+    void setSkipSent(bool skip);
+    bool skipSent() const;
+
+    // Offers to resume from the flash checkpoint if there is an unfinished
+    // one; otherwise opens the setup screen. While the offer is on screen,
+    // resumeSaved() or restart() picks one.
     void start();
+    void resumeSaved();
+    void restart();
+    bool isPromptingResume() const;
+
+    // Setup screen shown before a fresh sweep.
+    bool isInSetup() const;
+    void moveSetupCursor(int delta);
+    SetupRow setupRow() const;
+    // Cycles the selected setting, opens the range editor, or starts the
+    // sweep on the Start row.
+    void activateSetupRow();
+
+    // Range editing from the setup screen: first, then last value of the
+    // address or command range. confirmRange() moves on to the next value
+    // and back to setup after the last one.
+    bool isEditingRange() const;
+    bool adjustRange(int delta);
+    void confirmRange();
+
+    // Stops the sweep and checkpoints where it got to.
     void stop();
     bool isRunning() const;
 
     bool tick();
 
+    // Hit bisection. markHit() freezes the sweep and takes the last
+    // IrHitBisector::kWindow codes sent as candidates; replay() sends one
+    // half of them again and keepReplayed() narrows down to the half that
+    // was played last. Once one code is left it is added to the hit list
+    // and keepReplayed() resumes the sweep. markHit() does nothing unless
+    // the sweep is running.
+    void markHit();
+    void replay(IrHitBisector::Half half);
+    void keepReplayed();
+    void resume();
+    bool isBisecting() const;
+
+    size_t hitCount() const;
+    const IrCode& hit(size_t index) const;
+
     uint16_t currentAddress() const;
     uint16_t currentCommand() const;
     uint32_t totalCodes() const;
     uint32_t codesSent() const;
 
+    // Smoothed rate of frames actually leaving the LED.
+    float codesPerSecond() const;
+    // Estimated seconds to finish at that rate, 0 if unknown.
+    uint32_t etaSeconds() const;
+    // Progress redraws per second actually drawn.
+    float refreshesPerSecond() const;
+
+    static constexpr size_t kMaxHits = IrBruteforceCheckpoint::kMaxHits;
+
   private:
+    // What is on screen, so each view lays out its static parts only
+    // when it is first shown.
+    enum class View : uint8_t
+    {
+        None, // something else drew over the screen
+        Progress,
+        Setup,
+        ResumePrompt,
+        Bisect,
+        BisectResult,
+        Done,
+    };
+
+    // Size-2 text lines under the title, shared by the setup rows, the
+    // resume prompt and the bisect view.
+    static constexpr int kLineCount = static_cast<int>(SetupRow::Back) + 1;
+    static constexpr int kLineTop = 22;
+    static constexpr int kLineHeight = 16;
+
+    enum class RangeField
+    {
+        None,
+        AddressFirst,
+        AddressLast,
+        CommandFirst,
+        CommandLast,
+    };
+
+    // Snapshot taken as each sweep code is queued, so codes dropped from
+    // the queue can be un-sent.
+    struct QueuedCode
+    {
+        uint32_t position;
+        uint32_t codesSentBefore;
+        IrCode code;
+    };
+
+    bool usesDictionary() const;
+    uint32_t keyOf(const IrCode& code) const;
+    void matchSentToProtocol();
+    bool rangeFullySent() const;
+    uint32_t nextUnsent(uint32_t position, IrCode& code, uint32_t& skipped) const;
+    void rememberQueued(uint32_t position, uint32_t codesSentBefore, const IrCode& code);
+    size_t dropQueued();
+    int addressDigits() const;
+    int commandDigits() const;
+    void editRange(RangeField field);
+    void begin(uint32_t position);
+    void finish();
+    IrBruteforceCheckpoint::State snapshot() const;
+    void checkpoint(bool force);
+    IrPacing pacing() const;
+    size_t queuePaced(uint32_t now);
+    size_t queueTurbo();
+    void feedReplay();
+    void saveHit(const IrCode& code);
+    void resetRate();
+    void updateRate(uint32_t now);
+    // Clears the screen and forgets every field if `view` is not already
+    // shown. Returns true if the caller should lay out its static parts.
+    bool showView(View view);
+    // Every view repaints only the fields that changed since it was last
+    // drawn; drawProgress() runs after every code.
     void drawProgress();
-    void sendCurrentCode();
+    void drawBisect();
+    void drawResumePrompt();
+    void drawSetup();
+    void drawDone();
 
-    M5GFX& screen_;
-    IRsend irSender_;
+    lgfx::LovyanGFX& screen_;
+    IrTransmitter& transmitter_;
 
     uint32_t delayMs_;
     uint32_t lastSendMs_;
+    bool turbo_;
+    const IrProtocolInfo* protocol_;
 
     bool running_;
-    uint16_t address_;
-    uint16_t command_;
-    uint32_t codesSent_;
+    IrSweepOrder order_;
+    uint32_t nextIndex_; // next IrSweepOrder position to queue
+    IrCode lastCode_;
+    uint32_t codesSent_; // codes covered, including ones skipped as sent
+
+    IrCodeSet sent_;
+    uint8_t sentProtocol_;
+    bool skipSent_;
+    QueuedCode queued_[IrTransmitter::kQueueDepth];
+    size_t queuedHead_; // next slot to write
+
+    IrHitBisector bisector_;
+    bool bisecting_;
+    bool replayed_;
+    IrHitBisector::Half replayedHalf_;
+    size_t replayNext_;
+    size_t replayEnd_;
+
+    IrCode hits_[kMaxHits];
+    size_t hitCount_;
+
+    IrBruteforceCheckpoint checkpoint_;
+    IrBruteforceCheckpoint::State saved_;
+    bool promptingResume_;
+
+    bool inSetup_;
+    int setupRow_;
+    ValueEditor rangeEditor_;
+    RangeField editField_;
+
+    uint32_t rateWindowStartMs_;
+    uint32_t rateWindowFrames_;
+    float codesPerSecond_;
+
+    FramePacer refresh_;
+    View shown_;
+    TextField titleField_;
+    TextField addressField_;
+    TextField commandField_;
+    TextField countField_;
+    TextField rateField_;
+    TextField etaField_;
+    TextField hitsField_;
+    TextField refreshField_;
+    TextField lineFields_[kLineCount];
+    TextField resultField_;
 
-    static constexpr uint32_t kTotalCodes = 256UL * 256UL; // 65536
+    static constexpr uint32_t kRateWindowMs = 1000;
+    static constexpr float kRateSmoothing = 0.25f;
 };
 
 #endif
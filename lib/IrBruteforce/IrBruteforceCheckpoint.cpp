@@ -0,0 +1,173 @@
+#include "IrBruteforceCheckpoint.h"
+#include <Preferences.h>
+
+static constexpr const char* kNamespace = "irbrute";
+static constexpr const char* kKey = "state";
+static constexpr const char* kSentKey = "sent";
+
+IrBruteforceCheckpoint::IrBruteforceCheckpoint()
+: last_{}
+, hasLast_(false)
+, lastWriteMs_(0)
+, writes_(0)
+{
+}
+
+bool IrBruteforceCheckpoint::load(State& state)
+{
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, true))
+    {
+        return false;
+    }
+
+    bool ok = prefs.getBytesLength(kKey) == sizeof(State) &&
+              prefs.getBytes(kKey, &state, sizeof(State)) == sizeof(State);
+    prefs.end();
+
+    if (!ok || state.version != kVersion || state.hitCount > kMaxHits ||
+        state.protocol >= static_cast<uint8_t>(IrProtocolId::Count))
+    {
+        return false;
+    }
+
+    last_ = state;
+    hasLast_ = true;
+    return true;
+}
+
+bool IrBruteforceCheckpoint::update(const State& state, uint32_t nowMs, bool force)
+{
+    State stamped = state;
+    stamped.version = kVersion;
+
+    if (hasLast_ && memcmp(&stamped, &last_, sizeof(State)) == 0)
+    {
+        return false;
+    }
+
+    if (!force && hasLast_)
+    {
+        bool settingsChanged = stamped.turbo != last_.turbo ||
+                               stamped.order != last_.order ||
+                               stamped.protocol != last_.protocol ||
+                               stamped.addressFirst != last_.addressFirst ||
+                               stamped.addressLast != last_.addressLast ||
+                               stamped.commandFirst != last_.commandFirst ||
+                               stamped.commandLast != last_.commandLast ||
+                               stamped.delayMs != last_.delayMs ||
+                               stamped.hitCount != last_.hitCount;
+        if (!settingsChanged)
+        {
+            if (nowMs - lastWriteMs_ < kMinIntervalMs)
+            {
+                return false;
+            }
+            if (stamped.nextIndex - last_.nextIndex < kMinCodes)
+            {
+                return false;
+            }
+        }
+    }
+
+    return write(stamped, nowMs);
+}
+
+void IrBruteforceCheckpoint::clear()
+{
+    Preferences prefs;
+    if (prefs.begin(kNamespace, false))
+    {
+        prefs.remove(kKey);
+        prefs.remove(kSentKey);
+        prefs.end();
+    }
+    hasLast_ = false;
+}
+
+bool IrBruteforceCheckpoint::saveSent(const IrCodeSet& sent, uint8_t protocol)
+{
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, false))
+    {
+        return false;
+    }
+
+    // Leading protocol byte, then the set.
+    size_t size = 1 + sent.serializedSize();
+    uint8_t* buffer = (sent.count() > 0 && size <= kMaxSentBytes)
+                          ? static_cast<uint8_t*>(malloc(size))
+                          : nullptr;
+    bool ok = false;
+    if (buffer != nullptr)
+    {
+        buffer[0] = protocol;
+        sent.serialize(buffer + 1, size - 1);
+        ok = prefs.putBytes(kSentKey, buffer, size) == size;
+        free(buffer);
+    }
+
+    // Never leave a stale set behind one that could not be written.
+    if (!ok)
+    {
+        prefs.remove(kSentKey);
+    }
+    prefs.end();
+
+    if (ok)
+    {
+        writes_++;
+    }
+    return ok;
+}
+
+bool IrBruteforceCheckpoint::loadSent(IrCodeSet& sent, uint8_t& protocol)
+{
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, true))
+    {
+        return false;
+    }
+
+    size_t size = prefs.getBytesLength(kSentKey);
+    uint8_t* buffer = (size > 1 && size <= kMaxSentBytes)
+                          ? static_cast<uint8_t*>(malloc(size))
+                          : nullptr;
+    bool ok = buffer != nullptr && prefs.getBytes(kSentKey, buffer, size) == size;
+    prefs.end();
+
+    if (ok)
+    {
+        protocol = buffer[0];
+        ok = protocol < static_cast<uint8_t>(IrProtocolId::Count) &&
+             sent.deserialize(buffer + 1, size - 1);
+    }
+    free(buffer);
+    return ok;
+}
+
+uint32_t IrBruteforceCheckpoint::writes() const
+{
+    return writes_;
+}
+
+bool IrBruteforceCheckpoint::write(const State& state, uint32_t nowMs)
+{
+    Preferences prefs;
+    if (!prefs.begin(kNamespace, false))
+    {
+        return false;
+    }
+
+    bool ok = prefs.putBytes(kKey, &state, sizeof(State)) == sizeof(State);
+    prefs.end();
+
+    if (ok)
+    {
+        last_ = state;
+        hasLast_ = true;
+        lastWriteMs_ = nowMs;
+        writes_++;
+    }
+    return ok;
+}
@@ -0,0 +1,71 @@
+#ifndef IR_BRUTEFORCE_CHECKPOINT_H
+#define IR_BRUTEFORCE_CHECKPOINT_H
+
+#include <Arduino.h>
+#include <IrProtocols.h>
+#include "IrCodeSet.h"
+
+// Persists the bruteforce sweep to NVS as a single blob. Plain progress is
+// written at most every kMinIntervalMs and only after kMinCodes more codes;
+// settings or hit-list changes go out right away since they are rare and
+// user-driven. An unchanged state is never rewritten.
+//
+// The set of codes already sent is kept under its own key and only written
+// by saveSent(): it can run to kilobytes, so it goes out when a sweep stops
+// rather than with every progress write. Sets over kMaxSentBytes are not
+// kept at all.
+class IrBruteforceCheckpoint
+{
+  public:
+    static constexpr size_t kMaxHits = 16;
+
+    struct State
+    {
+        uint8_t version;
+        uint8_t turbo;
+        uint8_t hitCount;
+        uint8_t order;    // IrSweepOrder::Kind
+        uint8_t protocol; // IrProtocolId
+        uint8_t reserved[3];
+        uint32_t nextIndex;
+        uint32_t delayMs;
+        uint16_t addressFirst;
+        uint16_t addressLast;
+        uint16_t commandFirst;
+        uint16_t commandLast;
+        IrCode hits[kMaxHits];
+    };
+
+    IrBruteforceCheckpoint();
+
+    // Returns false if there is no valid checkpoint.
+    bool load(State& state);
+
+    // Writes `state` if the limits above allow it, or unconditionally when
+    // `force` is set. Returns true if flash was written.
+    bool update(const State& state, uint32_t nowMs, bool force = false);
+
+    // Removes the state and the sent set.
+    void clear();
+
+    bool saveSent(const IrCodeSet& sent, uint8_t protocol);
+    bool loadSent(IrCodeSet& sent, uint8_t& protocol);
+
+    uint32_t writes() const;
+
+    static constexpr uint32_t kMinIntervalMs = 30000;
+    static constexpr uint32_t kMinCodes = 64;
+    static constexpr size_t kMaxSentBytes = 10240;
+
+  private:
+    bool write(const State& state, uint32_t nowMs);
+
+    State last_; // as last written, version stamped
+    bool hasLast_;
+    uint32_t lastWriteMs_;
+    uint32_t writes_;
+
+    static constexpr uint8_t kVersion = 3;
+};
+
+#endif
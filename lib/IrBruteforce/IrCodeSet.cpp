@@ -0,0 +1,385 @@
+#include "IrCodeSet.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ESP32
+#include <esp_heap_caps.h>
+#endif
+
+namespace
+{
+
+enum ChunkKind : uint8_t
+{
+    kChunkFull = 1,
+    kChunkPartial = 2,
+};
+
+struct FullChunk
+{
+    uint32_t words[IrCodeSet::kChunkBits / 32];
+};
+
+constexpr FullChunk makeFullChunk()
+{
+    FullChunk chunk{};
+    for (uint32_t& word : chunk.words)
+    {
+        word = 0xFFFFFFFFUL;
+    }
+    return chunk;
+}
+
+// Shared by every full chunk; never written.
+constexpr FullChunk kFullChunk = makeFullChunk();
+
+void* allocate(size_t bytes)
+{
+#ifdef ESP32
+    void* p = heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (p != nullptr)
+    {
+        return p;
+    }
+#endif
+    return malloc(bytes);
+}
+
+void put16(uint8_t*& out, uint16_t value)
+{
+    memcpy(out, &value, sizeof(value));
+    out += sizeof(value);
+}
+
+void put32(uint8_t*& out, uint32_t value)
+{
+    memcpy(out, &value, sizeof(value));
+    out += sizeof(value);
+}
+
+uint16_t get16(const uint8_t*& in)
+{
+    uint16_t value;
+    memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return value;
+}
+
+uint32_t get32(const uint8_t*& in)
+{
+    uint32_t value;
+    memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return value;
+}
+
+} // namespace
+
+IrCodeSet::IrCodeSet(uint32_t capacity)
+: capacity_(0)
+, count_(0)
+, chunks_(nullptr)
+, chunkCounts_(nullptr)
+{
+    reset(capacity);
+}
+
+IrCodeSet::~IrCodeSet()
+{
+    reset(0);
+}
+
+bool IrCodeSet::reset(uint32_t capacity)
+{
+    clear();
+    free(chunks_);
+    free(chunkCounts_);
+    chunks_ = nullptr;
+    chunkCounts_ = nullptr;
+    capacity_ = 0;
+
+    if (capacity == 0 || capacity > kMaxCapacity)
+    {
+        return capacity == 0;
+    }
+
+    uint32_t chunks = (capacity + kChunkBits - 1) / kChunkBits;
+    chunks_ = static_cast<uint32_t**>(calloc(chunks, sizeof(uint32_t*)));
+    chunkCounts_ = static_cast<uint16_t*>(calloc(chunks, sizeof(uint16_t)));
+    if (chunks_ == nullptr || chunkCounts_ == nullptr)
+    {
+        free(chunks_);
+        free(chunkCounts_);
+        chunks_ = nullptr;
+        chunkCounts_ = nullptr;
+        return false;
+    }
+
+    capacity_ = capacity;
+    return true;
+}
+
+void IrCodeSet::clear()
+{
+    for (uint32_t chunk = 0; chunk < chunkCount(); ++chunk)
+    {
+        freeChunk(chunk);
+    }
+    count_ = 0;
+}
+
+uint32_t IrCodeSet::capacity() const
+{
+    return capacity_;
+}
+
+uint32_t IrCodeSet::count() const
+{
+    return count_;
+}
+
+bool IrCodeSet::test(uint32_t index) const
+{
+    if (index >= capacity_)
+    {
+        return false;
+    }
+
+    const uint32_t* words = chunks_[index / kChunkBits];
+    if (words == nullptr)
+    {
+        return false;
+    }
+
+    uint32_t bit = index % kChunkBits;
+    return (words[bit / 32] & (1UL << (bit % 32))) != 0;
+}
+
+bool IrCodeSet::set(uint32_t index)
+{
+    if (index >= capacity_)
+    {
+        return false;
+    }
+
+    uint32_t chunk = index / kChunkBits;
+    uint32_t*& words = chunks_[chunk];
+    if (words == fullChunk())
+    {
+        return true;
+    }
+    if (words == nullptr)
+    {
+        words = allocateChunk();
+        if (words == nullptr)
+        {
+            return false;
+        }
+    }
+
+    uint32_t bit = index % kChunkBits;
+    uint32_t mask = 1UL << (bit % 32);
+    if (words[bit / 32] & mask)
+    {
+        return true;
+    }
+
+    words[bit / 32] |= mask;
+    count_++;
+
+    // A full chunk (the last one may be short) collapses to the shared one.
+    if (++chunkCounts_[chunk] == bitsIn(chunk))
+    {
+        free(words);
+        words = fullChunk();
+        chunkCounts_[chunk] = 0;
+    }
+    return true;
+}
+
+void IrCodeSet::erase(uint32_t index)
+{
+    if (!test(index))
+    {
+        return;
+    }
+
+    uint32_t chunk = index / kChunkBits;
+    uint32_t*& words = chunks_[chunk];
+    if (words == fullChunk())
+    {
+        uint32_t* copy = allocateChunk();
+        if (copy == nullptr)
+        {
+            return;
+        }
+        memcpy(copy, kFullChunk.words, sizeof(kFullChunk.words));
+        words = copy;
+        chunkCounts_[chunk] = static_cast<uint16_t>(bitsIn(chunk));
+    }
+
+    uint32_t bit = index % kChunkBits;
+    words[bit / 32] &= ~(1UL << (bit % 32));
+    count_--;
+
+    if (--chunkCounts_[chunk] == 0)
+    {
+        freeChunk(chunk);
+    }
+}
+
+size_t IrCodeSet::memoryBytes() const
+{
+    size_t bytes = chunkCount() * (sizeof(uint32_t*) + sizeof(uint16_t));
+    for (uint32_t chunk = 0; chunk < chunkCount(); ++chunk)
+    {
+        if (chunks_[chunk] != nullptr && chunks_[chunk] != fullChunk())
+        {
+            bytes += sizeof(kFullChunk.words);
+        }
+    }
+    return bytes;
+}
+
+size_t IrCodeSet::serializedSize() const
+{
+    size_t bytes = sizeof(uint32_t);
+    for (uint32_t chunk = 0; chunk < chunkCount(); ++chunk)
+    {
+        if (chunks_[chunk] == nullptr)
+        {
+            continue;
+        }
+        bytes += sizeof(uint16_t) + 1;
+        if (chunks_[chunk] != fullChunk())
+        {
+            bytes += sizeof(kFullChunk.words);
+        }
+    }
+    return bytes;
+}
+
+size_t IrCodeSet::serialize(uint8_t* out, size_t size) const
+{
+    size_t bytes = serializedSize();
+    if (size < bytes)
+    {
+        return 0;
+    }
+
+    put32(out, capacity_);
+    for (uint32_t chunk = 0; chunk < chunkCount(); ++chunk)
+    {
+        const uint32_t* words = chunks_[chunk];
+        if (words == nullptr)
+        {
+            continue;
+        }
+
+        put16(out, static_cast<uint16_t>(chunk));
+        if (words == fullChunk())
+        {
+            *out++ = kChunkFull;
+        }
+        else
+        {
+            *out++ = kChunkPartial;
+            memcpy(out, words, sizeof(kFullChunk.words));
+            out += sizeof(kFullChunk.words);
+        }
+    }
+    return bytes;
+}
+
+bool IrCodeSet::deserialize(const uint8_t* in, size_t size)
+{
+    const uint8_t* end = in + size;
+    if (size < sizeof(uint32_t) || !reset(get32(in)))
+    {
+        return false;
+    }
+
+    while (in < end)
+    {
+        if (end - in < static_cast<ptrdiff_t>(sizeof(uint16_t) + 1))
+        {
+            clear();
+            return false;
+        }
+
+        uint16_t chunk = get16(in);
+        uint8_t kind = *in++;
+        uint32_t chunkBits = (chunk < chunkCount()) ? bitsIn(chunk) : 0;
+        if (chunkBits == 0 || chunks_[chunk] != nullptr)
+        {
+            clear();
+            return false;
+        }
+
+        if (kind == kChunkFull)
+        {
+            chunks_[chunk] = fullChunk();
+            count_ += chunkBits;
+            continue;
+        }
+
+        uint32_t* words = (kind == kChunkPartial && end - in >= static_cast<ptrdiff_t>(sizeof(kFullChunk.words)))
+                              ? allocateChunk()
+                              : nullptr;
+        if (words == nullptr)
+        {
+            clear();
+            return false;
+        }
+
+        memcpy(words, in, sizeof(kFullChunk.words));
+        in += sizeof(kFullChunk.words);
+        chunks_[chunk] = words;
+
+        uint32_t bits = 0;
+        for (uint32_t i = 0; i < kChunkWords; ++i)
+        {
+            bits += __builtin_popcount(words[i]);
+        }
+        chunkCounts_[chunk] = static_cast<uint16_t>(bits);
+        count_ += bits;
+    }
+    return true;
+}
+
+uint32_t* IrCodeSet::fullChunk()
+{
+    // Only ever compared against and read through.
+    return const_cast<uint32_t*>(kFullChunk.words);
+}
+
+uint32_t IrCodeSet::chunkCount() const
+{
+    return (capacity_ + kChunkBits - 1) / kChunkBits;
+}
+
+uint32_t IrCodeSet::bitsIn(uint32_t chunk) const
+{
+    uint32_t left = capacity_ - chunk * kChunkBits;
+    return (left < kChunkBits) ? left : kChunkBits;
+}
+
+uint32_t* IrCodeSet::allocateChunk()
+{
+    void* words = allocate(sizeof(kFullChunk.words));
+    if (words != nullptr)
+    {
+        memset(words, 0, sizeof(kFullChunk.words));
+    }
+    return static_cast<uint32_t*>(words);
+}
+
+void IrCodeSet::freeChunk(uint32_t chunk)
+{
+    if (chunks_[chunk] != fullChunk())
+    {
+        free(chunks_[chunk]);
+    }
+    chunks_[chunk] = nullptr;
+    chunkCounts_[chunk] = 0;
+}
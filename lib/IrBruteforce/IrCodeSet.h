@@ -0,0 +1,63 @@
+#ifndef IR_CODE_SET_H
+#define IR_CODE_SET_H
+
+#include <Arduino.h>
+
+// Set of code indices in [0, capacity), for code spaces up to 2^24.
+// Stored as a bitmap split into kChunkBits chunks that are only allocated
+// (from PSRAM when there is any) once something in them is set. A chunk
+// that fills up is freed and points at a shared all-ones chunk in flash,
+// so a long linear sweep costs at most one live chunk. test() and set()
+// are O(1).
+class IrCodeSet
+{
+  public:
+    static constexpr uint32_t kChunkBits = 16384;
+    static constexpr uint32_t kMaxCapacity = 1UL << 24;
+
+    explicit IrCodeSet(uint32_t capacity = 0);
+    ~IrCodeSet();
+
+    IrCodeSet(const IrCodeSet&) = delete;
+    IrCodeSet& operator=(const IrCodeSet&) = delete;
+
+    // Empties the set and changes its capacity. Returns false if the chunk
+    // table could not be allocated (the set is then empty, capacity 0).
+    bool reset(uint32_t capacity);
+    void clear();
+
+    uint32_t capacity() const;
+    uint32_t count() const;
+
+    bool test(uint32_t index) const;
+    // Returns false if a chunk could not be allocated.
+    bool set(uint32_t index);
+    void erase(uint32_t index);
+
+    // Heap currently held, in bytes.
+    size_t memoryBytes() const;
+
+    // Flat encoding: capacity, then each non-empty chunk as index, kind
+    // and (for partial chunks only) its bitmap.
+    size_t serializedSize() const;
+    // Returns bytes written, or 0 if `size` is too small.
+    size_t serialize(uint8_t* out, size_t size) const;
+    bool deserialize(const uint8_t* in, size_t size);
+
+  private:
+    static constexpr uint32_t kChunkWords = kChunkBits / 32;
+
+    static uint32_t* fullChunk();
+
+    uint32_t chunkCount() const;
+    uint32_t bitsIn(uint32_t chunk) const;
+    uint32_t* allocateChunk();
+    void freeChunk(uint32_t chunk);
+
+    uint32_t capacity_;
+    uint32_t count_;
+    uint32_t** chunks_;     // nullptr = empty, fullChunk() = full
+    uint16_t* chunkCounts_; // bits set per partial chunk
+};
+
+#endif
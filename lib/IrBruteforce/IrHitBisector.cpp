@@ -0,0 +1,108 @@
+#include "IrHitBisector.h"
+
+IrHitBisector::IrHitBisector()
+: historyHead_(0)
+, historySize_(0)
+, low_(0)
+, high_(0)
+{
+}
+
+void IrHitBisector::reset()
+{
+    historyHead_ = 0;
+    historySize_ = 0;
+}
+
+void IrHitBisector::record(const IrCode& code)
+{
+    history_[historyHead_] = code;
+    historyHead_ = (historyHead_ + 1) % kWindow;
+    if (historySize_ < kWindow)
+    {
+        historySize_++;
+    }
+}
+
+void IrHitBisector::forgetNewest(size_t count)
+{
+    if (count > historySize_)
+    {
+        count = historySize_;
+    }
+
+    historyHead_ = (historyHead_ + kWindow - count) % kWindow;
+    historySize_ -= count;
+}
+
+size_t IrHitBisector::recorded() const
+{
+    return historySize_;
+}
+
+bool IrHitBisector::begin()
+{
+    if (historySize_ == 0)
+    {
+        return false;
+    }
+
+    // Unroll the ring, oldest first.
+    size_t oldest = (historyHead_ + kWindow - historySize_) % kWindow;
+    for (size_t i = 0; i < historySize_; ++i)
+    {
+        window_[i] = history_[(oldest + i) % kWindow];
+    }
+
+    low_ = 0;
+    high_ = historySize_;
+    return true;
+}
+
+size_t IrHitBisector::candidates() const
+{
+    return high_ - low_;
+}
+
+bool IrHitBisector::isolated() const
+{
+    return candidates() == 1;
+}
+
+size_t IrHitBisector::halfBegin(Half half) const
+{
+    return (half == Half::Lower) ? low_ : middle();
+}
+
+size_t IrHitBisector::halfEnd(Half half) const
+{
+    return (half == Half::Lower) ? middle() : high_;
+}
+
+const IrCode& IrHitBisector::code(size_t index) const
+{
+    return window_[index];
+}
+
+void IrHitBisector::keep(Half half)
+{
+    if (candidates() <= 1)
+    {
+        return;
+    }
+
+    size_t begin = halfBegin(half);
+    size_t end = halfEnd(half);
+    low_ = begin;
+    high_ = end;
+}
+
+const IrCode& IrHitBisector::result() const
+{
+    return window_[low_];
+}
+
+size_t IrHitBisector::middle() const
+{
+    return low_ + (high_ - low_) / 2;
+}
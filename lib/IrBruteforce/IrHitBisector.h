@@ -0,0 +1,58 @@
+#ifndef IR_HIT_BISECTOR_H
+#define IR_HIT_BISECTOR_H
+
+#include <Arduino.h>
+#include <IrProtocols.h>
+
+// Remembers the last kWindow codes sent and, once a hit is marked, narrows
+// that window down by halves until a single code is left.
+class IrHitBisector
+{
+  public:
+    enum class Half
+    {
+        Lower,
+        Upper,
+    };
+
+    static constexpr size_t kWindow = 64;
+
+    IrHitBisector();
+
+    // History of sent codes.
+    void reset();
+    void record(const IrCode& code);
+    void forgetNewest(size_t count);
+    size_t recorded() const;
+
+    // Freeze the history as the candidate window. Returns false if there
+    // is nothing to bisect.
+    bool begin();
+
+    size_t candidates() const;
+    bool isolated() const;
+
+    // Candidate indices [halfBegin, halfEnd) for each half. The codes are
+    // contiguous, oldest first, so &code(halfBegin(h)) can be sent as-is.
+    size_t halfBegin(Half half) const;
+    size_t halfEnd(Half half) const;
+    const IrCode& code(size_t index) const;
+
+    // The given half triggered the target: keep only it.
+    void keep(Half half);
+
+    const IrCode& result() const;
+
+  private:
+    size_t middle() const;
+
+    IrCode history_[kWindow];
+    size_t historyHead_; // next slot to write
+    size_t historySize_;
+
+    IrCode window_[kWindow];
+    size_t low_;
+    size_t high_;
+};
+
+#endif
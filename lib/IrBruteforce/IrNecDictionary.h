@@ -0,0 +1,76 @@
+#ifndef IR_NEC_DICTIONARY_H
+#define IR_NEC_DICTIONARY_H
+
+#include <Arduino.h>
+#include <IrNecEncoder.h>
+
+// Known standard-NEC codes, in the same byte order IrNecEncoder sends
+// (the first two bytes of the usual 0xAAaaCCcc hex form). Roughly in order
+// of how likely they are to be what you are looking for: power first,
+// then volume/mute, then the rest.
+static constexpr IrNecCode kIrNecDictionary[] = {
+    // Power
+    {0x20, 0x10}, // LG TV
+    {0x02, 0x48}, // Toshiba TV
+    {0x00, 0x02}, // generic 44-key LED strip
+    {0x5E, 0xF8}, // Yamaha AV receiver
+    {0xA5, 0x38}, // Pioneer AV receiver
+    {0x00, 0x62}, // generic lamp / LED bulb off
+
+    // Volume and mute
+    {0x20, 0x40}, // LG vol+
+    {0x20, 0xC0}, // LG vol-
+    {0x20, 0x90}, // LG mute
+    {0x02, 0x58}, // Toshiba vol+
+    {0x02, 0x78}, // Toshiba vol-
+    {0x02, 0x08}, // Toshiba mute
+    {0x5E, 0x58}, // Yamaha vol+
+    {0x5E, 0xD8}, // Yamaha vol-
+    {0x5E, 0x38}, // Yamaha mute
+    {0xA5, 0x50}, // Pioneer vol+
+    {0xA5, 0xD0}, // Pioneer vol-
+    {0xA5, 0x48}, // Pioneer mute
+
+    // Channel / input
+    {0x20, 0x00}, // LG ch+
+    {0x20, 0x80}, // LG ch-
+    {0x20, 0xD0}, // LG input
+    {0x02, 0xD8}, // Toshiba ch+
+    {0x02, 0xF8}, // Toshiba ch-
+
+    // Generic 21-key remote
+    {0x00, 0xA2},
+    {0x00, 0xE2},
+    {0x00, 0x22},
+    {0x00, 0xC2},
+    {0x00, 0xE0},
+    {0x00, 0xA8},
+    {0x00, 0x90},
+    {0x00, 0x68},
+    {0x00, 0x98},
+    {0x00, 0xB0},
+    {0x00, 0x30},
+    {0x00, 0x18},
+    {0x00, 0x7A},
+    {0x00, 0x10},
+    {0x00, 0x38},
+    {0x00, 0x5A},
+    {0x00, 0x42},
+    {0x00, 0x4A},
+    {0x00, 0x52},
+
+    // Generic 44-key LED strip
+    {0x00, 0x3A},
+    {0x00, 0xBA},
+    {0x00, 0x82},
+    {0x00, 0x1A},
+    {0x00, 0x9A},
+};
+
+// Addresses that are worth sweeping completely before the rest.
+static constexpr uint8_t kIrNecCommonAddresses[] = {
+    0x00, 0x20, 0x02, 0x5E, 0xA5, 0x04, 0x01, 0x40,
+    0x80, 0x10, 0x08, 0x7E, 0x1E, 0x0A, 0x30, 0x50,
+};
+
+#endif
@@ -0,0 +1,302 @@
+#include "IrSweepOrder.h"
+#include "IrNecDictionary.h"
+
+namespace
+{
+
+constexpr uint32_t kDictionarySize = sizeof(kIrNecDictionary) / sizeof(kIrNecDictionary[0]);
+constexpr size_t kCommonCount = sizeof(kIrNecCommonAddresses) / sizeof(kIrNecCommonAddresses[0]);
+
+constexpr uint16_t keyOf(const IrNecCode& code)
+{
+    return static_cast<uint16_t>((code.address << 8) | code.command);
+}
+
+constexpr IrCode toCode(const IrNecCode& code)
+{
+    return IrCode{code.address, code.command};
+}
+
+// Dictionary keys, sorted for binary search.
+struct DictionaryKeys
+{
+    uint16_t keys[kDictionarySize];
+};
+
+constexpr DictionaryKeys makeDictionaryKeys()
+{
+    DictionaryKeys sorted{};
+    for (size_t i = 0; i < kDictionarySize; ++i)
+    {
+        uint16_t key = keyOf(kIrNecDictionary[i]);
+        size_t j = i;
+        while (j > 0 && sorted.keys[j - 1] > key)
+        {
+            sorted.keys[j] = sorted.keys[j - 1];
+            --j;
+        }
+        sorted.keys[j] = key;
+    }
+    return sorted;
+}
+
+constexpr DictionaryKeys kDictionaryKeys = makeDictionaryKeys();
+
+constexpr bool dictionaryIsUnique()
+{
+    for (size_t i = 1; i < kDictionarySize; ++i)
+    {
+        if (kDictionaryKeys.keys[i] == kDictionaryKeys.keys[i - 1])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+constexpr bool commonAddressesAreUnique()
+{
+    for (size_t i = 0; i < kCommonCount; ++i)
+    {
+        for (size_t j = i + 1; j < kCommonCount; ++j)
+        {
+            if (kIrNecCommonAddresses[i] == kIrNecCommonAddresses[j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static_assert(dictionaryIsUnique(), "kIrNecDictionary has duplicate codes");
+static_assert(commonAddressesAreUnique(), "kIrNecCommonAddresses has duplicates");
+
+bool inDictionary(const IrCode& code)
+{
+    if (code.address > 0xFF || code.command > 0xFF)
+    {
+        return false;
+    }
+
+    uint16_t key = static_cast<uint16_t>((code.address << 8) | code.command);
+    size_t low = 0;
+    size_t high = kDictionarySize;
+    while (low < high)
+    {
+        size_t mid = (low + high) / 2;
+        if (kDictionaryKeys.keys[mid] < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return low < kDictionarySize && kDictionaryKeys.keys[low] == key;
+}
+
+} // namespace
+
+IrSweepOrder::IrSweepOrder()
+: kind_(Kind::Linear)
+, addresses_{0x00, 0xFF}
+, commands_{0x00, 0xFF}
+, addressOrder_{}
+, addressRank_{}
+, dictionaryInRange_(0)
+{
+    rebuild();
+}
+
+void IrSweepOrder::setKind(Kind kind)
+{
+    kind_ = kind;
+}
+
+IrSweepOrder::Kind IrSweepOrder::kind() const
+{
+    return dictionaryFits() ? kind_ : Kind::Linear;
+}
+
+const char* IrSweepOrder::name() const
+{
+    return (kind() == Kind::DictionaryFirst) ? "Dict first" : "Linear";
+}
+
+void IrSweepOrder::setRanges(IrSweepRange addresses, IrSweepRange commands)
+{
+    if (addresses.last < addresses.first)
+    {
+        addresses.last = addresses.first;
+    }
+    if (commands.last < commands.first)
+    {
+        commands.last = commands.first;
+    }
+
+    addresses_ = addresses;
+    commands_ = commands;
+    rebuild();
+}
+
+IrSweepRange IrSweepOrder::addresses() const
+{
+    return addresses_;
+}
+
+IrSweepRange IrSweepOrder::commands() const
+{
+    return commands_;
+}
+
+uint32_t IrSweepOrder::positions() const
+{
+    uint32_t codes = totalCodes();
+    return (kind() == Kind::DictionaryFirst) ? kDictionarySize + codes : codes;
+}
+
+uint32_t IrSweepOrder::totalCodes() const
+{
+    return addresses_.size() * commands_.size();
+}
+
+bool IrSweepOrder::codeAt(uint32_t position, IrCode& code) const
+{
+    code = rawCodeAt(position);
+    return !isSkipped(position, code);
+}
+
+uint32_t IrSweepOrder::nextSent(uint32_t position) const
+{
+    uint32_t end = positions();
+    while (position < end && isSkipped(position, rawCodeAt(position)))
+    {
+        position++;
+    }
+    return position;
+}
+
+uint32_t IrSweepOrder::codesBefore(uint32_t position) const
+{
+    if (kind() != Kind::DictionaryFirst)
+    {
+        return position;
+    }
+
+    // Dictionary phase, then the later phases minus the skipped repeats of
+    // dictionary codes that lie before `position`.
+    uint32_t count = 0;
+    uint32_t width = commands_.size();
+    for (size_t i = 0; i < kDictionarySize; ++i)
+    {
+        const IrNecCode& code = kIrNecDictionary[i];
+        if (!addresses_.contains(code.address) || !commands_.contains(code.command))
+        {
+            continue;
+        }
+
+        if (i < position)
+        {
+            count++;
+        }
+
+        uint32_t repeat = kDictionarySize + addressRank_[code.address] * width +
+                          (code.command - commands_.first);
+        if (repeat < position)
+        {
+            count--;
+        }
+    }
+
+    if (position > kDictionarySize)
+    {
+        count += position - kDictionarySize;
+    }
+    return count;
+}
+
+bool IrSweepOrder::dictionaryFits() const
+{
+    return addresses_.last <= 0xFF && commands_.last <= 0xFF;
+}
+
+void IrSweepOrder::rebuild()
+{
+    dictionaryInRange_ = 0;
+    if (!dictionaryFits())
+    {
+        return;
+    }
+
+    bool used[256] = {};
+    size_t n = 0;
+
+    for (size_t i = 0; i < kCommonCount; ++i)
+    {
+        uint8_t address = kIrNecCommonAddresses[i];
+        if (addresses_.contains(address))
+        {
+            used[address] = true;
+            addressOrder_[n++] = address;
+        }
+    }
+
+    for (uint32_t address = addresses_.first; address <= addresses_.last; ++address)
+    {
+        if (!used[address])
+        {
+            addressOrder_[n++] = static_cast<uint8_t>(address);
+        }
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        addressRank_[addressOrder_[i]] = static_cast<uint8_t>(i);
+    }
+
+    for (size_t i = 0; i < kDictionarySize; ++i)
+    {
+        const IrNecCode& code = kIrNecDictionary[i];
+        if (addresses_.contains(code.address) && commands_.contains(code.command))
+        {
+            dictionaryInRange_++;
+        }
+    }
+}
+
+IrCode IrSweepOrder::rawCodeAt(uint32_t position) const
+{
+    uint32_t width = commands_.size();
+
+    if (kind() != Kind::DictionaryFirst)
+    {
+        return IrCode{static_cast<uint16_t>(addresses_.first + position / width),
+                      static_cast<uint16_t>(commands_.first + position % width)};
+    }
+
+    if (position < kDictionarySize)
+    {
+        return toCode(kIrNecDictionary[position]);
+    }
+
+    position -= kDictionarySize;
+    return IrCode{addressOrder_[(position / width) & 0xFF],
+                  static_cast<uint16_t>(commands_.first + position % width)};
+}
+
+bool IrSweepOrder::isSkipped(uint32_t position, const IrCode& code) const
+{
+    if (kind() != Kind::DictionaryFirst)
+    {
+        return false;
+    }
+
+    if (position < kDictionarySize)
+    {
+        return !addresses_.contains(code.address) || !commands_.contains(code.command);
+    }
+
+    return dictionaryInRange_ > 0 && inDictionary(code);
+}
@@ -0,0 +1,83 @@
+#ifndef IR_SWEEP_ORDER_H
+#define IR_SWEEP_ORDER_H
+
+#include <Arduino.h>
+#include <IrProtocols.h>
+
+// Inclusive value range.
+struct IrSweepRange
+{
+    uint16_t first;
+    uint16_t last;
+
+    uint32_t size() const
+    {
+        return static_cast<uint32_t>(last) - first + 1;
+    }
+
+    bool contains(uint16_t value) const
+    {
+        return value >= first && value <= last;
+    }
+};
+
+// Maps a sweep position to the code sent there. Positions are random
+// access, so a checkpoint only needs the position. Only codes inside the
+// address and command ranges are ever produced.
+//
+// DictionaryFirst walks kIrNecDictionary, then every command of the
+// common addresses, then everything else. Dictionary codes come round a
+// second time in the later phases; those positions are skipped, as are
+// dictionary entries outside the ranges, so every code is still sent
+// exactly once. The dictionary is NEC's and only fits byte-sized ranges;
+// wider ranges always sweep linearly.
+class IrSweepOrder
+{
+  public:
+    enum class Kind : uint8_t
+    {
+        Linear,
+        DictionaryFirst,
+    };
+
+    IrSweepOrder();
+
+    void setKind(Kind kind);
+    Kind kind() const;
+    const char* name() const;
+
+    void setRanges(IrSweepRange addresses, IrSweepRange commands);
+    IrSweepRange addresses() const;
+    IrSweepRange commands() const;
+
+    // Size of the position space (>= totalCodes()).
+    uint32_t positions() const;
+    // Distinct codes covered.
+    uint32_t totalCodes() const;
+
+    // Returns false if `position` is a repeat to be skipped.
+    bool codeAt(uint32_t position, IrCode& code) const;
+
+    // First position >= `position` that is not skipped, or positions().
+    uint32_t nextSent(uint32_t position) const;
+    // Number of codes sent before reaching `position`.
+    uint32_t codesBefore(uint32_t position) const;
+
+  private:
+    bool dictionaryFits() const;
+    void rebuild();
+    IrCode rawCodeAt(uint32_t position) const;
+    bool isSkipped(uint32_t position, const IrCode& code) const;
+
+    Kind kind_;
+    IrSweepRange addresses_;
+    IrSweepRange commands_;
+
+    // Address order after the dictionary phase: common addresses in range
+    // first, then the rest of the range ascending. Rank is the inverse.
+    uint8_t addressOrder_[256];
+    uint8_t addressRank_[256];
+    uint32_t dictionaryInRange_;
+};
+
+#endif
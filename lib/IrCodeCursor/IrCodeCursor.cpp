@@ -0,0 +1,279 @@
+#include "IrCodeCursor.h"
+
+namespace
+{
+
+uint8_t hexDigits(uint8_t bits)
+{
+    return static_cast<uint8_t>((bits + 3) / 4);
+}
+
+} // namespace
+
+IrCodeCursor::IrCodeCursor()
+: protocol_(&irProtocolInfo(IrProtocolId::Nec))
+, index_(0)
+, entry_(Entry::Step)
+, digit_(0)
+, recent_()
+, recentCount_(0)
+, recentPosition_(0)
+{
+}
+
+IrProtocolId IrCodeCursor::protocol() const
+{
+    return protocol_->id;
+}
+
+void IrCodeCursor::setProtocol(IrProtocolId protocol)
+{
+    uint16_t oldAddress = address();
+    uint8_t oldCommand = command();
+    protocol_ = &irProtocolInfo(protocol);
+    setCode(min(oldAddress, protocol_->maxAddress()),
+            static_cast<uint8_t>(min<uint16_t>(oldCommand, protocol_->maxCommand())));
+
+    // The digit being edited may not exist any more.
+    if (digit_ >= digits())
+    {
+        digit_ = 0;
+    }
+}
+
+uint32_t IrCodeCursor::codeSpace() const
+{
+    return protocol_->codeSpace();
+}
+
+uint32_t IrCodeCursor::index() const
+{
+    return index_;
+}
+
+uint16_t IrCodeCursor::address() const
+{
+    return static_cast<uint16_t>(index_ >> protocol_->commandBits);
+}
+
+uint8_t IrCodeCursor::command() const
+{
+    return static_cast<uint8_t>(index_ & protocol_->maxCommand());
+}
+
+IrTaggedCode IrCodeCursor::code() const
+{
+    return IrTaggedCode(protocol_->id, address(), command());
+}
+
+void IrCodeCursor::setIndex(uint32_t index)
+{
+    index_ = index % codeSpace();
+}
+
+void IrCodeCursor::cycleEntry()
+{
+    switch (entry_)
+    {
+        case Entry::Step:
+            entry_ = Entry::Digits;
+            digit_ = 0;
+            break;
+
+        case Entry::Digits:
+            if (recentCount_ == 0)
+            {
+                entry_ = Entry::Step;
+                break;
+            }
+            entry_ = Entry::Recent;
+            recentPosition_ = 0;
+            protocol_ = &irProtocolInfo(recent_[0].protocol);
+            setCode(recent_[0].address, recent_[0].command);
+            break;
+
+        case Entry::Recent:
+            entry_ = Entry::Step;
+            break;
+    }
+}
+
+IrCodeCursor::Entry IrCodeCursor::entry() const
+{
+    return entry_;
+}
+
+bool IrCodeCursor::move(int32_t steps)
+{
+    switch (entry_)
+    {
+        case Entry::Digits:
+            return adjustDigit(steps);
+        case Entry::Recent:
+            return browseRecent(steps);
+        case Entry::Step:
+            break;
+    }
+    return step(steps);
+}
+
+bool IrCodeCursor::select()
+{
+    if (entry_ != Entry::Digits)
+    {
+        return false;
+    }
+
+    if (++digit_ >= digits())
+    {
+        entry_ = Entry::Step;
+        digit_ = 0;
+    }
+    return true;
+}
+
+uint8_t IrCodeCursor::digit() const
+{
+    return digit_;
+}
+
+uint8_t IrCodeCursor::digits() const
+{
+    return static_cast<uint8_t>(addressDigits() + commandDigits());
+}
+
+uint8_t IrCodeCursor::addressDigits() const
+{
+    return hexDigits(protocol_->addressBits);
+}
+
+void IrCodeCursor::remember()
+{
+    // A code recalled from the list keeps its place, so browsing it while
+    // sending does not reshuffle it underfoot.
+    if (entry_ == Entry::Recent)
+    {
+        return;
+    }
+
+    IrTaggedCode current = code();
+    size_t found = recentCount_;
+    for (size_t i = 0; i < recentCount_; ++i)
+    {
+        if (recent_[i].protocol == current.protocol && recent_[i].address == current.address &&
+            recent_[i].command == current.command)
+        {
+            found = i;
+            break;
+        }
+    }
+    if (found == recentCount_ && recentCount_ < kRecentSize)
+    {
+        recentCount_++;
+    }
+
+    // Shift the newer entries down over the old copy (or the oldest).
+    for (size_t i = min(found, kRecentSize - 1); i > 0; --i)
+    {
+        recent_[i] = recent_[i - 1];
+    }
+    recent_[0] = current;
+    recentPosition_ = 0;
+}
+
+size_t IrCodeCursor::recentCount() const
+{
+    return recentCount_;
+}
+
+size_t IrCodeCursor::recentPosition() const
+{
+    return recentPosition_;
+}
+
+bool IrCodeCursor::step(int32_t steps)
+{
+    if (steps == 0)
+    {
+        return false;
+    }
+
+    // Jumps of 16 or more land on multiples of 16 or 256, so a long hold
+    // runs through 12:00, 13:00 ... rather than 12:07, 13:07 ...
+    uint32_t space = codeSpace();
+    uint32_t distance = static_cast<uint32_t>(steps < 0 ? -steps : steps) % space;
+    uint32_t unit = (distance >= 256) ? 256 : (distance >= 16) ? 16 : 1;
+    uint32_t offset = index_ % unit;
+
+    uint32_t index;
+    if (steps > 0)
+    {
+        index = index_ - offset + distance;
+    }
+    else if (offset != 0)
+    {
+        index = index_ + space - offset - (distance - unit);
+    }
+    else
+    {
+        index = index_ + space - distance;
+    }
+    setIndex(index);
+    return true;
+}
+
+bool IrCodeCursor::adjustDigit(int32_t steps)
+{
+    // Wraps within the digit; nothing carries into its neighbour. A field
+    // whose width is not a multiple of four (Sony's 5-bit address) has a
+    // top digit that only runs as far as the field does.
+    bool inAddress = digit_ < addressDigits();
+    uint32_t field = inAddress ? address() : command();
+    uint32_t fieldMax = inAddress ? protocol_->maxAddress() : protocol_->maxCommand();
+    uint8_t fieldDigit = inAddress ? digit_ : static_cast<uint8_t>(digit_ - addressDigits());
+    uint8_t fieldDigits = inAddress ? addressDigits() : commandDigits();
+
+    uint32_t shift = 4 * (fieldDigits - 1 - fieldDigit);
+    int32_t values = static_cast<int32_t>(min<uint32_t>(15, fieldMax >> shift)) + 1;
+    int32_t value = static_cast<int32_t>((field >> shift) & 0xF);
+    int32_t adjusted = ((value + steps % values) % values + values) % values;
+    field = (field & ~(0xFU << shift)) | (static_cast<uint32_t>(adjusted) << shift);
+
+    if (inAddress)
+    {
+        setCode(static_cast<uint16_t>(field), command());
+    }
+    else
+    {
+        setCode(address(), static_cast<uint8_t>(field));
+    }
+    return adjusted != value;
+}
+
+bool IrCodeCursor::browseRecent(int32_t steps)
+{
+    if (recentCount_ == 0)
+    {
+        return false;
+    }
+
+    // Down goes back in time, wrapping to the newest.
+    int32_t position = (recentPosition_ + steps % recentCount_ + recentCount_) % recentCount_;
+    recentPosition_ = static_cast<uint8_t>(position);
+    IrTaggedCode previous = code();
+    const IrTaggedCode& recalled = recent_[recentPosition_];
+    protocol_ = &irProtocolInfo(recalled.protocol);
+    setCode(recalled.address, recalled.command);
+    return recalled.protocol != previous.protocol || recalled.address != previous.address ||
+           recalled.command != previous.command;
+}
+
+void IrCodeCursor::setCode(uint16_t address, uint8_t command)
+{
+    index_ = (static_cast<uint32_t>(address) << protocol_->commandBits) | command;
+}
+
+uint8_t IrCodeCursor::commandDigits() const
+{
+    return hexDigits(protocol_->commandBits);
+}
@@ -0,0 +1,87 @@
+#ifndef IR_CODE_CURSOR_H
+#define IR_CODE_CURSOR_H
+
+#include <Arduino.h>
+#include <IrProtocols.h>
+
+// A position in a protocol's code space (the address above the command
+// bits, so NEC's runs address * 256 + command) and the three ways Up/Down
+// move it, so any code is a few presses away instead of tens of thousands
+// of steps:
+//
+//   Step    - by the held-button step count, in aligned jumps of 16 and
+//             256 once it reaches them
+//   Digits  - one hex digit at a time, Select moving to the next
+//   Recent  - through the last codes sent, newest first, whatever their
+//             protocol
+class IrCodeCursor
+{
+  public:
+    enum class Entry : uint8_t
+    {
+        Step,
+        Digits,
+        Recent,
+    };
+
+    static constexpr size_t kRecentSize = 8;
+
+    IrCodeCursor();
+
+    // Starts on NEC. A new protocol keeps the address and command as far
+    // as its fields reach.
+    IrProtocolId protocol() const;
+    void setProtocol(IrProtocolId protocol);
+    uint32_t codeSpace() const;
+
+    uint32_t index() const;
+    uint16_t address() const;
+    uint8_t command() const;
+    IrTaggedCode code() const;
+    void setIndex(uint32_t index);
+
+    // Step -> Digits -> Recent -> Step. Digits starts on the address's
+    // high digit; Recent on the newest code, or is skipped while empty.
+    void cycleEntry();
+    Entry entry() const;
+
+    // Up (negative) or Down, as the entry mode means it. Returns true if
+    // the code changed.
+    bool move(int32_t steps);
+
+    // Select while entering digits: on to the next digit, back to Step
+    // after the last. Returns false (Select keeps its usual meaning)
+    // outside Digits.
+    bool select();
+
+    // The digit being edited: the address's hex digits, high first, then
+    // the command's.
+    uint8_t digit() const;
+    uint8_t digits() const;
+    uint8_t addressDigits() const;
+
+    // Records the current code as sent; an older copy moves to the front.
+    // Does nothing in Recent, where the code is already listed.
+    void remember();
+    size_t recentCount() const;
+    // 0 = newest.
+    size_t recentPosition() const;
+
+  private:
+    bool step(int32_t steps);
+    bool adjustDigit(int32_t steps);
+    bool browseRecent(int32_t steps);
+    void setCode(uint16_t address, uint8_t command);
+    uint8_t commandDigits() const;
+
+    const IrProtocolInfo* protocol_;
+    uint32_t index_;
+    Entry entry_;
+    uint8_t digit_;
+
+    IrTaggedCode recent_[kRecentSize]; // newest first
+    uint8_t recentCount_;
+    uint8_t recentPosition_;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "IrCodeFields.h"
+#include <FieldFormat.h>
+
+namespace
+{
+
+constexpr int kCodeTextSize = 3;
+
+} // namespace
+
+IrCodeFields::IrCodeFields(lgfx::LovyanGFX& screen, int indexY, int codeY)
+: indexField_(screen, 8, indexY, 2, TFT_DARKGREY)
+, entryField_(screen, 140, indexY + 4, 1, TFT_CYAN)
+, codeField_(screen, 8, codeY, kCodeTextSize, TFT_WHITE)
+, protocolField_(screen, 140, codeY + 8, 1, TFT_YELLOW)
+, caretField_(screen, 8, codeY + 8 * kCodeTextSize + 1, 1, TFT_CYAN)
+{
+}
+
+void IrCodeFields::invalidate()
+{
+    indexField_.invalidate();
+    entryField_.invalidate();
+    codeField_.invalidate();
+    protocolField_.invalidate();
+    caretField_.invalidate();
+}
+
+void IrCodeFields::draw(const IrCodeCursor& cursor)
+{
+    char text[TextField::kMaxChars + 1];
+    char* end = text;
+    *end++ = '#';
+    end = formatDecimal(end, cursor.index());
+    *end = '\0';
+    indexField_.draw(text);
+
+    uint8_t addressDigits = cursor.addressDigits();
+    end = formatHex(text, cursor.address(), addressDigits);
+    *end++ = ':';
+    end = formatHex(end, cursor.command(), cursor.digits() - addressDigits);
+    *end = '\0';
+    codeField_.draw(text);
+    protocolField_.draw(irProtocolInfo(cursor.protocol()).name);
+
+    switch (cursor.entry())
+    {
+        case IrCodeCursor::Entry::Step:
+            entryField_.clear();
+            caretField_.clear();
+            break;
+
+        case IrCodeCursor::Entry::Digits:
+        {
+            entryField_.draw("digits");
+
+            // Size-1 cells under the size-3 code: the middle of code
+            // character n is cell 3n + 1. The colon follows the address.
+            int character = cursor.digit() + (cursor.digit() >= addressDigits ? 1 : 0);
+            int cell = character * kCodeTextSize + 1;
+            memset(text, ' ', cell);
+            text[cell] = '^';
+            text[cell + 1] = '\0';
+            caretField_.draw(text);
+            break;
+        }
+
+        case IrCodeCursor::Entry::Recent:
+            end = formatText(text, "recent ");
+            end = formatDecimal(end, cursor.recentPosition() + 1);
+            *end++ = '/';
+            end = formatDecimal(end, cursor.recentCount());
+            *end = '\0';
+            entryField_.draw(text);
+            caretField_.clear();
+            break;
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef IR_CODE_FIELDS_H
+#define IR_CODE_FIELDS_H
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <TextField.h>
+#include "IrCodeCursor.h"
+
+// How the senders show a cursor: "#index" and the entry mode on one line,
+// "AA:CC" large below it (as many digits as the protocol's fields need)
+// with the protocol beside it and a caret under the digit being entered.
+// Only what changed is repainted.
+class IrCodeFields
+{
+  public:
+    // Index line at indexY (text size 2), code at codeY (size 3).
+    IrCodeFields(lgfx::LovyanGFX& screen, int indexY, int codeY);
+
+    // The screen was cleared: repaint everything on the next draw().
+    void invalidate();
+    void draw(const IrCodeCursor& cursor);
+
+  private:
+    TextField indexField_;
+    TextField entryField_;
+    TextField codeField_;
+    TextField protocolField_;
+    TextField caretField_;
+};
+
+#endif
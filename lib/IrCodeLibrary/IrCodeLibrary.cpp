@@ -0,0 +1,299 @@
+#include "IrCodeLibrary.h"
+
+namespace
+{
+
+// Code index order: protocol, then address, then command.
+uint64_t codeKey(uint8_t protocol, uint16_t address, uint16_t command)
+{
+    return (static_cast<uint64_t>(protocol) << 32) | (static_cast<uint32_t>(address) << 16) | command;
+}
+
+bool aligned(uint32_t offset)
+{
+    return (offset & 3) == 0;
+}
+
+// [offset, offset + bytes) starts at or after `from` and ends by `to`.
+bool section(uint32_t offset, uint64_t bytes, uint32_t from, uint32_t to)
+{
+    return aligned(offset) && offset >= from && offset + bytes <= to;
+}
+
+} // namespace
+
+IrCodeLibrary::IrCodeLibrary()
+: map_(0)
+, mapped_(false)
+, profiles_(nullptr)
+, commands_(nullptr)
+, codeIndex_(nullptr)
+, strings_(nullptr)
+, stringBytes_(0)
+, profileCount_(0)
+, commandCount_(0)
+{
+}
+
+IrCodeLibrary::~IrCodeLibrary()
+{
+    end();
+}
+
+bool IrCodeLibrary::begin()
+{
+    end();
+
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, static_cast<esp_partition_subtype_t>(kPartitionSubtype), kPartitionLabel);
+    if (partition == nullptr)
+    {
+        return false;
+    }
+
+    if (!mapImage(partition) || !checkProfiles())
+    {
+        end();
+        return false;
+    }
+    return true;
+}
+
+void IrCodeLibrary::end()
+{
+    if (mapped_)
+    {
+        spi_flash_munmap(map_);
+        mapped_ = false;
+    }
+    profiles_ = nullptr;
+    commands_ = nullptr;
+    codeIndex_ = nullptr;
+    strings_ = nullptr;
+    stringBytes_ = 0;
+    profileCount_ = 0;
+    commandCount_ = 0;
+}
+
+bool IrCodeLibrary::available() const
+{
+    return mapped_;
+}
+
+size_t IrCodeLibrary::profileCount() const
+{
+    return profileCount_;
+}
+
+size_t IrCodeLibrary::commandCount() const
+{
+    return commandCount_;
+}
+
+const char* IrCodeLibrary::profileName(size_t profile) const
+{
+    return string(profiles_[profile].nameOffset);
+}
+
+size_t IrCodeLibrary::profileSize(size_t profile) const
+{
+    return profiles_[profile].commandCount;
+}
+
+IrLibraryCommand IrCodeLibrary::command(size_t profile, size_t index) const
+{
+    return commandAt(profiles_[profile].firstCommand + static_cast<uint32_t>(index));
+}
+
+size_t IrCodeLibrary::findProfile(const char* name) const
+{
+    size_t low = 0;
+    size_t high = profileCount_;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        int order = strcmp(profileName(middle), name);
+        if (order == 0)
+        {
+            return middle;
+        }
+        if (order < 0)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return kNotFound;
+}
+
+bool IrCodeLibrary::findCode(IrProtocolId protocol, const IrCode& code, size_t& profile, size_t& index) const
+{
+    uint64_t key = codeKey(static_cast<uint8_t>(protocol), code.address, code.command);
+    auto keyAt = [this](size_t position) {
+        uint32_t command = codeIndex_[position];
+        if (command >= commandCount_)
+        {
+            return UINT64_MAX; // a bad entry matches nothing
+        }
+        const IrLibraryCommandRecord& record = commands_[command];
+        return codeKey(record.protocol, record.address, record.command);
+    };
+
+    // First entry not below the key.
+    size_t low = 0;
+    size_t high = commandCount_;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (keyAt(middle) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    if (low == commandCount_ || keyAt(low) != key)
+    {
+        return false;
+    }
+    uint32_t command = codeIndex_[low];
+
+    // The last profile starting at or before it owns it; empty profiles
+    // share their start with the next one, so they are passed over.
+    low = 0;
+    high = profileCount_;
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (profiles_[middle].firstCommand <= command)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    profile = low - 1;
+    index = command - profiles_[profile].firstCommand;
+    return true;
+}
+
+bool IrCodeLibrary::mapImage(const esp_partition_t* partition)
+{
+    // The header says how much of the partition the image uses, so only
+    // that much is mapped.
+    IrLibraryHeader header;
+    if (partition->size < sizeof(header) ||
+        esp_partition_read(partition, 0, &header, sizeof(header)) != ESP_OK)
+    {
+        return false;
+    }
+
+    if (memcmp(header.magic, kIrLibraryMagic, sizeof(header.magic)) != 0 ||
+        header.version != kIrLibraryVersion || header.headerBytes != sizeof(header) ||
+        header.imageBytes > partition->size)
+    {
+        return false;
+    }
+
+    uint64_t profileBytes = static_cast<uint64_t>(header.profileCount) * sizeof(IrLibraryProfileRecord);
+    uint64_t commandBytes = static_cast<uint64_t>(header.commandCount) * sizeof(IrLibraryCommandRecord);
+    uint64_t indexBytes = static_cast<uint64_t>(header.commandCount) * sizeof(uint32_t);
+    if (!section(header.profilesOffset, profileBytes, header.headerBytes, header.commandsOffset) ||
+        !section(header.commandsOffset, commandBytes, header.profilesOffset, header.codeIndexOffset) ||
+        !section(header.codeIndexOffset, indexBytes, header.commandsOffset, header.stringsOffset) ||
+        header.stringsOffset >= header.imageBytes)
+    {
+        return false;
+    }
+
+    const void* image = nullptr;
+    if (esp_partition_mmap(partition, 0, header.imageBytes, SPI_FLASH_MMAP_DATA, &image, &map_) != ESP_OK)
+    {
+        return false;
+    }
+    mapped_ = true;
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(image);
+    if (bytes[header.imageBytes - 1] != 0)
+    {
+        return false; // the last name would run off the end
+    }
+
+    profiles_ = reinterpret_cast<const IrLibraryProfileRecord*>(bytes + header.profilesOffset);
+    commands_ = reinterpret_cast<const IrLibraryCommandRecord*>(bytes + header.commandsOffset);
+    codeIndex_ = reinterpret_cast<const uint32_t*>(bytes + header.codeIndexOffset);
+    strings_ = reinterpret_cast<const char*>(bytes + header.stringsOffset);
+    stringBytes_ = header.imageBytes - header.stringsOffset;
+    profileCount_ = header.profileCount;
+    commandCount_ = header.commandCount;
+    return true;
+}
+
+bool IrCodeLibrary::checkProfiles() const
+{
+    // Runs must tile the commands in order, which the code search relies
+    // on to find a command's profile.
+    uint32_t next = 0;
+    for (uint32_t profile = 0; profile < profileCount_; ++profile)
+    {
+        const IrLibraryProfileRecord& record = profiles_[profile];
+        if (record.firstCommand != next || record.commandCount > commandCount_ - next)
+        {
+            return false;
+        }
+        next += record.commandCount;
+    }
+    return next == commandCount_;
+}
+
+const char* IrCodeLibrary::string(uint32_t offset) const
+{
+    return (offset < stringBytes_) ? strings_ + offset : "";
+}
+
+IrLibraryCommand IrCodeLibrary::commandAt(uint32_t command) const
+{
+    const IrLibraryCommandRecord& record = commands_[command];
+    return IrLibraryCommand{string(record.nameOffset), static_cast<IrProtocolId>(record.protocol),
+                            IrCode{record.address, record.command}};
+}
+
+IrLibraryProfile::IrLibraryProfile(const IrCodeLibrary& library)
+: library_(library)
+, profile_(0)
+{
+}
+
+void IrLibraryProfile::select(size_t profile)
+{
+    profile_ = profile;
+}
+
+size_t IrLibraryProfile::profile() const
+{
+    return profile_;
+}
+
+const char* IrLibraryProfile::name() const
+{
+    return (profile_ < library_.profileCount()) ? library_.profileName(profile_) : "";
+}
+
+size_t IrLibraryProfile::size() const
+{
+    return (profile_ < library_.profileCount()) ? library_.profileSize(profile_) : 0;
+}
+
+IrCommand IrLibraryProfile::at(size_t index) const
+{
+    IrLibraryCommand command = library_.command(profile_, index);
+    return IrCommand{command.name, IrTaggedCode(command.protocol, command.code.address,
+                                                 static_cast<uint8_t>(command.code.command))};
+}
@@ -0,0 +1,91 @@
+#ifndef IR_CODE_LIBRARY_H
+#define IR_CODE_LIBRARY_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <IrCommandList.h>
+#include <IrProtocols.h>
+#include "IrCodeLibraryFormat.h"
+
+struct IrLibraryCommand
+{
+    const char* name;
+    IrProtocolId protocol;
+    IrCode code;
+};
+
+// The remote code library in its own flash partition (see
+// IrCodeLibraryFormat.h). begin() maps the image into the address space
+// once; after that every lookup reads flash through the cache and
+// nothing is copied, so thousands of commands cost the handful of
+// pointers below in RAM. Profiles are found by name and codes by value
+// with binary searches over the sorted tables.
+class IrCodeLibrary
+{
+  public:
+    static constexpr const char* kPartitionLabel = "irlib";
+    static constexpr uint8_t kPartitionSubtype = 0x40; // first custom data subtype
+    static constexpr size_t kNotFound = SIZE_MAX;
+
+    IrCodeLibrary();
+    ~IrCodeLibrary();
+
+    // Maps the partition and checks the image. Returns false, leaving the
+    // library empty, if there is no partition or it holds no valid image.
+    bool begin();
+    void end();
+    bool available() const;
+
+    size_t profileCount() const;
+    size_t commandCount() const;
+
+    // Indices must be in range.
+    const char* profileName(size_t profile) const;
+    size_t profileSize(size_t profile) const;
+    IrLibraryCommand command(size_t profile, size_t index) const;
+
+    // kNotFound if no profile has exactly this name.
+    size_t findProfile(const char* name) const;
+
+    // The first command (in profile order) sending `code`. Returns false
+    // if none does.
+    bool findCode(IrProtocolId protocol, const IrCode& code, size_t& profile, size_t& index) const;
+
+  private:
+    bool mapImage(const esp_partition_t* partition);
+    bool checkProfiles() const;
+    const char* string(uint32_t offset) const;
+    IrLibraryCommand commandAt(uint32_t command) const;
+
+    spi_flash_mmap_handle_t map_;
+    bool mapped_;
+    const IrLibraryProfileRecord* profiles_;
+    const IrLibraryCommandRecord* commands_;
+    const uint32_t* codeIndex_;
+    const char* strings_;
+    uint32_t stringBytes_;
+    uint32_t profileCount_;
+    uint32_t commandCount_;
+};
+
+// One profile of the library as a list for IrRemote. Rows are read from
+// flash as they are drawn.
+class IrLibraryProfile : public IrCommandList
+{
+  public:
+    explicit IrLibraryProfile(const IrCodeLibrary& library);
+
+    // Out of range (or an empty library) gives an empty list.
+    void select(size_t profile);
+    size_t profile() const;
+    const char* name() const;
+
+    size_t size() const override;
+    IrCommand at(size_t index) const override;
+
+  private:
+    const IrCodeLibrary& library_;
+    size_t profile_;
+};
+
+#endif
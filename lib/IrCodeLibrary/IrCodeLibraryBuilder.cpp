@@ -0,0 +1,137 @@
+#ifndef ESP32
+
+#include "IrCodeLibraryBuilder.h"
+#include <algorithm>
+#include <map>
+
+namespace
+{
+
+// Names are stored once however many commands share them.
+class StringTable
+{
+  public:
+    uint32_t add(const std::string& text)
+    {
+        auto found = offsets_.find(text);
+        if (found != offsets_.end())
+        {
+            return found->second;
+        }
+        uint32_t offset = static_cast<uint32_t>(bytes_.size());
+        bytes_.insert(bytes_.end(), text.begin(), text.end());
+        bytes_.push_back(0);
+        offsets_.emplace(text, offset);
+        return offset;
+    }
+
+    const std::vector<uint8_t>& bytes() const
+    {
+        return bytes_;
+    }
+
+  private:
+    std::map<std::string, uint32_t> offsets_;
+    std::vector<uint8_t> bytes_;
+};
+
+uint32_t align4(size_t offset)
+{
+    return static_cast<uint32_t>((offset + 3) & ~static_cast<size_t>(3));
+}
+
+template <typename Record>
+void put(std::vector<uint8_t>& image, size_t offset, const Record& record)
+{
+    memcpy(image.data() + offset, &record, sizeof(record));
+}
+
+} // namespace
+
+void IrCodeLibraryBuilder::add(const char* profile, const char* name, IrProtocolId protocol,
+                               uint16_t address, uint16_t command)
+{
+    commands_.push_back(Command{profile, name, protocol, address, command});
+}
+
+std::vector<uint8_t> IrCodeLibraryBuilder::build() const
+{
+    // Profiles in byte order of their names; a stable sort keeps each
+    // profile's commands as they were added.
+    std::vector<Command> commands = commands_;
+    std::stable_sort(commands.begin(), commands.end(), [](const Command& a, const Command& b) {
+        return strcmp(a.profile.c_str(), b.profile.c_str()) < 0;
+    });
+
+    StringTable strings;
+    std::vector<IrLibraryProfileRecord> profiles;
+    std::vector<IrLibraryCommandRecord> records;
+    for (const Command& command : commands)
+    {
+        if (profiles.empty() || command.profile != commands[profiles.back().firstCommand].profile)
+        {
+            profiles.push_back(IrLibraryProfileRecord{strings.add(command.profile),
+                                                      static_cast<uint32_t>(records.size()), 0});
+        }
+        profiles.back().commandCount++;
+        records.push_back(IrLibraryCommandRecord{strings.add(command.name), command.address, command.command,
+                                                 static_cast<uint8_t>(command.protocol), {0, 0, 0}});
+    }
+
+    std::vector<uint32_t> codeIndex(records.size());
+    for (size_t i = 0; i < codeIndex.size(); ++i)
+    {
+        codeIndex[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(codeIndex.begin(), codeIndex.end(), [&records](uint32_t a, uint32_t b) {
+        const IrLibraryCommandRecord& x = records[a];
+        const IrLibraryCommandRecord& y = records[b];
+        if (x.protocol != y.protocol)
+        {
+            return x.protocol < y.protocol;
+        }
+        if (x.address != y.address)
+        {
+            return x.address < y.address;
+        }
+        return x.command < y.command;
+    });
+
+    IrLibraryHeader header{};
+    memcpy(header.magic, kIrLibraryMagic, sizeof(header.magic));
+    header.version = kIrLibraryVersion;
+    header.headerBytes = sizeof(header);
+    header.profileCount = static_cast<uint32_t>(profiles.size());
+    header.commandCount = static_cast<uint32_t>(records.size());
+    header.profilesOffset = align4(sizeof(header));
+    header.commandsOffset = align4(header.profilesOffset + profiles.size() * sizeof(IrLibraryProfileRecord));
+    header.codeIndexOffset = align4(header.commandsOffset + records.size() * sizeof(IrLibraryCommandRecord));
+    header.stringsOffset = align4(header.codeIndexOffset + codeIndex.size() * sizeof(uint32_t));
+
+    // An empty library still ends in a NUL.
+    std::vector<uint8_t> stringBytes = strings.bytes();
+    if (stringBytes.empty())
+    {
+        stringBytes.push_back(0);
+    }
+    header.imageBytes = static_cast<uint32_t>(header.stringsOffset + stringBytes.size());
+
+    std::vector<uint8_t> image(header.imageBytes, 0);
+    put(image, 0, header);
+    for (size_t i = 0; i < profiles.size(); ++i)
+    {
+        put(image, header.profilesOffset + i * sizeof(IrLibraryProfileRecord), profiles[i]);
+    }
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        put(image, header.commandsOffset + i * sizeof(IrLibraryCommandRecord), records[i]);
+    }
+    for (size_t i = 0; i < codeIndex.size(); ++i)
+    {
+        put(image, header.codeIndexOffset + i * sizeof(uint32_t), codeIndex[i]);
+    }
+    memcpy(image.data() + header.stringsOffset, stringBytes.data(), stringBytes.size());
+    return image;
+}
+
+#endif
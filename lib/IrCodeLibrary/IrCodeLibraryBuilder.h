@@ -0,0 +1,39 @@
+#ifndef IR_CODE_LIBRARY_BUILDER_H
+#define IR_CODE_LIBRARY_BUILDER_H
+
+#ifndef ESP32
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include <IrProtocols.h>
+#include "IrCodeLibraryFormat.h"
+
+// Host-only: lays out a code library image the way
+// tools/build_irlib.py does, for the benches and the native build to hand
+// to nativeSetPartition().
+class IrCodeLibraryBuilder
+{
+  public:
+    // Commands keep the order they are added in within their profile.
+    void add(const char* profile, const char* name, IrProtocolId protocol, uint16_t address,
+             uint16_t command);
+
+    std::vector<uint8_t> build() const;
+
+  private:
+    struct Command
+    {
+        std::string profile;
+        std::string name;
+        IrProtocolId protocol;
+        uint16_t address;
+        uint16_t command;
+    };
+
+    std::vector<Command> commands_;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef IR_CODE_LIBRARY_FORMAT_H
+#define IR_CODE_LIBRARY_FORMAT_H
+
+#include <Arduino.h>
+
+// Layout of the code library image in the "irlib" flash partition. It is
+// read in place through a memory map, so every record is a plain struct at
+// a 4-byte aligned offset, little-endian like the ESP32 itself.
+// tools/build_irlib.py writes the same layout; keep the two in step.
+//
+//   header
+//   profiles   sorted by name (byte order), each owning a run of commands
+//   commands   one run per profile, in the order the remote lists them
+//   code index command numbers sorted by (protocol, address, command)
+//   strings    NUL-terminated names; the image ends in a NUL
+
+static constexpr char kIrLibraryMagic[4] = {'I', 'R', 'L', 'B'};
+static constexpr uint16_t kIrLibraryVersion = 1;
+
+struct IrLibraryHeader
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t headerBytes;
+    uint32_t imageBytes;
+    uint32_t profileCount;
+    uint32_t commandCount;
+    uint32_t profilesOffset;
+    uint32_t commandsOffset;
+    uint32_t codeIndexOffset;
+    uint32_t stringsOffset;
+};
+
+struct IrLibraryProfileRecord
+{
+    uint32_t nameOffset; // into the strings
+    uint32_t firstCommand;
+    uint32_t commandCount;
+};
+
+struct IrLibraryCommandRecord
+{
+    uint32_t nameOffset; // into the strings
+    uint16_t address;
+    uint16_t command;
+    uint8_t protocol; // IrProtocolId
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(IrLibraryHeader) == 36, "irlib header layout");
+static_assert(sizeof(IrLibraryProfileRecord) == 12, "irlib profile layout");
+static_assert(sizeof(IrLibraryCommandRecord) == 12, "irlib command layout");
+
+#endif
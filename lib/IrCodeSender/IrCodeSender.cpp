@@ -1,110 +1,113 @@
 #include "IrCodeSender.h"
 
-IrCodeSender::IrCodeSender(M5GFX& screen, uint16_t irPin)
+IrCodeSender::IrCodeSender(lgfx::LovyanGFX& screen, IrTransmitter& transmitter)
 : screen_(screen)
-, irSender_(irPin)
-, codeIndex_(0)
+, transmitter_(transmitter)
+, cursor_()
+, codeFields_(screen, 28, 52)
+, statusField_(screen, 8, 100, 2, TFT_GREEN)
 {
 }
 
-void IrCodeSender::begin()
+void IrCodeSender::draw()
 {
-    irSender_.begin();
+    screen_.fillScreen(TFT_BLACK);
+    screen_.setTextSize(2);
+
+    // Title
+    screen_.setTextColor(TFT_YELLOW, TFT_BLACK);
+    screen_.setCursor(8, 4);
+    screen_.print("IR Send");
+
+    // Hints
+    screen_.setTextSize(1);
+    screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
+    screen_.setCursor(8, 120);
+    screen_.print("Sel=send S+Up=entry S+Dn=prot Hold=back");
+
+    codeFields_.invalidate();
+    statusField_.invalidate();
+    drawFields();
 }
 
-void IrCodeSender::draw()
+bool IrCodeSender::next(uint32_t steps)
 {
-    screen_.fillScreen(TFT_BLACK);
-    drawCode();
+    return moved(cursor_.move(static_cast<int32_t>(steps)));
 }
 
-bool IrCodeSender::next()
+bool IrCodeSender::prev(uint32_t steps)
 {
-    if (codeIndex_ >= kTotalCodes - 1)
-    {
-        codeIndex_ = 0;
-    }
-    else
-    {
-        codeIndex_++;
-    }
-    drawCode();
-    return true;
+    return moved(cursor_.move(-static_cast<int32_t>(steps)));
 }
 
-bool IrCodeSender::prev()
+void IrCodeSender::cycleEntry()
 {
-    if (codeIndex_ == 0)
-    {
-        codeIndex_ = kTotalCodes - 1;
-    }
-    else
+    uint32_t index = cursor_.index();
+    cursor_.cycleEntry();
+    moved(cursor_.index() != index);
+}
+
+bool IrCodeSender::nextDigit()
+{
+    if (!cursor_.select())
     {
-        codeIndex_--;
+        return false;
     }
-    drawCode();
+    drawFields();
     return true;
 }
 
-void IrCodeSender::send()
+void IrCodeSender::nextProtocol()
 {
-    uint8_t addr = address();
-    uint8_t cmd = command();
+    cursor_.setProtocol(irNextProtocol(cursor_.protocol()));
+    moved(true);
+}
 
-    uint32_t code = (static_cast<uint32_t>(addr) << 24) |
-                    (static_cast<uint32_t>(~addr & 0xFF) << 16) |
-                    (static_cast<uint32_t>(cmd) << 8) |
-                    static_cast<uint32_t>(~cmd & 0xFF);
+void IrCodeSender::send()
+{
+    if (!irSend(transmitter_, cursor_.code()))
+    {
+        return;
+    }
 
-    irSender_.sendNEC(code, 32);
+    cursor_.remember();
+    drawFields();
 
     // Flash a brief "SENT" indicator
-    screen_.fillRect(0, 100, screen_.width(), 20, TFT_BLACK);
-    screen_.setTextSize(2);
-    screen_.setTextColor(TFT_GREEN, TFT_BLACK);
-    screen_.setCursor(8, 100);
-    screen_.print("SENT!");
+    statusField_.draw("SENT!");
+}
+
+IrProtocolId IrCodeSender::protocol() const
+{
+    return cursor_.protocol();
 }
 
-uint8_t IrCodeSender::address() const
+uint16_t IrCodeSender::address() const
 {
-    return static_cast<uint8_t>(codeIndex_ >> 8);
+    return cursor_.address();
 }
 
 uint8_t IrCodeSender::command() const
 {
-    return static_cast<uint8_t>(codeIndex_ & 0xFF);
+    return cursor_.command();
 }
 
 uint32_t IrCodeSender::codeIndex() const
 {
-    return codeIndex_;
+    return cursor_.index();
 }
 
-void IrCodeSender::drawCode()
+bool IrCodeSender::moved(bool changed)
 {
-    screen_.fillScreen(TFT_BLACK);
-    screen_.setTextSize(2);
-
-    // Title
-    screen_.setTextColor(TFT_YELLOW, TFT_BLACK);
-    screen_.setCursor(8, 4);
-    screen_.print("IR Send");
-
-    // Code index
-    screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    screen_.setCursor(8, 28);
-    screen_.printf("#%lu", codeIndex_);
-
-    // Address + command
-    screen_.setTextColor(TFT_WHITE, TFT_BLACK);
-    screen_.setTextSize(3);
-    screen_.setCursor(8, 52);
-    screen_.printf("%02X:%02X", address(), command());
+    if (changed)
+    {
+        statusField_.clear();
+    }
+    drawFields();
+    return changed;
+}
 
-    // Hints
-    screen_.setTextSize(1);
-    screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    screen_.setCursor(8, 120);
-    screen_.print("Sel=send  Hold=back");
+void IrCodeSender::drawFields()
+{
+    codeFields_.draw(cursor_);
 }
@@ -3,38 +3,55 @@
 
 #include <Arduino.h>
 #include <M5GFX.h>
-#include <IRsend.h>
+#include <IrCodeCursor.h>
+#include <IrCodeFields.h>
+#include <IrProtocols.h>
+#include <IrTransmitter.h>
+#include <TextField.h>
 
 class IrCodeSender
 {
   public:
-    IrCodeSender(M5GFX& screen, uint16_t irPin);
+    IrCodeSender(lgfx::LovyanGFX& screen, IrTransmitter& transmitter);
 
-    void begin();
     void draw();
 
-    // Navigate through the linear code space (address * 256 + command).
-    // Returns true if the code index changed.
-    bool next();
-    bool prev();
+    // Move through the protocol's code space the way the cursor's entry
+    // mode says. Returns true if the code changed.
+    bool next(uint32_t steps = 1);
+    bool prev(uint32_t steps = 1);
 
-    // Send the currently selected NEC code.
+    // Step -> Digits -> Recent, see IrCodeCursor.
+    void cycleEntry();
+    // While entering digits, moves on to the next one and returns true;
+    // otherwise returns false.
+    bool nextDigit();
+
+    // On to the next protocol, keeping as much of the code as fits.
+    void nextProtocol();
+
+    // Queue the currently selected code in its protocol.
     void send();
 
     // Getters
-    uint8_t address() const;
+    IrProtocolId protocol() const;
+    uint16_t address() const;
     uint8_t command() const;
     uint32_t codeIndex() const;
 
   private:
-    void drawCode();
+    bool moved(bool changed);
+    // Only the fields that changed are repainted; draw() lays out the
+    // title and hints once.
+    void drawFields();
 
-    M5GFX& screen_;
-    IRsend irSender_;
+    lgfx::LovyanGFX& screen_;
+    IrTransmitter& transmitter_;
 
-    uint32_t codeIndex_; // 0 .. 65535
+    IrCodeCursor cursor_;
 
-    static constexpr uint32_t kTotalCodes = 256UL * 256UL;
+    IrCodeFields codeFields_;
+    TextField statusField_;
 };
 
 #endif
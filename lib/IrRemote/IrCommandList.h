@@ -0,0 +1,87 @@
+#ifndef IR_COMMAND_LIST_H
+#define IR_COMMAND_LIST_H
+
+#include <Arduino.h>
+#include <IrProtocols.h>
+
+struct IrCommand
+{
+    const char* name;
+    IrTaggedCode code;
+};
+
+// The commands a remote pages through. It asks only for the rows it is
+// drawing or sending, so the list can be a const array or a view into
+// flash that never comes into RAM.
+class IrCommandList
+{
+  public:
+    virtual size_t size() const = 0;
+    virtual IrCommand at(size_t index) const = 0;
+
+  protected:
+    ~IrCommandList() = default;
+};
+
+class IrCommandArray : public IrCommandList
+{
+  public:
+    constexpr IrCommandArray(const IrCommand* commands, size_t count)
+    : commands_(commands)
+    , count_(count)
+    {
+    }
+
+    size_t size() const override
+    {
+        return count_;
+    }
+
+    IrCommand at(size_t index) const override
+    {
+        return commands_[index];
+    }
+
+  private:
+    const IrCommand* commands_;
+    size_t count_;
+};
+
+// A command in a generated table (tools/build_irlib.py --header). The
+// name is an offset into one pool the whole table shares, so each name is
+// stored once and a command takes six bytes instead of an IrCommand's
+// eight.
+struct IrPackedCommand
+{
+    uint16_t nameOffset;
+    IrTaggedCode code;
+};
+
+class IrPackedCommandArray : public IrCommandList
+{
+  public:
+    constexpr IrPackedCommandArray(const char* names, const IrPackedCommand* commands, size_t count)
+    : names_(names)
+    , commands_(commands)
+    , count_(count)
+    {
+    }
+
+    size_t size() const override
+    {
+        return count_;
+    }
+
+    IrCommand at(size_t index) const override
+    {
+        const IrPackedCommand& command = commands_[index];
+        return IrCommand{names_ + command.nameOffset, command.code};
+    }
+
+  private:
+    const char* names_;
+    const IrPackedCommand* commands_;
+    size_t count_;
+};
+
+#endif
@@ -1,19 +1,29 @@
 #include "IrRemote.h"
 
-IrRemote::IrRemote(M5GFX& screen, uint16_t irPin,
-                   const IrCommand* commands, size_t count)
+IrRemote::IrRemote(lgfx::LovyanGFX& screen, IrTransmitter& transmitter, const IrCommandList& commands)
 : screen_(screen)
-, irSender_(irPin)
+, transmitter_(transmitter)
 , commands_(commands)
-, count_(count)
+, title_(nullptr)
 , selectedIndex_(0)
 , topIndex_(0)
+, drawn_(false)
+, drawnSelected_(0)
+, drawnTop_(0)
 {
 }
 
-void IrRemote::begin()
+void IrRemote::setTitle(const char* title)
 {
-    irSender_.begin();
+    title_ = title;
+    drawn_ = false;
+}
+
+void IrRemote::reset()
+{
+    selectedIndex_ = 0;
+    topIndex_ = 0;
+    drawn_ = false;
 }
 
 void IrRemote::draw()
@@ -21,9 +31,37 @@ void IrRemote::draw()
     drawList();
 }
 
+void IrRemote::update()
+{
+    if (!drawn_)
+    {
+        drawList();
+        return;
+    }
+
+    if (topIndex_ != drawnTop_)
+    {
+        // Scrolled: every row changes, but painting them in place still
+        // beats clearing the screen first, and does not flicker.
+        int rows = visibleRows();
+        for (int row = 0; row < rows; ++row)
+        {
+            drawRow(topIndex_ + row);
+        }
+    }
+    else if (drawnSelected_ != selectedIndex_)
+    {
+        drawRow(drawnSelected_);
+        drawRow(selectedIndex_);
+    }
+
+    drawnSelected_ = selectedIndex_;
+    drawnTop_ = topIndex_;
+}
+
 bool IrRemote::moveUp(bool wrap)
 {
-    if (count_ == 0)
+    if (commands_.size() == 0)
     {
         return false;
     }
@@ -34,7 +72,7 @@ bool IrRemote::moveUp(bool wrap)
         {
             return false;
         }
-        selectedIndex_ = static_cast<int>(count_) - 1;
+        selectedIndex_ = static_cast<int>(commands_.size()) - 1;
     }
     else
     {
@@ -47,12 +85,12 @@ bool IrRemote::moveUp(bool wrap)
 
 bool IrRemote::moveDown(bool wrap)
 {
-    if (count_ == 0)
+    if (commands_.size() == 0)
     {
         return false;
     }
 
-    if (selectedIndex_ >= static_cast<int>(count_) - 1)
+    if (selectedIndex_ >= static_cast<int>(commands_.size()) - 1)
     {
         if (!wrap)
         {
@@ -71,23 +109,21 @@ bool IrRemote::moveDown(bool wrap)
 
 void IrRemote::sendSelected()
 {
-    if (count_ == 0)
+    if (commands_.size() == 0)
     {
         return;
     }
 
-    const IrCommand& cmd = commands_[selectedIndex_];
+    IrCommand cmd = commands_.at(selectedIndex_);
 
-    uint32_t code = (static_cast<uint32_t>(cmd.address) << 24) |
-                    (static_cast<uint32_t>(~cmd.address & 0xFF) << 16) |
-                    (static_cast<uint32_t>(cmd.command) << 8) |
-                    static_cast<uint32_t>(~cmd.command & 0xFF);
-
-    irSender_.sendNEC(code, 32);
+    if (!irSend(transmitter_, cmd.code))
+    {
+        return;
+    }
 
     // Flash "SENT" next to selected item
     int row = selectedIndex_ - topIndex_;
-    int y = kListTop + row * kLineHeight;
+    int y = rowY(row);
     int sentX = screen_.width() - 52;
     screen_.setTextSize(2);
     screen_.setTextColor(TFT_GREEN, TFT_BLACK);
@@ -100,14 +136,24 @@ int IrRemote::selectedIndex() const
     return selectedIndex_;
 }
 
-const IrCommand& IrRemote::selectedCommand() const
+IrCommand IrRemote::selectedCommand() const
+{
+    return commands_.at(selectedIndex_);
+}
+
+int IrRemote::listTop() const
 {
-    return commands_[selectedIndex_];
+    return (title_ != nullptr) ? kListTop + kLineHeight : kListTop;
 }
 
 int IrRemote::visibleRows() const
 {
-    return (screen_.height() - kListTop - kScrollPadding) / kLineHeight;
+    return (screen_.height() - listTop() - kScrollPadding) / kLineHeight;
+}
+
+int IrRemote::rowY(int row) const
+{
+    return listTop() + row * kLineHeight;
 }
 
 void IrRemote::ensureSelectionVisible()
@@ -139,18 +185,26 @@ void IrRemote::drawList()
     screen_.fillScreen(TFT_BLACK);
     screen_.setTextSize(kTextSize);
 
+    if (title_ != nullptr)
+    {
+        screen_.setTextColor(TFT_YELLOW, TFT_BLACK);
+        screen_.setCursor(kListLeft, kListTop);
+        screen_.print(title_);
+    }
+
     int rows = visibleRows();
+    int shown = 0;
     for (int row = 0; row < rows; ++row)
     {
         int itemIndex = topIndex_ + row;
-        if (itemIndex >= static_cast<int>(count_))
+        if (itemIndex >= static_cast<int>(commands_.size()))
         {
             break;
         }
 
-        int y = kListTop + row * kLineHeight;
+        IrCommand cmd = commands_.at(itemIndex);
+        int y = rowY(row);
         bool isSelected = (itemIndex == selectedIndex_);
-        const IrCommand& cmd = commands_[itemIndex];
 
         if (isSelected)
         {
@@ -164,15 +218,60 @@ void IrRemote::drawList()
 
         screen_.setCursor(kListLeft, y);
         screen_.print(cmd.name);
+        shown++;
+    }
 
-        // Show hex code on the right
-        uint16_t bg = isSelected ? TFT_DARKGREY : TFT_BLACK;
-        uint16_t fg = isSelected ? TFT_BLACK : TFT_DARKGREY;
-        screen_.setTextColor(fg, bg);
-        screen_.setTextSize(1);
-        int hexX = screen_.width() - 28;
-        screen_.setCursor(hexX, y + 4);
-        screen_.printf("x%02X", cmd.command);
-        screen_.setTextSize(kTextSize);
+    // Hex codes on the right, in a second pass so the text size changes
+    // once rather than twice per row.
+    screen_.setTextSize(1);
+    for (int row = 0; row < shown; ++row)
+    {
+        int itemIndex = topIndex_ + row;
+        drawCode(row, commands_.at(itemIndex), itemIndex == selectedIndex_);
     }
+
+    drawn_ = true;
+    drawnSelected_ = selectedIndex_;
+    drawnTop_ = topIndex_;
 }
+
+// Paints one command's row, highlight included, over whatever is there.
+// Off-screen commands are skipped.
+void IrRemote::drawRow(int itemIndex)
+{
+    int row = itemIndex - topIndex_;
+    if (row < 0 || row >= visibleRows())
+    {
+        return;
+    }
+
+    int y = rowY(row);
+    if (itemIndex >= static_cast<int>(commands_.size()))
+    {
+        screen_.fillRect(0, y - 1, screen_.width(), kLineHeight, TFT_BLACK);
+        return;
+    }
+
+    IrCommand cmd = commands_.at(itemIndex);
+    bool isSelected = (itemIndex == selectedIndex_);
+    uint16_t bg = isSelected ? TFT_DARKGREY : TFT_BLACK;
+    screen_.fillRect(0, y - 1, screen_.width(), kLineHeight, bg);
+    screen_.setTextSize(kTextSize);
+    screen_.setTextColor(isSelected ? TFT_BLACK : TFT_WHITE, bg);
+    screen_.setCursor(kListLeft, y);
+    screen_.print(cmd.name);
+
+    screen_.setTextSize(1);
+    drawCode(row, cmd, isSelected);
+}
+
+// The hex code label; expects text size 1.
+void IrRemote::drawCode(int row, const IrCommand& cmd, bool isSelected)
+{
+    uint16_t bg = isSelected ? TFT_DARKGREY : TFT_BLACK;
+    uint16_t fg = isSelected ? TFT_BLACK : TFT_DARKGREY;
+    screen_.setTextColor(fg, bg);
+    screen_.setCursor(screen_.width() - 28, rowY(row) + 4);
+    screen_.printf("x%02X", cmd.code.command);
+}
+
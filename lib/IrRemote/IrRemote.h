@@ -3,44 +3,58 @@
 
 #include <Arduino.h>
 #include <M5GFX.h>
-#include <IRsend.h>
-
-struct IrCommand
-{
-    const char* name;
-    uint8_t address;
-    uint8_t command;
-};
+#include <IrTransmitter.h>
+#include "IrCommandList.h"
 
 class IrRemote
 {
   public:
-    IrRemote(M5GFX& screen, uint16_t irPin,
-             const IrCommand* commands, size_t count);
+    // `commands` is read on every draw, not copied.
+    IrRemote(lgfx::LovyanGFX& screen, IrTransmitter& transmitter, const IrCommandList& commands);
 
-    void begin();
+    // A line above the list, e.g. the profile name. nullptr (the default)
+    // gives the list the whole screen. Takes effect on the next draw().
+    void setTitle(const char* title);
+
+    // The list's contents changed: back to its first command. Call draw()
+    // afterwards.
+    void reset();
+
+    // draw() paints the whole list; update() repaints only the rows that
+    // changed since: the old and new selected rows, or every row (painted
+    // in place, without clearing the screen) when the list has scrolled.
     void draw();
+    void update();
 
     bool moveUp(bool wrap);
     bool moveDown(bool wrap);
     void sendSelected();
 
     int selectedIndex() const;
-    const IrCommand& selectedCommand() const;
+    IrCommand selectedCommand() const;
 
   private:
     void ensureSelectionVisible();
     int visibleRows() const;
+    int rowY(int row) const;
     void drawList();
+    int listTop() const;
+    void drawRow(int itemIndex);
+    void drawCode(int row, const IrCommand& cmd, bool isSelected);
 
-    M5GFX& screen_;
-    IRsend irSender_;
-    const IrCommand* commands_;
-    size_t count_;
+    lgfx::LovyanGFX& screen_;
+    IrTransmitter& transmitter_;
+    const IrCommandList& commands_;
+    const char* title_;
 
     int selectedIndex_;
     int topIndex_;
 
+    // What is on screen, for update().
+    bool drawn_;
+    int drawnSelected_;
+    int drawnTop_;
+
     static constexpr int kListTop = 8;
     static constexpr int kListLeft = 8;
     static constexpr int kLineHeight = 20;
@@ -1,60 +1,126 @@
 #include "IrRepeatSender.h"
+#include <FieldFormat.h>
 
-IrRepeatSender::IrRepeatSender(M5GFX& screen, uint16_t irPin)
+IrRepeatSender::IrRepeatSender(lgfx::LovyanGFX& screen, IrTransmitter& transmitter)
 : screen_(screen)
-, irSender_(irPin)
-, codeIndex_(0)
-, repeatIntervalMs_(110)
-, lastSendMs_(0)
+, transmitter_(transmitter)
+, cursor_()
+, repeatIntervalMs_(0)
+, holdMode_(HoldMode::RepeatCodes)
 , sending_(false)
-, sendCount_(0)
+, shownFrames_(0)
+, refresh_()
+, modeField_(screen, 140, 8, 1, TFT_CYAN)
+, codeFields_(screen, 28, 48)
+, statusField_(screen, 8, 84, 2, TFT_DARKGREY)
+, rateField_(screen, 8, 104, 1, TFT_DARKGREY)
 {
 }
 
-void IrRepeatSender::begin()
+void IrRepeatSender::setRepeatIntervalMs(uint32_t intervalMs)
 {
-    irSender_.begin();
+    repeatIntervalMs_ = intervalMs;
 }
 
-void IrRepeatSender::setRepeatIntervalMs(uint32_t intervalMs)
+void IrRepeatSender::setHoldMode(HoldMode mode)
 {
-    repeatIntervalMs_ = intervalMs;
+    if (mode == holdMode_)
+    {
+        return;
+    }
+    holdMode_ = mode;
+    restartHold();
+    drawFields();
 }
 
-void IrRepeatSender::draw()
+IrRepeatSender::HoldMode IrRepeatSender::holdMode() const
 {
-    drawScreen();
+    return holdMode_;
 }
 
-bool IrRepeatSender::next()
+void IrRepeatSender::setProtocol(IrProtocolId protocol)
 {
-    if (codeIndex_ >= kTotalCodes - 1)
-    {
-        codeIndex_ = 0;
-    }
-    else
+    if (protocol == cursor_.protocol())
     {
-        codeIndex_++;
+        return;
     }
-    sendCount_ = 0;
-    lastSendMs_ = 0; // send immediately on next tick
-    drawScreen();
-    return true;
+    cursor_.setProtocol(protocol);
+    restartHold();
+    drawFields();
 }
 
-bool IrRepeatSender::prev()
+IrProtocolId IrRepeatSender::protocol() const
 {
-    if (codeIndex_ == 0)
+    return cursor_.protocol();
+}
+
+void IrRepeatSender::nextMode()
+{
+    bool hasRepeatCode = irProtocolInfo(cursor_.protocol()).repeat == IrRepeatPolicy::RepeatCode;
+    if (hasRepeatCode && holdMode_ == HoldMode::RepeatCodes)
     {
-        codeIndex_ = kTotalCodes - 1;
+        setHoldMode(HoldMode::FullFrames);
+        return;
     }
-    else
+
+    holdMode_ = HoldMode::RepeatCodes;
+    cursor_.setProtocol(irNextProtocol(cursor_.protocol()));
+    restartHold();
+    drawFields();
+}
+
+void IrRepeatSender::setRefreshHz(uint32_t hz)
+{
+    refresh_.setRateHz(hz);
+}
+
+void IrRepeatSender::draw()
+{
+    screen_.fillScreen(TFT_BLACK);
+    screen_.setTextSize(2);
+
+    // Title
+    screen_.setTextColor(TFT_YELLOW, TFT_BLACK);
+    screen_.setCursor(8, 4);
+    screen_.print("IR Repeat");
+
+    // Hints
+    screen_.setTextSize(1);
+    screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
+    screen_.setCursor(8, 120);
+    screen_.print("Sel=run S+Up=entry S+Dn=mode Hold=back");
+
+    modeField_.invalidate();
+    codeFields_.invalidate();
+    statusField_.invalidate();
+    rateField_.invalidate();
+    drawFields();
+}
+
+bool IrRepeatSender::next(uint32_t steps)
+{
+    return moved(cursor_.move(static_cast<int32_t>(steps)));
+}
+
+bool IrRepeatSender::prev(uint32_t steps)
+{
+    return moved(cursor_.move(-static_cast<int32_t>(steps)));
+}
+
+void IrRepeatSender::cycleEntry()
+{
+    uint32_t index = cursor_.index();
+    cursor_.cycleEntry();
+    moved(cursor_.index() != index);
+}
+
+bool IrRepeatSender::nextDigit()
+{
+    if (!cursor_.select())
     {
-        codeIndex_--;
+        return false;
     }
-    sendCount_ = 0;
-    lastSendMs_ = 0;
-    drawScreen();
+    drawFields();
     return true;
 }
 
@@ -65,12 +131,20 @@ void IrRepeatSender::tick()
         return;
     }
 
-    uint32_t now = millis();
-    if (now - lastSendMs_ >= repeatIntervalMs_)
+    // The transmitter refuses until the previous code's last frame and
+    // its gap are over, so a new code never crowds the old one.
+    if (!transmitter_.isHolding() && startHold())
+    {
+        refresh_.invalidate();
+    }
+
+    if (currentStats().frames != shownFrames_)
+    {
+        refresh_.invalidate();
+    }
+
+    if (refresh_.due(millis()))
     {
-        sendCode();
-        lastSendMs_ = now;
-        sendCount_++;
         drawStatus();
     }
 }
@@ -78,15 +152,15 @@ void IrRepeatSender::tick()
 void IrRepeatSender::startSending()
 {
     sending_ = true;
-    sendCount_ = 0;
-    lastSendMs_ = 0; // fire immediately on next tick
-    drawScreen();
+    shownFrames_ = 0;
+    drawFields();
 }
 
 void IrRepeatSender::stopSending()
 {
     sending_ = false;
-    drawScreen();
+    transmitter_.stopHold();
+    drawFields();
 }
 
 bool IrRepeatSender::isSending() const
@@ -94,80 +168,125 @@ bool IrRepeatSender::isSending() const
     return sending_;
 }
 
-uint8_t IrRepeatSender::address() const
+uint16_t IrRepeatSender::address() const
 {
-    return static_cast<uint8_t>(codeIndex_ >> 8);
+    return cursor_.address();
 }
 
 uint8_t IrRepeatSender::command() const
 {
-    return static_cast<uint8_t>(codeIndex_ & 0xFF);
+    return cursor_.command();
 }
 
 uint32_t IrRepeatSender::codeIndex() const
 {
-    return codeIndex_;
+    return cursor_.index();
 }
 
-void IrRepeatSender::sendCode()
+IrHoldStats IrRepeatSender::holdStats() const
 {
-    uint8_t addr = address();
-    uint8_t cmd = command();
+    return transmitter_.holdStats();
+}
 
-    uint32_t code = (static_cast<uint32_t>(addr) << 24) |
-                    (static_cast<uint32_t>(~addr & 0xFF) << 16) |
-                    (static_cast<uint32_t>(cmd) << 8) |
-                    static_cast<uint32_t>(~cmd & 0xFF);
+float IrRepeatSender::sendsPerSecond() const
+{
+    IrHoldStats stats = transmitter_.holdStats();
+    return (stats.periodUs != 0) ? 1000000.0f / stats.periodUs : 0.0f;
+}
 
-    irSender_.sendNEC(code, 32);
+float IrRepeatSender::refreshesPerSecond() const
+{
+    return refresh_.achievedHz();
 }
 
-void IrRepeatSender::drawScreen()
+IrHoldStats IrRepeatSender::currentStats() const
 {
-    screen_.fillScreen(TFT_BLACK);
-    screen_.setTextSize(2);
+    // Between a restart and the new hold the old numbers no longer apply.
+    return transmitter_.isHolding() ? transmitter_.holdStats() : IrHoldStats{};
+}
 
-    // Title
-    screen_.setTextColor(TFT_YELLOW, TFT_BLACK);
-    screen_.setCursor(8, 4);
-    screen_.print("IR Repeat");
+bool IrRepeatSender::startHold()
+{
+    IrTaggedCode code = cursor_.code();
+    IrFrame first;
+    IrFrame repeat;
+    irEncode(code, first);
+    if (holdMode_ == HoldMode::RepeatCodes)
+    {
+        irEncodeRepeat(code, repeat);
+    }
+    else
+    {
+        repeat = first;
+    }
+    if (!transmitter_.startHold(first, repeat, repeatIntervalMs_ * 1000))
+    {
+        return false;
+    }
+    cursor_.remember();
+    return true;
+}
 
-    // Code index
-    screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    screen_.setCursor(8, 28);
-    screen_.printf("#%lu", codeIndex_);
+void IrRepeatSender::restartHold()
+{
+    if (sending_)
+    {
+        transmitter_.stopHold();
+        shownFrames_ = 0;
+    }
+}
 
-    // Address + command (big)
-    screen_.setTextColor(TFT_WHITE, TFT_BLACK);
-    screen_.setTextSize(3);
-    screen_.setCursor(8, 48);
-    screen_.printf("%02X:%02X", address(), command());
+bool IrRepeatSender::moved(bool changed)
+{
+    if (changed)
+    {
+        restartHold();
+    }
+    drawFields();
+    return changed;
+}
 
-    drawStatus();
+void IrRepeatSender::drawFields()
+{
+    bool repeatCodes = holdMode_ == HoldMode::RepeatCodes &&
+                       irProtocolInfo(cursor_.protocol()).repeat == IrRepeatPolicy::RepeatCode;
+    modeField_.draw(repeatCodes ? "repeat codes" : "full frames");
 
-    // Hints
-    screen_.setTextSize(1);
-    screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
-    screen_.setCursor(8, 120);
-    screen_.print("Sel=start/stop Hold=back");
+    codeFields_.draw(cursor_);
+    drawStatus();
 }
 
 void IrRepeatSender::drawStatus()
 {
-    // Clear status area
-    screen_.fillRect(0, 80, screen_.width(), 30, TFT_BLACK);
-    screen_.setTextSize(2);
-
     if (sending_)
     {
-        screen_.setTextColor(TFT_GREEN, TFT_BLACK);
-        screen_.setCursor(8, 84);
-        screen_.printf("SENDING x%lu", sendCount_);
+        IrHoldStats stats = currentStats();
+        shownFrames_ = stats.frames;
+
+        statusField_.setColor(TFT_GREEN);
+        char text[TextField::kMaxChars + 1];
+        char* end = formatDecimal(formatText(text, "SENDING x"), stats.frames);
+        *end = '\0';
+        statusField_.draw(text);
+
+        // Mean period in tenths of a millisecond, peak-to-peak jitter in
+        // microseconds.
+        end = text;
+        if (stats.periodUs != 0)
+        {
+            end = formatText(formatTenths(end, (stats.periodUs + 50) / 100), "ms jit ");
+            end = formatText(formatDecimal(end, stats.jitterUs()), "us  ");
+        }
+        end = formatText(formatDecimal(end, static_cast<uint32_t>(refresh_.achievedHz() + 0.5f), 2), " fps");
+        *end = '\0';
+        rateField_.draw(text);
     }
     else
     {
-        screen_.setTextColor(TFT_DARKGREY, TFT_BLACK);
-        screen_.setCursor(8, 84);
-        screen_.print("Stopped");
+        statusField_.setColor(TFT_DARKGREY);
+        statusField_.draw("Stopped");
+        rateField_.clear();
     }
+
+    refresh_.presented(millis());
 }
@@ -3,25 +3,65 @@
 
 #include <Arduino.h>
 #include <M5GFX.h>
-#include <IRsend.h>
+#include <FramePacer.h>
+#include <IrCodeCursor.h>
+#include <IrCodeFields.h>
+#include <IrProtocols.h>
+#include <IrTransmitter.h>
+#include <TextField.h>
 
+// Sends one code the way a held remote button does, timed by the
+// transmitter's hold timer rather than by loop(). What follows the first
+// frame is the protocol's repeat policy (see IrProtocolInfo), so only NEC
+// codes have a choice of hold mode.
 class IrRepeatSender
 {
   public:
-    IrRepeatSender(M5GFX& screen, uint16_t irPin);
+    // What follows the first full frame while sending.
+    enum class HoldMode : uint8_t
+    {
+        RepeatCodes, // as the protocol repeats: NEC's repeat code, others' frame
+        FullFrames,  // the whole frame again, for receivers that ignore repeats
+    };
 
-    void begin();
+    IrRepeatSender(lgfx::LovyanGFX& screen, IrTransmitter& transmitter);
 
-    // Set how often the code is re-sent while active (default 110ms).
+    // Start-to-start time while active. Never shorter than the protocol
+    // allows; 0 (the default) sends at exactly that period.
     void setRepeatIntervalMs(uint32_t intervalMs);
 
+    // Takes effect at once, restarting with a full frame if sending.
+    void setHoldMode(HoldMode mode);
+    HoldMode holdMode() const;
+
+    // Keeps as much of the code as the protocol's fields hold, and
+    // restarts like setHoldMode().
+    void setProtocol(IrProtocolId protocol);
+    IrProtocolId protocol() const;
+
+    // The one button for both: through the hold modes where the protocol
+    // has a choice, then on to the next protocol.
+    void nextMode();
+
+    // How often the send count may redraw while sending; sends are not
+    // held back by it. 0 stops redrawing it.
+    void setRefreshHz(uint32_t hz);
+
     void draw();
 
-    // Navigate the code space. Wraps around.
-    bool next();
-    bool prev();
+    // Navigate the code space as the cursor's entry mode says. Wraps
+    // around.
+    bool next(uint32_t steps = 1);
+    bool prev(uint32_t steps = 1);
 
-    // Call every loop(). Sends the code if enough time has elapsed.
+    // Step -> Digits -> Recent, see IrCodeCursor.
+    void cycleEntry();
+    // While entering digits, moves on to the next one and returns true;
+    // otherwise returns false.
+    bool nextDigit();
+
+    // Call every loop(). Starts the hold once the transmitter is free and
+    // redraws what it measured.
     void tick();
 
     // Start/stop auto-sending.
@@ -29,25 +69,43 @@ class IrRepeatSender
     void stopSending();
     bool isSending() const;
 
-    uint8_t address() const;
+    uint16_t address() const;
     uint8_t command() const;
     uint32_t codeIndex() const;
 
+    // Frames sent, period and jitter as the hold timer measured them.
+    IrHoldStats holdStats() const;
+    // From the measured mean period, and status redraws per second
+    // actually drawn.
+    float sendsPerSecond() const;
+    float refreshesPerSecond() const;
+
   private:
-    void sendCode();
-    void drawScreen();
+    bool startHold();
+    // A new code or mode: the running hold stops and tick() starts over.
+    void restartHold();
+    bool moved(bool changed);
+    IrHoldStats currentStats() const;
+    // Repaints only the fields whose text changed; draw() lays out the
+    // title and hints once.
+    void drawFields();
     void drawStatus();
 
-    M5GFX& screen_;
-    IRsend irSender_;
+    lgfx::LovyanGFX& screen_;
+    IrTransmitter& transmitter_;
 
-    uint32_t codeIndex_; // 0 .. 65535
+    IrCodeCursor cursor_;
     uint32_t repeatIntervalMs_;
-    uint32_t lastSendMs_;
+    HoldMode holdMode_;
     bool sending_;
-    uint32_t sendCount_;
+    uint32_t shownFrames_;
+
+    FramePacer refresh_;
 
-    static constexpr uint32_t kTotalCodes = 256UL * 256UL;
+    TextField modeField_;
+    IrCodeFields codeFields_;
+    TextField statusField_;
+    TextField rateField_;
 };
 
 #endif
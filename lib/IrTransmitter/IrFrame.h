@@ -0,0 +1,105 @@
+#ifndef IR_FRAME_H
+#define IR_FRAME_H
+
+#include <Arduino.h>
+#include "IrRmtDriver.h"
+
+static constexpr size_t kIrMaxFrameItems = 48;
+
+// How a frame is spaced from its predecessor.
+enum class IrPacing
+{
+    Standard,   // the protocol's nominal start-to-start period
+    MinimumGap, // only the minimum gap after the previous frame ends
+};
+
+// A fully encoded frame plus the pacing it needs around it.
+struct IrFrame
+{
+    IrItem items[kIrMaxFrameItems];
+    uint8_t count;
+    uint8_t repeats;     // extra identical copies sent after the first
+    uint32_t carrierHz;
+    uint32_t durationUs; // sum of all marks and spaces
+    uint32_t gapUs;      // minimum silence after the frame ends
+    uint32_t periodUs;   // minimum start-to-start spacing (0 = none)
+};
+
+// Appends marks and spaces to a frame, merging runs of the same level so
+// bi-phase protocols come out as the fewest RMT items. A leading space is
+// dropped (the line idles low anyway) and finish() ends the frame on a
+// zero-length space, which is what stops the RMT transfer. A waveform
+// that needs more than kIrMaxFrameItems items is not cut short: finish()
+// leaves the frame empty, and the transmitter drops empty frames.
+class IrFrameBuilder
+{
+  public:
+    explicit IrFrameBuilder(IrFrame& frame)
+    : frame_(frame)
+    , markUs_(0)
+    , spaceUs_(0)
+    , overflowed_(false)
+    {
+        frame_.count = 0;
+        frame_.durationUs = 0;
+    }
+
+    void mark(uint16_t us)
+    {
+        if (spaceUs_ > 0)
+        {
+            flush();
+        }
+        markUs_ += us;
+    }
+
+    void space(uint16_t us)
+    {
+        if (markUs_ > 0)
+        {
+            spaceUs_ += us;
+        }
+    }
+
+    // Returns false, with the frame emptied, if it did not fit.
+    bool finish()
+    {
+        // The trailing space is the inter-frame gap, not part of the frame.
+        spaceUs_ = 0;
+        if (markUs_ > 0)
+        {
+            flush();
+        }
+
+        if (overflowed_)
+        {
+            frame_.count = 0;
+            frame_.durationUs = 0;
+            return false;
+        }
+        return true;
+    }
+
+  private:
+    void flush()
+    {
+        if (frame_.count < kIrMaxFrameItems)
+        {
+            frame_.items[frame_.count++] = irItem(markUs_, spaceUs_);
+            frame_.durationUs += markUs_ + spaceUs_;
+        }
+        else
+        {
+            overflowed_ = true;
+        }
+        markUs_ = 0;
+        spaceUs_ = 0;
+    }
+
+    IrFrame& frame_;
+    uint16_t markUs_;
+    uint16_t spaceUs_;
+    bool overflowed_;
+};
+
+#endif
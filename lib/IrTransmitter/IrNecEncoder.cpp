@@ -0,0 +1,96 @@
+#include "IrNecEncoder.h"
+
+namespace
+{
+
+struct NecByteTable
+{
+    IrItem items[256][8];
+    uint16_t durationUs[256];
+};
+
+constexpr NecByteTable makeNecByteTable()
+{
+    NecByteTable table{};
+    for (int value = 0; value < 256; ++value)
+    {
+        uint16_t duration = 0;
+        for (int bit = 0; bit < 8; ++bit)
+        {
+            bool one = (value & (0x80 >> bit)) != 0;
+            uint16_t space = one ? kNecOneSpaceUs : kNecZeroSpaceUs;
+            table.items[value][bit] = irItem(kNecBitMarkUs, space);
+            duration += kNecBitMarkUs + space;
+        }
+        table.durationUs[value] = duration;
+    }
+    return table;
+}
+
+constexpr NecByteTable kNecBytes = makeNecByteTable();
+
+static_assert(irItemSpaceUs(kNecBytes.items[0x80][0]) == kNecOneSpaceUs, "MSB goes first");
+static_assert(irItemSpaceUs(kNecBytes.items[0x80][1]) == kNecZeroSpaceUs, "MSB goes first");
+static_assert(kNecBytes.durationUs[0x00] + kNecBytes.durationUs[0xFF] == 8 * 2 * kNecBitMarkUs + 8 * (kNecOneSpaceUs + kNecZeroSpaceUs),
+              "byte and its complement always take the same time");
+
+constexpr IrItem kHeader = irItem(kNecHdrMarkUs, kNecHdrSpaceUs);
+constexpr IrItem kStop = irItem(kNecBitMarkUs, 0); // zero space ends the RMT transfer
+
+inline IrItem* putByte(IrItem* out, uint8_t value)
+{
+    memcpy(out, kNecBytes.items[value], sizeof(kNecBytes.items[value]));
+    return out + 8;
+}
+
+} // namespace
+
+void IrNecEncoder::encode(uint8_t address, uint8_t command, IrFrame& frame,
+                          IrPacing pacing)
+{
+    encodeBytes(address, static_cast<uint8_t>(~address), command, frame, pacing);
+}
+
+void IrNecEncoder::encodeExtended(uint16_t address, uint8_t command, IrFrame& frame,
+                                  IrPacing pacing)
+{
+    encodeBytes(static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address),
+                command, frame, pacing);
+}
+
+void IrNecEncoder::encodeRepeat(IrFrame& frame)
+{
+    frame.items[0] = irItem(kNecHdrMarkUs, kNecRptSpaceUs);
+    frame.items[1] = kStop;
+
+    frame.count = static_cast<uint8_t>(kNecRepeatItems);
+    frame.repeats = 0;
+    frame.carrierHz = kNecCarrierHz;
+    frame.durationUs = kNecHdrMarkUs + kNecRptSpaceUs + kNecBitMarkUs;
+    frame.gapUs = kNecMinGapUs;
+    frame.periodUs = kNecPeriodUs;
+}
+
+void IrNecEncoder::encodeBytes(uint8_t first, uint8_t second, uint8_t command,
+                               IrFrame& frame, IrPacing pacing)
+{
+    uint8_t notCommand = static_cast<uint8_t>(~command);
+
+    IrItem* out = frame.items;
+    *out++ = kHeader;
+    out = putByte(out, first);
+    out = putByte(out, second);
+    out = putByte(out, command);
+    out = putByte(out, notCommand);
+    *out++ = kStop;
+
+    frame.count = static_cast<uint8_t>(kNecFrameItems);
+    frame.repeats = 0;
+    frame.carrierHz = kNecCarrierHz;
+    frame.durationUs = kNecHdrMarkUs + kNecHdrSpaceUs +
+                       kNecBytes.durationUs[first] + kNecBytes.durationUs[second] +
+                       kNecBytes.durationUs[command] + kNecBytes.durationUs[notCommand] +
+                       kNecBitMarkUs;
+    frame.gapUs = kNecMinGapUs;
+    frame.periodUs = (pacing == IrPacing::Standard) ? kNecPeriodUs : 0;
+}
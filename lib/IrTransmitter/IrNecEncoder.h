@@ -0,0 +1,54 @@
+#ifndef IR_NEC_ENCODER_H
+#define IR_NEC_ENCODER_H
+
+#include <Arduino.h>
+#include "IrFrame.h"
+
+// NEC timings, matching IRremoteESP8266 (560 us tick).
+static constexpr uint16_t kNecHdrMarkUs = 8960;
+static constexpr uint16_t kNecHdrSpaceUs = 4480;
+static constexpr uint16_t kNecBitMarkUs = 560;
+static constexpr uint16_t kNecOneSpaceUs = 1680;
+static constexpr uint16_t kNecZeroSpaceUs = 560;
+static constexpr uint16_t kNecRptSpaceUs = 2240;
+static constexpr uint32_t kNecMinGapUs = 22400;
+static constexpr uint32_t kNecPeriodUs = 108080;
+
+// Header + 32 data bits + stop bit.
+static constexpr size_t kNecFrameItems = 34;
+// Header mark, short space, stop bit.
+static constexpr size_t kNecRepeatItems = 2;
+
+static constexpr uint32_t kNecCarrierHz = 38000;
+
+struct IrNecCode
+{
+    uint8_t address;
+    uint8_t command;
+};
+
+// Builds RMT-ready NEC frames from a flash-resident table holding the eight
+// pre-encoded items for every byte value, so encoding a frame is four
+// 32-byte copies. Bytes go out MSB first, i.e. the wire carries
+// address | ~address | command | ~command exactly as written.
+class IrNecEncoder
+{
+  public:
+    static void encode(uint8_t address, uint8_t command, IrFrame& frame,
+                       IrPacing pacing = IrPacing::Standard);
+
+    // Extended NEC: a 16-bit address (high byte first, as in 0xAAAAcc..)
+    // replaces address | ~address.
+    static void encodeExtended(uint16_t address, uint8_t command, IrFrame& frame,
+                               IrPacing pacing = IrPacing::Standard);
+
+    // The repeat code a held remote sends every period after the full
+    // frame. It carries no data, so one frame serves every code.
+    static void encodeRepeat(IrFrame& frame);
+
+  private:
+    static void encodeBytes(uint8_t first, uint8_t second, uint8_t command,
+                            IrFrame& frame, IrPacing pacing);
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "IrProtocols.h"
+#include "IrNecEncoder.h"
+
+namespace
+{
+
+template <typename Protocol>
+constexpr IrProtocolInfo infoOf()
+{
+    static_assert(Protocol::kCommandBits <= 8 && Protocol::kAddressBits <= 16,
+                  "codes must fit IrTaggedCode");
+    // A header, at most one item per bit (bi-phase runs merge) and a stop
+    // mark.
+    static_assert(Protocol::kFrameBits + 2 <= kIrMaxFrameItems, "frames must fit IrFrame");
+    return IrProtocolInfo{Protocol::kId, Protocol::kName,
+                          Protocol::kAddressBits, Protocol::kCommandBits,
+                          &irEncodeBatch<Protocol>, &Protocol::encode,
+                          Protocol::kCarrierHz, Protocol::kFrameBits, Protocol::kRepeat};
+}
+
+constexpr IrProtocolInfo kProtocols[] = {
+    infoOf<IrProtocolNec>(),
+    infoOf<IrProtocolNecExtended>(),
+    infoOf<IrProtocolSamsung32>(),
+    infoOf<IrProtocolSony12>(),
+    infoOf<IrProtocolRc5>(),
+    infoOf<IrProtocolRc6>(),
+};
+
+constexpr bool protocolsInIdOrder()
+{
+    for (size_t i = 0; i < sizeof(kProtocols) / sizeof(kProtocols[0]); ++i)
+    {
+        if (static_cast<size_t>(kProtocols[i].id) != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sizeof(kProtocols) / sizeof(kProtocols[0]) == static_cast<size_t>(IrProtocolId::Count),
+              "every IrProtocolId needs an entry");
+static_assert(protocolsInIdOrder(), "kProtocols must be indexed by IrProtocolId");
+
+void setPacing(IrFrame& frame, uint32_t carrierHz, uint32_t gapUs, uint32_t periodUs,
+               uint8_t repeats, IrPacing pacing)
+{
+    frame.repeats = repeats;
+    frame.carrierHz = carrierHz;
+    frame.gapUs = gapUs;
+    frame.periodUs = (pacing == IrPacing::Standard) ? periodUs : 0;
+}
+
+// Bi-phase bit: `firstHigh` says which half carries the mark.
+void biphase(IrFrameBuilder& out, bool firstHigh, uint16_t halfUs)
+{
+    if (firstHigh)
+    {
+        out.mark(halfUs);
+        out.space(halfUs);
+    }
+    else
+    {
+        out.space(halfUs);
+        out.mark(halfUs);
+    }
+}
+
+} // namespace
+
+const IrProtocolInfo& irProtocolInfo(IrProtocolId id)
+{
+    size_t index = static_cast<size_t>(id);
+    return kProtocols[index < static_cast<size_t>(IrProtocolId::Count) ? index : 0];
+}
+
+IrProtocolId irNextProtocol(IrProtocolId id)
+{
+    size_t next = (static_cast<size_t>(id) + 1) % static_cast<size_t>(IrProtocolId::Count);
+    return static_cast<IrProtocolId>(next);
+}
+
+void irEncode(const IrTaggedCode& code, IrFrame& frame, IrPacing pacing)
+{
+    irProtocolInfo(code.protocol).encode(code.code(), frame, pacing);
+}
+
+void irEncodeRepeat(const IrTaggedCode& code, IrFrame& frame)
+{
+    if (irProtocolInfo(code.protocol).repeat == IrRepeatPolicy::RepeatCode)
+    {
+        IrNecEncoder::encodeRepeat(frame);
+    }
+    else
+    {
+        irEncode(code, frame);
+    }
+}
+
+bool irSend(IrTransmitter& transmitter, const IrTaggedCode& code)
+{
+    IrFrame* frame = transmitter.reserve();
+    if (frame == nullptr)
+    {
+        return false;
+    }
+
+    irEncode(code, *frame);
+    transmitter.commit();
+    return true;
+}
+
+void IrProtocolNec::encode(const IrCode& code, IrFrame& frame, IrPacing pacing)
+{
+    IrNecEncoder::encode(static_cast<uint8_t>(code.address),
+                         static_cast<uint8_t>(code.command), frame, pacing);
+}
+
+void IrProtocolNecExtended::encode(const IrCode& code, IrFrame& frame, IrPacing pacing)
+{
+    IrNecEncoder::encodeExtended(code.address, static_cast<uint8_t>(code.command),
+                                 frame, pacing);
+}
+
+void IrProtocolSamsung32::encode(const IrCode& code, IrFrame& frame, IrPacing pacing)
+{
+    // Same byte layout as extended NEC with the address byte doubled; only
+    // the header differs.
+    uint8_t address = static_cast<uint8_t>(code.address);
+    IrNecEncoder::encodeExtended(static_cast<uint16_t>((address << 8) | address),
+                                 static_cast<uint8_t>(code.command), frame, pacing);
+
+    frame.items[0] = irItem(kHdrMarkUs, kHdrSpaceUs);
+    frame.durationUs = frame.durationUs - kNecHdrMarkUs - kNecHdrSpaceUs +
+                       kHdrMarkUs + kHdrSpaceUs;
+    setPacing(frame, kNecCarrierHz, kMinGapUs, kPeriodUs, 0, pacing);
+}
+
+void IrProtocolSony12::encode(const IrCode& code, IrFrame& frame, IrPacing pacing)
+{
+    uint16_t bits = static_cast<uint16_t>((code.command & 0x7F) | ((code.address & 0x1F) << 7));
+
+    IrFrameBuilder out(frame);
+    out.mark(kHdrMarkUs);
+    out.space(kSpaceUs);
+    for (int bit = 0; bit < kCommandBits + kAddressBits; ++bit)
+    {
+        out.mark((bits & (1U << bit)) ? kOneMarkUs : kZeroMarkUs);
+        out.space(kSpaceUs);
+    }
+    out.finish();
+
+    setPacing(frame, kCarrierHz, kMinGapUs, kPeriodUs, kRepeats, pacing);
+}
+
+void IrProtocolRc5::encode(const IrCode& code, IrFrame& frame, IrPacing pacing)
+{
+    // Start bit, field bit (inverted RC5X command bit 6), toggle, address,
+    // command -- 14 bits, MSB first.
+    bool field = (code.command & 0x40) == 0;
+    uint16_t bits = static_cast<uint16_t>((1U << 13) | (field ? (1U << 12) : 0) |
+                                          ((code.address & 0x1F) << 6) |
+                                          (code.command & 0x3F));
+
+    // RC5 sends a one as space-then-mark.
+    IrFrameBuilder out(frame);
+    for (int bit = 13; bit >= 0; --bit)
+    {
+        biphase(out, (bits & (1U << bit)) == 0, kHalfBitUs);
+    }
+    out.finish();
+
+    setPacing(frame, kCarrierHz, kMinGapUs, kPeriodUs, 0, pacing);
+}
+
+void IrProtocolRc6::encode(const IrCode& code, IrFrame& frame, IrPacing pacing)
+{
+    IrFrameBuilder out(frame);
+    out.mark(kHdrMarkUs);
+    out.space(kHdrSpaceUs);
+
+    // RC6 sends a one as mark-then-space: start bit, mode 000, then the
+    // double-width toggle bit.
+    biphase(out, true, kTickUs);
+    for (int bit = 0; bit < 3; ++bit)
+    {
+        biphase(out, false, kTickUs);
+    }
+    biphase(out, false, 2 * kTickUs);
+
+    uint16_t bits = static_cast<uint16_t>(((code.address & 0xFF) << 8) | (code.command & 0xFF));
+    for (int bit = 15; bit >= 0; --bit)
+    {
+        biphase(out, (bits & (1U << bit)) != 0, kTickUs);
+    }
+    out.finish();
+
+    setPacing(frame, kCarrierHz, kMinGapUs, kPeriodUs, 0, pacing);
+}
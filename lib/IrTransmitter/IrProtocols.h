@@ -0,0 +1,260 @@
+#ifndef IR_PROTOCOLS_H
+#define IR_PROTOCOLS_H
+
+#include <Arduino.h>
+#include "IrFrame.h"
+#include "IrNecEncoder.h"
+#include "IrTransmitter.h"
+
+// A code in some protocol's address/command space.
+struct IrCode
+{
+    uint16_t address;
+    uint16_t command;
+};
+
+enum class IrProtocolId : uint8_t
+{
+    Nec,
+    NecExtended,
+    Samsung32,
+    Sony12,
+    Rc5,
+    Rc6,
+    Count,
+};
+
+// What a held button sends after the first frame.
+enum class IrRepeatPolicy : uint8_t
+{
+    RepeatCode, // a short code carrying no data (NEC)
+    FullFrame,  // the whole frame again
+};
+
+// A code tagged with its protocol, in four bytes. Bit count, carrier and
+// repeat policy are the protocol's, so they come from its entry in the
+// dispatch table (irProtocolInfo) rather than being stored per code.
+struct IrTaggedCode
+{
+    IrProtocolId protocol;
+    uint8_t command; // no protocol here has more than 8 command bits
+    uint16_t address;
+
+    constexpr IrTaggedCode()
+    : protocol(IrProtocolId::Nec)
+    , command(0)
+    , address(0)
+    {
+    }
+
+    constexpr IrTaggedCode(IrProtocolId protocolId, uint16_t addressValue, uint8_t commandValue)
+    : protocol(protocolId)
+    , command(commandValue)
+    , address(addressValue)
+    {
+    }
+
+    constexpr IrCode code() const
+    {
+        return IrCode{address, command};
+    }
+};
+
+static_assert(sizeof(IrTaggedCode) == 4, "IrTaggedCode is meant to stay compact");
+
+// Protocol strategies. Each is a stateless type with the same static
+// interface: the size of its address and command fields, its carrier,
+// frame length and repeat policy, and encode(), which also fills in the
+// carrier, minimum gap, nominal period and the number of repeats a
+// receiver needs before it acts. Code templated on a
+// protocol (see irEncodeBatch) compiles down to direct calls.
+
+// Standard NEC: address | ~address | command | ~command.
+struct IrProtocolNec
+{
+    static constexpr IrProtocolId kId = IrProtocolId::Nec;
+    static constexpr const char* kName = "NEC";
+    static constexpr uint8_t kAddressBits = 8;
+    static constexpr uint8_t kCommandBits = 8;
+    static constexpr uint32_t kCarrierHz = kNecCarrierHz;
+    static constexpr uint8_t kFrameBits = 32;
+    static constexpr IrRepeatPolicy kRepeat = IrRepeatPolicy::RepeatCode;
+
+    static void encode(const IrCode& code, IrFrame& frame, IrPacing pacing);
+};
+
+// NEC with a 16-bit address and no address check byte.
+struct IrProtocolNecExtended
+{
+    static constexpr IrProtocolId kId = IrProtocolId::NecExtended;
+    static constexpr const char* kName = "NEC ext";
+    static constexpr uint8_t kAddressBits = 16;
+    static constexpr uint8_t kCommandBits = 8;
+    static constexpr uint32_t kCarrierHz = kNecCarrierHz;
+    static constexpr uint8_t kFrameBits = 32;
+    static constexpr IrRepeatPolicy kRepeat = IrRepeatPolicy::RepeatCode;
+
+    static void encode(const IrCode& code, IrFrame& frame, IrPacing pacing);
+};
+
+// Samsung32: address | address | command | ~command, NEC bit timing with
+// a shorter header.
+struct IrProtocolSamsung32
+{
+    static constexpr IrProtocolId kId = IrProtocolId::Samsung32;
+    static constexpr const char* kName = "Samsung";
+    static constexpr uint8_t kAddressBits = 8;
+    static constexpr uint8_t kCommandBits = 8;
+    static constexpr uint32_t kCarrierHz = kNecCarrierHz;
+    static constexpr uint8_t kFrameBits = 32;
+    static constexpr IrRepeatPolicy kRepeat = IrRepeatPolicy::FullFrame;
+
+    static constexpr uint16_t kHdrMarkUs = 4480;
+    static constexpr uint16_t kHdrSpaceUs = 4480;
+    static constexpr uint32_t kMinGapUs = 26880;
+    static constexpr uint32_t kPeriodUs = 108080;
+
+    static void encode(const IrCode& code, IrFrame& frame, IrPacing pacing);
+};
+
+// Sony SIRC, 12-bit: 7 command bits then 5 address bits, LSB first,
+// pulse-width coded on a 40 kHz carrier. Receivers want three copies.
+struct IrProtocolSony12
+{
+    static constexpr IrProtocolId kId = IrProtocolId::Sony12;
+    static constexpr const char* kName = "Sony12";
+    static constexpr uint8_t kAddressBits = 5;
+    static constexpr uint8_t kCommandBits = 7;
+    static constexpr uint32_t kCarrierHz = 40000;
+    static constexpr uint8_t kFrameBits = 12;
+    static constexpr IrRepeatPolicy kRepeat = IrRepeatPolicy::FullFrame;
+
+    static constexpr uint16_t kHdrMarkUs = 2400;
+    static constexpr uint16_t kOneMarkUs = 1200;
+    static constexpr uint16_t kZeroMarkUs = 600;
+    static constexpr uint16_t kSpaceUs = 600;
+    static constexpr uint32_t kMinGapUs = 10000;
+    static constexpr uint32_t kPeriodUs = 45000;
+    static constexpr uint8_t kRepeats = 2;
+
+    static void encode(const IrCode& code, IrFrame& frame, IrPacing pacing);
+};
+
+// Philips RC5 (with the RC5X seventh command bit), bi-phase on 36 kHz.
+// The toggle bit is always sent clear.
+struct IrProtocolRc5
+{
+    static constexpr IrProtocolId kId = IrProtocolId::Rc5;
+    static constexpr const char* kName = "RC5";
+    static constexpr uint8_t kAddressBits = 5;
+    static constexpr uint8_t kCommandBits = 7;
+    static constexpr uint32_t kCarrierHz = 36000;
+    static constexpr uint8_t kFrameBits = 14;
+    static constexpr IrRepeatPolicy kRepeat = IrRepeatPolicy::FullFrame;
+
+    static constexpr uint16_t kHalfBitUs = 889;
+    static constexpr uint32_t kPeriodUs = 113778;
+    static constexpr uint32_t kMinGapUs = kPeriodUs - 14 * 2 * kHalfBitUs;
+
+    static void encode(const IrCode& code, IrFrame& frame, IrPacing pacing);
+};
+
+// Philips RC6 mode 0, bi-phase on 36 kHz with a double-width toggle bit.
+// The toggle bit is always sent clear.
+struct IrProtocolRc6
+{
+    static constexpr IrProtocolId kId = IrProtocolId::Rc6;
+    static constexpr const char* kName = "RC6";
+    static constexpr uint8_t kAddressBits = 8;
+    static constexpr uint8_t kCommandBits = 8;
+    static constexpr uint32_t kCarrierHz = 36000;
+    static constexpr uint8_t kFrameBits = 21; // start, mode, toggle, 16 data
+    static constexpr IrRepeatPolicy kRepeat = IrRepeatPolicy::FullFrame;
+
+    static constexpr uint16_t kHdrMarkUs = 2666;
+    static constexpr uint16_t kHdrSpaceUs = 889;
+    static constexpr uint16_t kTickUs = 444;
+    static constexpr uint32_t kMinGapUs = 2666;
+    static constexpr uint32_t kPeriodUs = 83000;
+
+    static void encode(const IrCode& code, IrFrame& frame, IrPacing pacing);
+};
+
+// Encode up to `count` codes straight into free transmitter slots.
+// Returns how many were queued.
+template <typename Protocol>
+size_t irEncodeBatch(const IrCode* codes, size_t count,
+                     IrTransmitter& transmitter, IrPacing pacing)
+{
+    size_t queued = 0;
+    while (queued < count)
+    {
+        IrFrame* frame = transmitter.reserve();
+        if (frame == nullptr)
+        {
+            break;
+        }
+
+        Protocol::encode(codes[queued], *frame, pacing);
+        transmitter.commit();
+        queued++;
+    }
+    return queued;
+}
+
+// Runtime view of a protocol, for picking one from a menu or sending a
+// tagged code. The entries form a constexpr table indexed by
+// IrProtocolId, filled in from the strategies above, so routing a code
+// to its encoder is an array lookup and a direct function pointer: no
+// virtual calls and no names compared. The batch encoder is the
+// protocol's own irEncodeBatch instantiation, so a sweep costs one
+// indirect call per batch rather than per frame.
+struct IrProtocolInfo
+{
+    using BatchEncoder = size_t (*)(const IrCode* codes, size_t count,
+                                    IrTransmitter& transmitter, IrPacing pacing);
+    using Encoder = void (*)(const IrCode& code, IrFrame& frame, IrPacing pacing);
+
+    IrProtocolId id;
+    const char* name;
+    uint8_t addressBits;
+    uint8_t commandBits;
+    BatchEncoder encodeBatch;
+    Encoder encode;
+    uint32_t carrierHz;
+    uint8_t frameBits;
+    IrRepeatPolicy repeat;
+
+    uint16_t maxAddress() const
+    {
+        return static_cast<uint16_t>((1UL << addressBits) - 1);
+    }
+
+    uint16_t maxCommand() const
+    {
+        return static_cast<uint16_t>((1UL << commandBits) - 1);
+    }
+
+    uint32_t codeSpace() const
+    {
+        return 1UL << (addressBits + commandBits);
+    }
+};
+
+// Out-of-range ids fall back to NEC.
+const IrProtocolInfo& irProtocolInfo(IrProtocolId id);
+
+// The next protocol in IrProtocolId order, wrapping.
+IrProtocolId irNextProtocol(IrProtocolId id);
+
+void irEncode(const IrTaggedCode& code, IrFrame& frame, IrPacing pacing = IrPacing::Standard);
+
+// What follows the first frame while the button is held: the NEC repeat
+// code, or for other protocols the frame itself.
+void irEncodeRepeat(const IrTaggedCode& code, IrFrame& frame);
+
+// Encodes straight into a free transmitter slot. Returns false if the
+// queue is full.
+bool irSend(IrTransmitter& transmitter, const IrTaggedCode& code);
+
+#endif
@@ -0,0 +1,90 @@
+#ifdef ESP32
+
+#include "IrRmtDriver.h"
+#include <driver/rmt.h>
+#include <soc/soc.h>
+
+static_assert(sizeof(IrItem) == sizeof(rmt_item32_t), "IrItem must match rmt_item32_t");
+
+static constexpr rmt_channel_t kChannel = RMT_CHANNEL_0;
+
+IrRmtDriver::IrRmtDriver(uint8_t pin, uint32_t carrierHz)
+: pin_(pin)
+, carrierHz_(carrierHz)
+, started_(false)
+{
+}
+
+bool IrRmtDriver::begin()
+{
+    if (started_)
+    {
+        return true;
+    }
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_TX(static_cast<gpio_num_t>(pin_), kChannel);
+    config.clk_div = 80; // 1 tick = 1 us
+    config.tx_config.carrier_en = true;
+    config.tx_config.carrier_freq_hz = carrierHz_;
+    config.tx_config.carrier_duty_percent = 33;
+    config.tx_config.carrier_level = RMT_CARRIER_LEVEL_HIGH;
+    config.tx_config.idle_output_en = true;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+
+    if (rmt_config(&config) != ESP_OK)
+    {
+        return false;
+    }
+    if (rmt_driver_install(kChannel, 0, 0) != ESP_OK)
+    {
+        return false;
+    }
+
+    started_ = true;
+    return true;
+}
+
+bool IrRmtDriver::setCarrier(uint32_t carrierHz)
+{
+    if (carrierHz == carrierHz_)
+    {
+        return true;
+    }
+
+    carrierHz_ = carrierHz;
+    if (!started_)
+    {
+        return true;
+    }
+
+    // Carrier high/low counts are in APB clock cycles, not divided ticks.
+    uint32_t cycles = APB_CLK_FREQ / carrierHz;
+    uint16_t high = static_cast<uint16_t>(cycles / 3); // 33% duty, as in begin()
+    uint16_t low = static_cast<uint16_t>(cycles - high);
+    return rmt_set_tx_carrier(kChannel, true, high, low, RMT_CARRIER_LEVEL_HIGH) == ESP_OK;
+}
+
+bool IrRmtDriver::write(const IrItem* items, size_t count)
+{
+    if (!started_)
+    {
+        return false;
+    }
+
+    return rmt_write_items(kChannel,
+                           reinterpret_cast<const rmt_item32_t*>(items),
+                           static_cast<int>(count),
+                           false) == ESP_OK;
+}
+
+bool IrRmtDriver::busy() const
+{
+    if (!started_)
+    {
+        return false;
+    }
+
+    return rmt_wait_tx_done(kChannel, 0) == ESP_ERR_TIMEOUT;
+}
+
+#endif
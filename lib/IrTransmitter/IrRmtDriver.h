@@ -0,0 +1,87 @@
+#ifndef IR_RMT_DRIVER_H
+#define IR_RMT_DRIVER_H
+
+#include <Arduino.h>
+
+#ifndef ESP32
+#include <vector>
+#endif
+
+// One RMT symbol: a (level, duration) pair for the mark and one for the
+// space, packed exactly like rmt_item32_t. Durations are in microseconds.
+struct IrItem
+{
+    uint32_t val;
+};
+
+constexpr IrItem irItem(uint16_t markUs, uint16_t spaceUs)
+{
+    return IrItem{static_cast<uint32_t>(markUs & 0x7FFF) |
+                  0x8000U |
+                  (static_cast<uint32_t>(spaceUs & 0x7FFF) << 16)};
+}
+
+constexpr uint16_t irItemMarkUs(IrItem item)
+{
+    return static_cast<uint16_t>(item.val & 0x7FFF);
+}
+
+constexpr uint16_t irItemSpaceUs(IrItem item)
+{
+    return static_cast<uint16_t>((item.val >> 16) & 0x7FFF);
+}
+
+#ifndef ESP32
+// One write() as the fake driver saw it.
+struct IrCapturedFrame
+{
+    uint32_t startUs; // micros() at write()
+    uint32_t carrierHz;
+    uint32_t durationUs;
+    std::vector<IrItem> items;
+};
+#endif
+
+// Thin wrapper over one ESP32 RMT TX channel. write() only starts the
+// transfer; completion is polled with busy(). Off-target builds get a fake
+// that records every frame and completes only when told to.
+class IrRmtDriver
+{
+  public:
+    IrRmtDriver(uint8_t pin, uint32_t carrierHz);
+
+    bool begin();
+
+    // Changes the carrier for the next write(). Cheap when unchanged.
+    bool setCarrier(uint32_t carrierHz);
+
+    // Starts transmitting `count` items. The buffer must stay valid until
+    // busy() returns false.
+    bool write(const IrItem* items, size_t count);
+    bool busy() const;
+
+#ifndef ESP32
+    // Fake driver inspection. Frames complete on finish(), or on their
+    // own with setAutoFinish() once micros() has moved past their length.
+    void finish();
+    void setAutoFinish(bool autoFinish);
+    size_t framesWritten() const;
+    const std::vector<IrItem>& frame(size_t index) const;
+    const IrCapturedFrame& capture(size_t index) const;
+    void clearCapture();
+    uint32_t carrierHz() const;
+#endif
+
+  private:
+    uint8_t pin_;
+    uint32_t carrierHz_;
+    bool started_;
+
+#ifndef ESP32
+    bool busy_;
+    bool autoFinish_;
+    std::vector<IrCapturedFrame> frames_;
+#endif
+};
+
+#endif
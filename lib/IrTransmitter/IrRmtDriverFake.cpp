@@ -0,0 +1,99 @@
+#ifndef ESP32
+
+#include "IrRmtDriver.h"
+
+IrRmtDriver::IrRmtDriver(uint8_t pin, uint32_t carrierHz)
+: pin_(pin)
+, carrierHz_(carrierHz)
+, started_(false)
+, busy_(false)
+, autoFinish_(false)
+{
+}
+
+bool IrRmtDriver::begin()
+{
+    started_ = true;
+    return true;
+}
+
+bool IrRmtDriver::setCarrier(uint32_t carrierHz)
+{
+    carrierHz_ = carrierHz;
+    return true;
+}
+
+bool IrRmtDriver::write(const IrItem* items, size_t count)
+{
+    if (!started_ || busy())
+    {
+        return false;
+    }
+
+    uint32_t durationUs = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        durationUs += irItemMarkUs(items[i]) + irItemSpaceUs(items[i]);
+    }
+
+    frames_.push_back(IrCapturedFrame{micros(), carrierHz_, durationUs,
+                                      std::vector<IrItem>(items, items + count)});
+    busy_ = true;
+    return true;
+}
+
+bool IrRmtDriver::busy() const
+{
+    if (busy_ && autoFinish_)
+    {
+        const IrCapturedFrame& last = frames_.back();
+        return micros() - last.startUs < last.durationUs;
+    }
+    return busy_;
+}
+
+void IrRmtDriver::finish()
+{
+    busy_ = false;
+}
+
+void IrRmtDriver::setAutoFinish(bool autoFinish)
+{
+    autoFinish_ = autoFinish;
+}
+
+size_t IrRmtDriver::framesWritten() const
+{
+    return frames_.size();
+}
+
+const std::vector<IrItem>& IrRmtDriver::frame(size_t index) const
+{
+    return frames_[index].items;
+}
+
+const IrCapturedFrame& IrRmtDriver::capture(size_t index) const
+{
+    return frames_[index];
+}
+
+void IrRmtDriver::clearCapture()
+{
+    // Keeps the frame on the wire, if any, so busy() still sees it.
+    if (busy())
+    {
+        frames_.erase(frames_.begin(), frames_.end() - 1);
+    }
+    else
+    {
+        frames_.clear();
+        busy_ = false;
+    }
+}
+
+uint32_t IrRmtDriver::carrierHz() const
+{
+    return carrierHz_;
+}
+
+#endif
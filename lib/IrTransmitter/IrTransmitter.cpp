@@ -0,0 +1,334 @@
+#include "IrTransmitter.h"
+#include "IrNecEncoder.h"
+
+#ifdef ESP32
+static constexpr uint32_t kTaskStackBytes = 3072;
+static constexpr UBaseType_t kTaskPriority = 2; // above loop()
+#endif
+
+IrTransmitter::IrTransmitter(uint8_t pin, uint32_t carrierHz)
+: driver_(pin, carrierHz)
+, queue_()
+, inFlight_(false)
+, sendsLeft_(0)
+, lastStartUs_(0)
+, spacingUs_(0)
+, active_(false)
+, framesSent_(0)
+, holdTimer_(nullptr)
+, holdFirst_()
+, holdRepeat_()
+, holding_(false)
+, holdFrames_(0)
+, holdFirstUs_(0)
+, holdLastUs_(0)
+, holdMinPeriodUs_(0)
+, holdMaxPeriodUs_(0)
+#ifdef ESP32
+, task_(nullptr)
+#endif
+{
+}
+
+IrTransmitter::~IrTransmitter()
+{
+    if (holdTimer_ != nullptr)
+    {
+        stopHold();
+        esp_timer_delete(holdTimer_);
+    }
+}
+
+bool IrTransmitter::begin()
+{
+    if (!driver_.begin())
+    {
+        return false;
+    }
+    if (holdTimer_ != nullptr)
+    {
+        return true;
+    }
+
+    // Task dispatch: the callback may block briefly inside the RMT driver,
+    // which an ISR callback could not.
+    esp_timer_create_args_t args = {};
+    args.callback = &IrTransmitter::holdTimerFired;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "ir-hold";
+    return esp_timer_create(&args, &holdTimer_) == ESP_OK;
+}
+
+#ifdef ESP32
+
+bool IrTransmitter::startTask(uint8_t core)
+{
+    if (task_ != nullptr)
+    {
+        return true;
+    }
+
+    return xTaskCreatePinnedToCore(&IrTransmitter::taskMain, "ir", kTaskStackBytes, this,
+                                   kTaskPriority, &task_, core) == pdPASS;
+}
+
+void IrTransmitter::taskMain(void* arg)
+{
+    IrTransmitter* self = static_cast<IrTransmitter*>(arg);
+    for (;;)
+    {
+        self->tick();
+
+        // Sleep until commit() wakes us when there is nothing to do,
+        // otherwise poll the RMT and the gap every tick.
+        ulTaskNotifyTake(pdTRUE, self->consumerIdle() ? portMAX_DELAY : 1);
+    }
+}
+
+bool IrTransmitter::consumerIdle() const
+{
+    return sendsLeft_ == 0 && (queue_.waiting() == 0 || holding_.load(std::memory_order_acquire));
+}
+
+void IrTransmitter::wakeTask()
+{
+    if (task_ != nullptr)
+    {
+        xTaskNotifyGive(task_);
+    }
+}
+
+#else
+
+bool IrTransmitter::startTask(uint8_t /*core*/)
+{
+    return false;
+}
+
+void IrTransmitter::wakeTask()
+{
+}
+
+#endif
+
+bool IrTransmitter::sendNEC(uint8_t address, uint8_t command)
+{
+    IrFrame* frame = reserve();
+    if (frame == nullptr)
+    {
+        return false;
+    }
+
+    IrNecEncoder::encode(address, command, *frame);
+    commit();
+    return true;
+}
+
+void IrTransmitter::tick()
+{
+    uint32_t now = micros();
+
+    queue_.reclaim();
+
+    if (inFlight_)
+    {
+        if (driver_.busy())
+        {
+            return;
+        }
+
+        inFlight_ = false;
+        if (--sendsLeft_ == 0)
+        {
+            finishFrame();
+            framesSent_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    if (holding_.load(std::memory_order_acquire) ||
+        now - lastStartUs_.load(std::memory_order_acquire) < spacingUs_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    IrFrame* frame = queue_.claim();
+    if (frame == nullptr)
+    {
+        return;
+    }
+
+    if (sendsLeft_ == 0)
+    {
+        sendsLeft_ = frame->repeats + 1;
+        active_.store(true, std::memory_order_release);
+    }
+
+    startNext(now, *frame);
+}
+
+size_t IrTransmitter::clear()
+{
+    // Only frames tick() has not picked up are dropped; one part way
+    // through its repeats has already reached the target and finishes.
+    size_t dropped = queue_.cancel();
+    wakeTask();
+    return dropped;
+}
+
+bool IrTransmitter::isIdle() const
+{
+    return pending() == 0;
+}
+
+size_t IrTransmitter::pending() const
+{
+    return queue_.waiting() + (active_.load(std::memory_order_acquire) ? 1 : 0);
+}
+
+size_t IrTransmitter::freeSlots() const
+{
+    return queue_.freeSlots();
+}
+
+uint32_t IrTransmitter::framesSent() const
+{
+    return framesSent_.load(std::memory_order_acquire);
+}
+
+bool IrTransmitter::startHold(const IrFrame& first, const IrFrame& repeat, uint32_t periodUs)
+{
+    uint32_t now = micros();
+    if (holdTimer_ == nullptr || first.count == 0 || repeat.count == 0 ||
+        isHolding() || !isIdle() ||
+        now - lastStartUs_.load(std::memory_order_acquire) < spacingUs_.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    periodUs = max(periodUs, max(first.durationUs + first.gapUs, first.periodUs));
+    periodUs = max(periodUs, max(repeat.durationUs + repeat.gapUs, repeat.periodUs));
+
+    holdFirst_ = first;
+    holdRepeat_ = repeat;
+    if (!driver_.setCarrier(first.carrierHz) || !driver_.write(holdFirst_.items, holdFirst_.count))
+    {
+        return false;
+    }
+
+    holdFrames_.store(1, std::memory_order_relaxed);
+    holdFirstUs_.store(now, std::memory_order_relaxed);
+    holdLastUs_.store(now, std::memory_order_relaxed);
+    holdMinPeriodUs_.store(UINT32_MAX, std::memory_order_relaxed);
+    holdMaxPeriodUs_.store(0, std::memory_order_relaxed);
+    lastStartUs_.store(now, std::memory_order_release);
+    spacingUs_.store(periodUs, std::memory_order_release);
+    holding_.store(true, std::memory_order_release);
+
+    // The timer counts from here, a few microseconds after the first frame
+    // started, and re-arms itself from its own schedule rather than from
+    // when the callback ran, so lateness does not accumulate.
+    if (esp_timer_start_periodic(holdTimer_, periodUs) != ESP_OK)
+    {
+        holding_.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void IrTransmitter::stopHold()
+{
+    if (!holding_.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+    esp_timer_stop(holdTimer_);
+    wakeTask();
+}
+
+bool IrTransmitter::isHolding() const
+{
+    return holding_.load(std::memory_order_acquire);
+}
+
+IrHoldStats IrTransmitter::holdStats() const
+{
+    IrHoldStats stats{};
+    stats.frames = holdFrames_.load(std::memory_order_acquire);
+    if (stats.frames > 1)
+    {
+        uint32_t span = holdLastUs_.load(std::memory_order_relaxed) - holdFirstUs_.load(std::memory_order_relaxed);
+        stats.periodUs = span / (stats.frames - 1);
+        stats.minPeriodUs = holdMinPeriodUs_.load(std::memory_order_relaxed);
+        stats.maxPeriodUs = holdMaxPeriodUs_.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void IrTransmitter::holdTimerFired(void* arg)
+{
+    static_cast<IrTransmitter*>(arg)->sendHoldFrame();
+}
+
+void IrTransmitter::sendHoldFrame()
+{
+    // stopHold() may race the timer; it wins.
+    if (!holding_.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    uint32_t now = micros();
+    if (!driver_.write(holdRepeat_.items, holdRepeat_.count))
+    {
+        return; // this slot is lost; the schedule carries on
+    }
+
+    uint32_t period = now - holdLastUs_.load(std::memory_order_relaxed);
+    holdMinPeriodUs_.store(min(period, holdMinPeriodUs_.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    holdMaxPeriodUs_.store(max(period, holdMaxPeriodUs_.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    holdLastUs_.store(now, std::memory_order_relaxed);
+    lastStartUs_.store(now, std::memory_order_release);
+    holdFrames_.fetch_add(1, std::memory_order_release);
+}
+
+IrRmtDriver& IrTransmitter::driver()
+{
+    return driver_;
+}
+
+IrFrame* IrTransmitter::reserve()
+{
+    return queue_.reserve();
+}
+
+void IrTransmitter::commit()
+{
+    queue_.commit();
+    wakeTask();
+}
+
+void IrTransmitter::startNext(uint32_t now, const IrFrame& frame)
+{
+    if (frame.count == 0 || !driver_.setCarrier(frame.carrierHz) ||
+        !driver_.write(frame.items, frame.count))
+    {
+        // An empty frame (its waveform did not fit), or hardware refused
+        // it (not started?) -- drop it rather than stalling the queue
+        // forever.
+        sendsLeft_ = 0;
+        finishFrame();
+        return;
+    }
+
+    inFlight_ = true;
+
+    lastStartUs_.store(now, std::memory_order_release);
+    spacingUs_.store(max(frame.durationUs + frame.gapUs, frame.periodUs), std::memory_order_release);
+}
+
+void IrTransmitter::finishFrame()
+{
+    queue_.release();
+    active_.store(false, std::memory_order_release);
+}
@@ -0,0 +1,137 @@
+#ifndef IR_TRANSMITTER_H
+#define IR_TRANSMITTER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include "IrFrame.h"
+#include "IrRmtDriver.h"
+#include "SpscQueue.h"
+
+// What a hold has sent so far. Periods are start to start, as timed when
+// each frame was handed to the RMT.
+struct IrHoldStats
+{
+    uint32_t frames;      // the first frame included
+    uint32_t periodUs;    // mean, 0 until a second frame went out
+    uint32_t minPeriodUs;
+    uint32_t maxPeriodUs;
+
+    uint32_t jitterUs() const
+    {
+        return maxPeriodUs - minPeriodUs;
+    }
+};
+
+// Shared IR output. Frames are queued by send*() and clocked out by the RMT
+// peripheral in the background; tick() just hands the next frame to the
+// hardware once the previous one and its gap have finished. Neither call
+// blocks. Each frame carries its own carrier and repeat count, so frames of
+// different protocols can share the queue.
+//
+// The queue is lock-free SPSC: the UI thread is the producer (send*,
+// reserve/commit, clear and the status getters) and tick() is the
+// consumer. startTask() runs tick() in its own FreeRTOS task on the other
+// core, so frame timing does not depend on how long the UI takes to draw.
+//
+// A hold (a button kept down on a remote) bypasses the queue: an esp_timer
+// hands the repeated frame to the RMT every period, so its timing depends
+// on neither loop() nor the task's 1 ms tick.
+class IrTransmitter
+{
+  public:
+    IrTransmitter(uint8_t pin, uint32_t carrierHz = 38000);
+    ~IrTransmitter();
+
+    bool begin();
+
+    // Runs tick() in a task pinned to `core`. Returns false (and the
+    // caller keeps calling tick() itself) if there is no RTOS to do it.
+    bool startTask(uint8_t core);
+
+    // Queue a standard NEC frame: address | ~address | command | ~command.
+    // Returns false if the queue is full.
+    bool sendNEC(uint8_t address, uint8_t command);
+
+    // Producer side for callers that encode frames themselves: reserve()
+    // returns the next free slot (or nullptr when full) and commit()
+    // publishes it.
+    IrFrame* reserve();
+    void commit();
+
+    // Consumer side. Call every loop() unless startTask() succeeded.
+    void tick();
+
+    // Drop everything still waiting in the queue. A frame already on the
+    // wire is allowed to finish. Returns how many frames were dropped.
+    size_t clear();
+
+    // Seen from the producer, so a frame just being picked up may briefly
+    // be missing from pending().
+    bool isIdle() const;
+    size_t pending() const;
+    size_t freeSlots() const;
+    // Frames finished, counting a frame once however often it repeats.
+    uint32_t framesSent() const;
+
+    // Producer side. Sends `first` now, then `repeat` every periodUs
+    // (raised to what either frame needs) until stopHold(). Returns false
+    // while anything else is queued, on the wire or inside its gap; call
+    // again later. Both frames must share a carrier. Queued frames wait
+    // for the hold to end and keep its period from its last frame. An
+    // empty frame (see IrFrameBuilder) is never held.
+    bool startHold(const IrFrame& first, const IrFrame& repeat, uint32_t periodUs);
+    void stopHold();
+    bool isHolding() const;
+    IrHoldStats holdStats() const;
+
+    IrRmtDriver& driver();
+
+    static constexpr size_t kQueueDepth = 8;
+
+  private:
+    void startNext(uint32_t now, const IrFrame& frame);
+    void finishFrame();
+    void wakeTask();
+    static void holdTimerFired(void* arg);
+    void sendHoldFrame();
+
+#ifdef ESP32
+    static void taskMain(void* arg);
+    bool consumerIdle() const;
+#endif
+
+    IrRmtDriver driver_;
+    SpscQueue<IrFrame, kQueueDepth> queue_;
+
+    // Consumer only.
+    bool inFlight_;
+    uint32_t sendsLeft_; // copies of the held frame still to go, 0 = none held
+
+    // Written by whoever owns the wire: the consumer, or a hold while it
+    // runs. Read by both.
+    std::atomic<uint32_t> lastStartUs_;
+    std::atomic<uint32_t> spacingUs_;
+
+    // Published by the consumer.
+    std::atomic<bool> active_; // a frame is held, on the wire or between repeats
+    std::atomic<uint32_t> framesSent_;
+
+    // Hold. The frames are written before the timer starts and then only
+    // read by its callback.
+    esp_timer_handle_t holdTimer_;
+    IrFrame holdFirst_;
+    IrFrame holdRepeat_;
+    std::atomic<bool> holding_;
+    std::atomic<uint32_t> holdFrames_;
+    std::atomic<uint32_t> holdFirstUs_;
+    std::atomic<uint32_t> holdLastUs_;
+    std::atomic<uint32_t> holdMinPeriodUs_;
+    std::atomic<uint32_t> holdMaxPeriodUs_;
+
+#ifdef ESP32
+    TaskHandle_t task_;
+#endif
+};
+
+#endif
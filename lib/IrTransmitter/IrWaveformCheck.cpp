@@ -0,0 +1,218 @@
+#ifndef ESP32
+
+#include "IrWaveformCheck.h"
+
+namespace
+{
+
+uint32_t distance(uint32_t measured, uint32_t nominal)
+{
+    return (measured > nominal) ? measured - nominal : nominal - measured;
+}
+
+bool within(uint32_t measured, uint32_t nominal, const IrPulseSpec& spec, uint32_t& maxErrorUs)
+{
+    uint32_t error = distance(measured, nominal);
+    if (error > maxErrorUs)
+    {
+        maxErrorUs = error;
+    }
+    return error * 100 <= nominal * spec.tolerancePercent;
+}
+
+IrFrameCheck fail(IrFrameCheck check, const char* error)
+{
+    check.ok = false;
+    check.error = error;
+    return check;
+}
+
+IrFrameCheck checkRepeat(const std::vector<IrItem>& items, const IrPulseSpec& spec, IrFrameCheck check)
+{
+    check.repeat = true;
+    if (irItemSpaceUs(items.back()) != 0)
+    {
+        return fail(check, "no end marker");
+    }
+    if (!within(irItemMarkUs(items[0]), spec.headerMarkUs, spec, check.maxErrorUs) ||
+        !within(irItemSpaceUs(items[0]), spec.repeatSpaceUs, spec, check.maxErrorUs))
+    {
+        return fail(check, "repeat header");
+    }
+    if (!within(irItemMarkUs(items[1]), spec.trailerMarkUs, spec, check.maxErrorUs))
+    {
+        return fail(check, "trailer");
+    }
+    return check;
+}
+
+} // namespace
+
+IrFrameCheck irCheckFrame(const IrCapturedFrame& frame, const IrPulseSpec& spec)
+{
+    IrFrameCheck check{true, nullptr, 0, 0, false};
+    const std::vector<IrItem>& items = frame.items;
+
+    if (distance(frame.carrierHz, spec.carrierHz) * 100 > spec.carrierHz)
+    {
+        return fail(check, "carrier");
+    }
+
+    if (spec.repeatSpaceUs != 0 && spec.trailerMarkUs != 0 && items.size() == 2)
+    {
+        return checkRepeat(items, spec, check);
+    }
+
+    size_t expected = 1 + spec.bits + (spec.trailerMarkUs != 0 ? 1 : 0);
+    if (items.size() != expected)
+    {
+        return fail(check, "item count");
+    }
+    if (irItemSpaceUs(items.back()) != 0)
+    {
+        return fail(check, "no end marker");
+    }
+
+    if (!within(irItemMarkUs(items[0]), spec.headerMarkUs, spec, check.maxErrorUs) ||
+        !within(irItemSpaceUs(items[0]), spec.headerSpaceUs, spec, check.maxErrorUs))
+    {
+        return fail(check, "header");
+    }
+
+    for (uint8_t bit = 0; bit < spec.bits; ++bit)
+    {
+        IrItem item = items[1 + bit];
+        uint32_t mark = irItemMarkUs(item);
+        uint32_t space = irItemSpaceUs(item);
+        bool last = bit + 1 == spec.bits && spec.trailerMarkUs == 0;
+
+        // The end marker hides the last bit's space when nothing follows.
+        uint32_t zeroError = 0;
+        uint32_t oneError = 0;
+        bool zero = within(mark, spec.zeroMarkUs, spec, zeroError) &&
+                    (last || within(space, spec.zeroSpaceUs, spec, zeroError));
+        bool one = within(mark, spec.oneMarkUs, spec, oneError) &&
+                   (last || within(space, spec.oneSpaceUs, spec, oneError));
+        if (zero == one)
+        {
+            return fail(check, zero ? "ambiguous bit" : "bit timing");
+        }
+
+        uint32_t error = one ? oneError : zeroError;
+        if (error > check.maxErrorUs)
+        {
+            check.maxErrorUs = error;
+        }
+
+        uint64_t value = one ? 1 : 0;
+        check.data |= spec.lsbFirst ? (value << bit) : (value << (spec.bits - 1 - bit));
+    }
+
+    if (spec.trailerMarkUs != 0 &&
+        !within(irItemMarkUs(items.back()), spec.trailerMarkUs, spec, check.maxErrorUs))
+    {
+        return fail(check, "trailer");
+    }
+    return check;
+}
+
+IrCaptureReport irAnalyzeCapture(const IrRmtDriver& driver, const IrPulseSpec& spec,
+                                 bool checkPeriod, size_t first)
+{
+    IrCaptureReport report{};
+    size_t end = driver.framesWritten();
+    if (first >= end)
+    {
+        return report;
+    }
+
+    report.frames = end - first;
+    report.minGapUs = UINT32_MAX;
+    report.minPeriodUs = UINT32_MAX;
+    double gapSum = 0;
+    double periodSum = 0;
+
+    for (size_t i = first; i < end; ++i)
+    {
+        const IrCapturedFrame& frame = driver.capture(i);
+        IrFrameCheck check = irCheckFrame(frame, spec);
+        if (!check.ok)
+        {
+            if (report.badFrames++ == 0)
+            {
+                report.firstError = check.error;
+            }
+        }
+        else if (check.repeat)
+        {
+            report.repeatFrames++;
+        }
+        if (check.maxErrorUs > report.maxErrorUs)
+        {
+            report.maxErrorUs = check.maxErrorUs;
+        }
+
+        if (i == first)
+        {
+            continue;
+        }
+
+        const IrCapturedFrame& previous = driver.capture(i - 1);
+        uint32_t period = frame.startUs - previous.startUs;
+        uint32_t gap = period - previous.durationUs;
+
+        report.minGapUs = min(report.minGapUs, gap);
+        report.maxGapUs = max(report.maxGapUs, gap);
+        report.minPeriodUs = min(report.minPeriodUs, period);
+        report.maxPeriodUs = max(report.maxPeriodUs, period);
+        gapSum += gap;
+        periodSum += period;
+
+        if (gap < spec.minGapUs)
+        {
+            report.gapViolations++;
+        }
+        if (checkPeriod && spec.periodUs != 0 && period < spec.periodUs)
+        {
+            report.periodViolations++;
+        }
+    }
+
+    if (report.frames > 1)
+    {
+        report.meanGapUs = gapSum / (report.frames - 1);
+        report.meanPeriodUs = periodSum / (report.frames - 1);
+        report.framesPerSecond = 1000000.0 / report.meanPeriodUs;
+    }
+    else
+    {
+        report.minGapUs = 0;
+        report.minPeriodUs = 0;
+    }
+    return report;
+}
+
+void irPrintCaptureReport(const char* title, const IrCaptureReport& report)
+{
+    printf("%s\n", title);
+    printf("  frames %zu, bad %zu, worst timing error %u us\n", report.frames, report.badFrames,
+           report.maxErrorUs);
+    if (report.repeatFrames != 0)
+    {
+        printf("  %zu of them repeat codes\n", report.repeatFrames);
+    }
+    if (report.firstError != nullptr)
+    {
+        printf("  first bad frame: %s\n", report.firstError);
+    }
+    if (report.frames > 1)
+    {
+        printf("  gap    min %7.2f  mean %7.2f  max %7.2f ms, %zu too short\n", report.minGapUs / 1000.0,
+               report.meanGapUs / 1000.0, report.maxGapUs / 1000.0, report.gapViolations);
+        printf("  period min %7.2f  mean %7.2f  max %7.2f ms, %zu too short\n", report.minPeriodUs / 1000.0,
+               report.meanPeriodUs / 1000.0, report.maxPeriodUs / 1000.0, report.periodViolations);
+        printf("  %.2f frames/s\n", report.framesPerSecond);
+    }
+}
+
+#endif
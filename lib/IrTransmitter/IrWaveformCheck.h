@@ -0,0 +1,77 @@
+#ifndef IR_WAVEFORM_CHECK_H
+#define IR_WAVEFORM_CHECK_H
+
+#ifndef ESP32
+
+#include <Arduino.h>
+#include "IrRmtDriver.h"
+
+// Nominal timing of a pulse-coded protocol, taken from its spec rather
+// than from our encoders so a capture can be checked against it.
+struct IrPulseSpec
+{
+    const char* name;
+    uint32_t carrierHz;
+    uint16_t headerMarkUs;
+    uint16_t headerSpaceUs;
+    uint16_t zeroMarkUs;
+    uint16_t zeroSpaceUs;
+    uint16_t oneMarkUs;
+    uint16_t oneSpaceUs;
+    uint16_t trailerMarkUs; // 0 = the last bit ends the frame
+    uint8_t bits;
+    bool lsbFirst;
+    uint32_t minGapUs;  // silence needed before the next frame
+    uint32_t periodUs;  // start-to-start, 0 = not checked
+    uint8_t tolerancePercent;
+    uint16_t repeatSpaceUs; // repeat code: header mark, this, trailer mark (0 = none)
+};
+
+// NEC as IRremoteESP8266 sends raw 32-bit data (MSB first), which is what
+// the lamp codes and our encoder use. A held NEC button repeats a short
+// code instead of the frame.
+constexpr IrPulseSpec kIrNecSpec = {"NEC", 38000, 9000, 4500, 563, 563, 563, 1688, 563, 32, false, 20000, 108000, 10, 2250};
+constexpr IrPulseSpec kIrSamsung32Spec = {"Samsung32", 38000, 4500, 4500, 560, 560, 560, 1690, 560, 32, false, 20000, 108000, 10, 0};
+constexpr IrPulseSpec kIrSony12Spec = {"Sony12", 40000, 2400, 600, 600, 600, 1200, 600, 0, 12, true, 10000, 45000, 10, 0};
+
+struct IrFrameCheck
+{
+    bool ok;
+    const char* error;     // why not, nullptr when ok
+    uint64_t data;         // bits in the order the spec sends them
+    uint32_t maxErrorUs;   // worst mark or space against nominal
+    bool repeat;           // a repeat code, which carries no data
+};
+
+IrFrameCheck irCheckFrame(const IrCapturedFrame& frame, const IrPulseSpec& spec);
+
+// Timing of a run of captured frames. Gaps run from the end of one frame
+// to the start of the next; periods from start to start.
+struct IrCaptureReport
+{
+    size_t frames;
+    size_t badFrames;
+    size_t repeatFrames;
+    const char* firstError;
+    uint32_t maxErrorUs;
+    uint32_t minGapUs;
+    uint32_t maxGapUs;
+    double meanGapUs;
+    uint32_t minPeriodUs;
+    uint32_t maxPeriodUs;
+    double meanPeriodUs;
+    size_t gapViolations;
+    size_t periodViolations;
+    double framesPerSecond;
+};
+
+// Frames [first, driver.framesWritten()). Pass checkPeriod = false for
+// frames sent back to back (IrPacing::MinimumGap).
+IrCaptureReport irAnalyzeCapture(const IrRmtDriver& driver, const IrPulseSpec& spec,
+                                 bool checkPeriod = true, size_t first = 0);
+
+void irPrintCaptureReport(const char* title, const IrCaptureReport& report);
+
+#endif
+
+#endif
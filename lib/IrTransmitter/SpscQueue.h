@@ -0,0 +1,152 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+// Lock-free single-producer/single-consumer ring of N slots (N a power of
+// two). Items are built in place: the producer fills reserve() and
+// publishes it with commit(); the consumer claim()s the oldest item and
+// release()s it when done, holding at most one at a time. The producer can
+// also cancel() everything the consumer has not claimed yet, which is
+// what lets it drop queued work without waiting on the other side.
+//
+// Counters run freely and wrap; only their differences matter.
+template <typename T, size_t N>
+class SpscQueue
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+  public:
+    SpscQueue()
+    : head_(0)
+    , claim_(0)
+    , tail_(0)
+    , held_(false)
+    , heldIndex_(0)
+    {
+    }
+
+    // Producer side.
+
+    // Next free slot, or nullptr when full. Not visible until commit().
+    T* reserve()
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= N)
+        {
+            return nullptr;
+        }
+        return &slots_[head & (N - 1)];
+    }
+
+    void commit()
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool push(const T& item)
+    {
+        T* slot = reserve();
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        *slot = item;
+        commit();
+        return true;
+    }
+
+    // Drops every item not yet claimed. Returns how many were dropped.
+    size_t cancel()
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t claim = claim_.load(std::memory_order_acquire);
+        while (!claim_.compare_exchange_weak(claim, head, std::memory_order_acq_rel))
+        {
+        }
+        return head - claim;
+    }
+
+    // Items committed but not claimed.
+    size_t waiting() const
+    {
+        return head_.load(std::memory_order_acquire) - claim_.load(std::memory_order_acquire);
+    }
+
+    size_t freeSlots() const
+    {
+        return N - (head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire));
+    }
+
+    // Consumer side.
+
+    // The held item, else the oldest waiting one (now held), else nullptr.
+    T* claim()
+    {
+        if (held_)
+        {
+            return &slots_[heldIndex_ & (N - 1)];
+        }
+
+        reclaim();
+        size_t claim = claim_.load(std::memory_order_acquire);
+        for (;;)
+        {
+            if (claim == head_.load(std::memory_order_acquire))
+            {
+                return nullptr;
+            }
+            if (claim_.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel))
+            {
+                held_ = true;
+                heldIndex_ = claim;
+                return &slots_[claim & (N - 1)];
+            }
+        }
+    }
+
+    // Hands slots dropped by cancel() back to the producer. Done by
+    // claim() and release() anyway; a no-op while an item is held.
+    void reclaim()
+    {
+        if (!held_)
+        {
+            // Every slot before claim_ was released or cancelled.
+            tail_.store(claim_.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+
+    bool holding() const
+    {
+        return held_;
+    }
+
+    void release()
+    {
+        held_ = false;
+        reclaim();
+    }
+
+    bool pop(T& item)
+    {
+        T* slot = claim();
+        if (slot == nullptr)
+        {
+            return false;
+        }
+        item = *slot;
+        release();
+        return true;
+    }
+
+  private:
+    T slots_[N];
+    std::atomic<size_t> head_;  // committed; written by the producer
+    std::atomic<size_t> claim_; // claimed or cancelled; written by both
+    std::atomic<size_t> tail_;  // reusable below this; written by the consumer
+    bool held_;                 // consumer only
+    size_t heldIndex_;          // consumer only
+};
+
+#endif
@@ -1,11 +1,14 @@
 #include "ScrollList.h"
 
-ScrollList::ScrollList(M5GFX& screen, const char* const* items, size_t count)
+ScrollList::ScrollList(lgfx::LovyanGFX& screen, const char* const* items, size_t count)
 : screen_(screen)
 , items_(items)
 , count_(count)
 , selectedIndex_(0)
 , topIndex_(0)
+, drawn_(false)
+, drawnSelected_(0)
+, drawnTop_(0)
 , listTop_(8)
 , listLeft_(8)
 , lineHeight_(20)
@@ -43,6 +46,11 @@ int ScrollList::visibleRows() const
     return (screen_.height() - listTop_ - scrollPadding_) / lineHeight_;
 }
 
+int ScrollList::rowY(int row) const
+{
+    return listTop_ + row * lineHeight_;
+}
+
 void ScrollList::draw()
 {
     screen_.fillScreen(backgroundColor_);
@@ -58,7 +66,7 @@ void ScrollList::draw()
             break;
         }
 
-        int y = listTop_ + row * lineHeight_;
+        int y = rowY(row);
         bool isSelected = (itemIndex == selectedIndex_);
 
         if (isSelected)
@@ -74,6 +82,40 @@ void ScrollList::draw()
         screen_.setCursor(listLeft_, y);
         screen_.print(items_[itemIndex]);
     }
+
+    drawn_ = true;
+    drawnSelected_ = selectedIndex_;
+    drawnTop_ = topIndex_;
+}
+
+void ScrollList::update()
+{
+    if (!drawn_)
+    {
+        draw();
+        return;
+    }
+
+    screen_.setTextSize(textSize_);
+
+    if (topIndex_ != drawnTop_)
+    {
+        // Scrolled: every row changes, but painting them in place still
+        // beats clearing the screen first, and does not flicker.
+        int rows = visibleRows();
+        for (int row = 0; row < rows; ++row)
+        {
+            drawRow(topIndex_ + row);
+        }
+    }
+    else if (drawnSelected_ != selectedIndex_)
+    {
+        drawRow(drawnSelected_);
+        drawRow(selectedIndex_);
+    }
+
+    drawnSelected_ = selectedIndex_;
+    drawnTop_ = topIndex_;
 }
 
 bool ScrollList::moveUp(bool wrap)
@@ -152,3 +194,29 @@ void ScrollList::ensureSelectionVisible()
         topIndex_ = 0;
     }
 }
+
+// Paints one item's row, highlight included, over whatever is there.
+// Off-screen items are skipped.
+void ScrollList::drawRow(int itemIndex)
+{
+    int row = itemIndex - topIndex_;
+    if (row < 0 || row >= visibleRows())
+    {
+        return;
+    }
+
+    int y = rowY(row);
+    if (itemIndex >= static_cast<int>(count_))
+    {
+        screen_.fillRect(0, y - 1, screen_.width(), lineHeight_, backgroundColor_);
+        return;
+    }
+
+    bool isSelected = (itemIndex == selectedIndex_);
+    uint16_t background = isSelected ? highlightBackgroundColor_ : backgroundColor_;
+    screen_.fillRect(0, y - 1, screen_.width(), lineHeight_, background);
+    screen_.setTextColor(isSelected ? highlightTextColor_ : textColor_, background);
+    screen_.setCursor(listLeft_, y);
+    screen_.print(items_[itemIndex]);
+}
+
@@ -7,7 +7,7 @@
 class ScrollList
 {
   public:
-    ScrollList(M5GFX& screen, const char* const* items, size_t count);
+    ScrollList(lgfx::LovyanGFX& screen, const char* const* items, size_t count);
 
     void setLayout(int listTop, int listLeft, int lineHeight, int textSize, int scrollPadding);
     void setColors(uint16_t textColor,
@@ -15,7 +15,12 @@ class ScrollList
                    uint16_t highlightBackgroundColor,
                    uint16_t highlightTextColor);
 
+    // draw() paints the whole list; update() repaints only the rows that
+    // changed since: the old and new selected rows, or every row (painted
+    // in place, without clearing the screen) when the list has scrolled.
+    // Call draw() again after anything else used the screen.
     void draw();
+    void update();
     bool moveUp(bool wrap);
     bool moveDown(bool wrap);
 
@@ -23,15 +28,22 @@ class ScrollList
 
   private:
     int visibleRows() const;
+    int rowY(int row) const;
     void ensureSelectionVisible();
+    void drawRow(int itemIndex);
 
-    M5GFX& screen_;
+    lgfx::LovyanGFX& screen_;
     const char* const* items_;
     size_t count_;
 
     int selectedIndex_;
     int topIndex_;
 
+    // What is on screen, for update().
+    bool drawn_;
+    int drawnSelected_;
+    int drawnTop_;
+
     int listTop_;
     int listLeft_;
     int lineHeight_;
@@ -0,0 +1,56 @@
+#include "FieldFormat.h"
+
+char* formatDecimal(char* out, uint32_t value, int width, char pad)
+{
+    int digits = decimalDigits(value);
+    for (int i = digits; i < width; ++i)
+    {
+        *out++ = pad;
+    }
+
+    char* end = out + digits;
+    do
+    {
+        *--end = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return out + digits;
+}
+
+char* formatHex(char* out, uint32_t value, int digits)
+{
+    static constexpr char kHexDigits[] = "0123456789ABCDEF";
+    for (int i = digits - 1; i >= 0; --i)
+    {
+        *out++ = kHexDigits[(value >> (i * 4)) & 0xF];
+    }
+    return out;
+}
+
+char* formatTenths(char* out, uint32_t tenths, int width)
+{
+    out = formatDecimal(out, tenths / 10, width - 2);
+    *out++ = '.';
+    *out++ = static_cast<char>('0' + tenths % 10);
+    return out;
+}
+
+char* formatText(char* out, const char* text)
+{
+    while (*text != '\0')
+    {
+        *out++ = *text++;
+    }
+    return out;
+}
+
+int decimalDigits(uint32_t value)
+{
+    int digits = 1;
+    while (value >= 10)
+    {
+        value /= 10;
+        digits++;
+    }
+    return digits;
+}
@@ -0,0 +1,26 @@
+#ifndef FIELD_FORMAT_H
+#define FIELD_FORMAT_H
+
+#include <Arduino.h>
+
+// Fixed-width number formatting for the fields that change on every
+// redraw, without printf or allocation. Each call writes at `out` and
+// returns the end of what it wrote, so calls chain; nothing is
+// terminated until the caller writes the '\0'.
+
+// `value` right-aligned in at least `width` characters, padded with `pad`.
+char* formatDecimal(char* out, uint32_t value, int width = 0, char pad = ' ');
+
+// Exactly `digits` upper-case hex digits, leading zeros included.
+char* formatHex(char* out, uint32_t value, int digits);
+
+// `tenths` / 10 with one decimal, e.g. 123 -> "12.3", right-aligned in at
+// least `width` characters.
+char* formatTenths(char* out, uint32_t tenths, int width = 0);
+
+char* formatText(char* out, const char* text);
+
+// Characters formatDecimal() needs for `value`.
+int decimalDigits(uint32_t value);
+
+#endif
@@ -0,0 +1,122 @@
+#include "TextField.h"
+
+static constexpr int kFontWidth = 6;
+static constexpr int kFontHeight = 8;
+
+GlyphAtlas* TextField::atlas_ = nullptr;
+
+TextField::TextField(lgfx::LovyanGFX& screen, int x, int y, uint8_t textSize, uint16_t color,
+                     uint16_t background)
+: screen_(screen)
+, x_(x)
+, y_(y)
+, textSize_(textSize)
+, color_(color)
+, background_(background)
+, shownLength_(0)
+, stale_(false)
+{
+    shown_[0] = '\0';
+}
+
+void TextField::setColor(uint16_t color)
+{
+    setColors(color, background_);
+}
+
+void TextField::setColors(uint16_t color, uint16_t background)
+{
+    if (color != color_ || background != background_)
+    {
+        color_ = color;
+        background_ = background;
+        stale_ = true;
+    }
+}
+
+bool TextField::draw(const char* text)
+{
+    size_t length = strnlen(text, kMaxChars);
+    bool painted = false;
+
+    // Runs of changed characters, each painted with one print().
+    size_t i = 0;
+    while (i < length)
+    {
+        if (!stale_ && i < shownLength_ && text[i] == shown_[i])
+        {
+            i++;
+            continue;
+        }
+
+        size_t end = i + 1;
+        while (end < length && (stale_ || end >= shownLength_ || text[end] != shown_[end]))
+        {
+            end++;
+        }
+        paintRun(text, i, end);
+        painted = true;
+        i = end;
+    }
+
+    if (length < shownLength_)
+    {
+        blankRun(length, shownLength_);
+        painted = true;
+    }
+
+    memcpy(shown_, text, length);
+    shown_[length] = '\0';
+    shownLength_ = length;
+    stale_ = false;
+    return painted;
+}
+
+void TextField::invalidate()
+{
+    shown_[0] = '\0';
+    shownLength_ = 0;
+    stale_ = false;
+}
+
+void TextField::clear()
+{
+    draw("");
+}
+
+void TextField::setGlyphAtlas(GlyphAtlas* atlas)
+{
+    atlas_ = atlas;
+}
+
+int TextField::cellWidth() const
+{
+    return kFontWidth * textSize_;
+}
+
+void TextField::paintRun(const char* text, size_t first, size_t end)
+{
+    if (atlas_ != nullptr && color_ != background_ && atlas_->covers(text + first, end - first, textSize_))
+    {
+        for (size_t i = first; i < end; ++i)
+        {
+            atlas_->draw(screen_, x_ + static_cast<int>(i) * cellWidth(), y_, text[i], textSize_, color_, background_);
+        }
+        return;
+    }
+
+    char run[kMaxChars + 1];
+    memcpy(run, text + first, end - first);
+    run[end - first] = '\0';
+
+    screen_.setTextSize(textSize_);
+    screen_.setTextColor(color_, background_);
+    screen_.setCursor(x_ + static_cast<int>(first) * cellWidth(), y_);
+    screen_.print(run);
+}
+
+void TextField::blankRun(size_t first, size_t end)
+{
+    screen_.fillRect(x_ + static_cast<int>(first) * cellWidth(), y_,
+                     static_cast<int>(end - first) * cellWidth(), kFontHeight * textSize_, background_);
+}
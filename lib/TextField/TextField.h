@@ -0,0 +1,59 @@
+#ifndef TEXT_FIELD_H
+#define TEXT_FIELD_H
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <GlyphAtlas.h>
+
+// One line of text at a fixed spot that repaints only the characters that
+// changed since it was last drawn. The built-in font is fixed width
+// (6x8 scaled by the text size), so each character owns a cell and a
+// changed digit costs one glyph instead of a cleared screen. Text is
+// drawn with its background colour, so nothing is erased first and
+// nothing flickers; cells left over by a shorter string are filled.
+// Runs the glyph atlas covers are blitted from it instead of printed.
+class TextField
+{
+  public:
+    static constexpr size_t kMaxChars = 40;
+
+    TextField(lgfx::LovyanGFX& screen, int x, int y, uint8_t textSize, uint16_t color,
+              uint16_t background = TFT_BLACK);
+
+    // A colour change repaints the whole field on the next draw.
+    void setColor(uint16_t color);
+    void setColors(uint16_t color, uint16_t background);
+
+    // Returns true if anything was painted.
+    bool draw(const char* text);
+
+    // The field's area was painted over (say by fillScreen): forget what
+    // it showed so the next draw paints every character.
+    void invalidate();
+
+    // Blanks whatever the field shows.
+    void clear();
+
+    // Shared by every field; nullptr (the default) prints everything.
+    static void setGlyphAtlas(GlyphAtlas* atlas);
+
+  private:
+    int cellWidth() const;
+    void paintRun(const char* text, size_t first, size_t end);
+    void blankRun(size_t first, size_t end);
+
+    static GlyphAtlas* atlas_;
+
+    lgfx::LovyanGFX& screen_;
+    int x_;
+    int y_;
+    uint8_t textSize_;
+    uint16_t color_;
+    uint16_t background_;
+
+    char shown_[kMaxChars + 1];
+    size_t shownLength_;
+    bool stale_; // every shown character needs repainting
+};
+
+#endif
@@ -1,6 +1,6 @@
 #include "ValueEditor.h"
 
-ValueEditor::ValueEditor(M5GFX& screen)
+ValueEditor::ValueEditor(lgfx::LovyanGFX& screen)
 : screen_(screen)
 , label_("Value")
 , suffix_("")
@@ -8,6 +8,7 @@ ValueEditor::ValueEditor(M5GFX& screen)
 , maxValue_(100)
 , step_(1)
 , value_(0)
+, hex_(false)
 {
 }
 
@@ -33,6 +34,11 @@ void ValueEditor::setSuffix(const char* suffix)
     suffix_ = suffix;
 }
 
+void ValueEditor::setHex(bool hex)
+{
+    hex_ = hex;
+}
+
 void ValueEditor::setValue(int value)
 {
     value_ = clamp(value);
@@ -45,18 +51,17 @@ int ValueEditor::value() const
 
 bool ValueEditor::increase()
 {
-    int next = clamp(value_ + step_);
-    if (next == value_)
-    {
-        return false;
-    }
-    value_ = next;
-    return true;
+    return adjust(1);
 }
 
 bool ValueEditor::decrease()
 {
-    int next = clamp(value_ - step_);
+    return adjust(-1);
+}
+
+bool ValueEditor::adjust(int steps)
+{
+    int next = clamp(value_ + steps * step_);
     if (next == value_)
     {
         return false;
@@ -76,7 +81,14 @@ void ValueEditor::draw()
 
     screen_.setTextSize(3);
     screen_.setCursor(8, 48);
-    screen_.printf("%d%s", value_, suffix_);
+    if (hex_)
+    {
+        screen_.printf("0x%02X%s", value_, suffix_);
+    }
+    else
+    {
+        screen_.printf("%d%s", value_, suffix_);
+    }
 }
 
 int ValueEditor::clamp(int value) const
@@ -7,30 +7,35 @@
 class ValueEditor
 {
   public:
-    ValueEditor(M5GFX& screen);
+    ValueEditor(lgfx::LovyanGFX& screen);
 
     void setLabel(const char* label);
     void setRange(int minValue, int maxValue);
     void setStep(int step);
     void setSuffix(const char* suffix);
+    // Show the value as 0xNN instead of decimal.
+    void setHex(bool hex);
     void setValue(int value);
 
     int value() const;
 
     bool increase();
     bool decrease();
+    // Moves by `steps` steps (negative = down), stopping at the range.
+    bool adjust(int steps);
     void draw();
 
   private:
     int clamp(int value) const;
 
-    M5GFX& screen_;
+    lgfx::LovyanGFX& screen_;
     const char* label_;
     const char* suffix_;
     int minValue_;
     int maxValue_;
     int step_;
     int value_;
+    bool hex_;
 };
 
 #endif
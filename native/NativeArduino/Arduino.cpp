@@ -0,0 +1,271 @@
+#include "Arduino.h"
+#include "esp_timer.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr size_t kPinCount = 64;
+
+uint8_t pinLevels[kPinCount];
+
+bool virtualClock = false;
+uint64_t virtualUs = 0;
+
+std::chrono::steady_clock::time_point startTime()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+uint64_t elapsedUs()
+{
+    if (virtualClock)
+    {
+        return virtualUs;
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime())
+        .count();
+}
+
+} // namespace
+
+struct esp_timer
+{
+    esp_timer_cb_t callback;
+    void* arg;
+    bool armed;
+    uint64_t dueUs;
+    uint64_t periodUs; // 0 = one shot
+};
+
+namespace
+{
+
+std::vector<esp_timer*> timers;
+
+esp_timer* nextTimer(uint64_t untilUs)
+{
+    esp_timer* next = nullptr;
+    for (esp_timer* timer : timers)
+    {
+        if (timer->armed && timer->dueUs <= untilUs && (next == nullptr || timer->dueUs < next->dueUs))
+        {
+            next = timer;
+        }
+    }
+    return next;
+}
+
+// Fires everything due by `untilUs` in order, the virtual clock stepping
+// to each due time. A callback may start, stop or delete timers.
+void runTimers(uint64_t untilUs)
+{
+    while (esp_timer* timer = nextTimer(untilUs))
+    {
+        if (virtualClock && timer->dueUs > virtualUs)
+        {
+            virtualUs = timer->dueUs;
+        }
+        if (timer->periodUs != 0)
+        {
+            timer->dueUs += timer->periodUs;
+        }
+        else
+        {
+            timer->armed = false;
+        }
+        timer->callback(timer->arg);
+    }
+}
+
+void advance(uint64_t us)
+{
+    uint64_t target = virtualUs + us;
+    runTimers(target);
+    virtualUs = target;
+}
+
+} // namespace
+
+uint32_t millis()
+{
+    return static_cast<uint32_t>(elapsedUs() / 1000);
+}
+
+uint32_t micros()
+{
+    return static_cast<uint32_t>(elapsedUs());
+}
+
+void delay(uint32_t ms)
+{
+    if (virtualClock)
+    {
+        advance(static_cast<uint64_t>(ms) * 1000);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    runTimers(elapsedUs());
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    if (virtualClock)
+    {
+        advance(us);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+    runTimers(elapsedUs());
+}
+
+void yield()
+{
+    std::this_thread::yield();
+    if (!virtualClock)
+    {
+        runTimers(elapsedUs());
+    }
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < kPinCount && mode == INPUT_PULLUP)
+    {
+        pinLevels[pin] = HIGH;
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    return (pin < kPinCount) ? pinLevels[pin] : LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level)
+{
+    nativeSetPin(pin, level);
+}
+
+long random(long max)
+{
+    return (max > 0) ? ::random() % max : 0;
+}
+
+long random(long min, long max)
+{
+    return (max > min) ? min + random(max - min) : min;
+}
+
+void nativeSetPin(uint8_t pin, uint8_t level)
+{
+    if (pin < kPinCount)
+    {
+        pinLevels[pin] = level ? HIGH : LOW;
+    }
+}
+
+void nativeUseVirtualClock(uint32_t startUs)
+{
+    virtualClock = true;
+    virtualUs = startUs;
+}
+
+void nativeAdvanceMicros(uint32_t us)
+{
+    advance(us);
+}
+
+bool nativeClockIsVirtual()
+{
+    return virtualClock;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out)
+{
+    if (args == nullptr || args->callback == nullptr || out == nullptr)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *out = new esp_timer{args->callback, args->arg, false, 0, 0};
+    timers.push_back(*out);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeoutUs)
+{
+    if (timer->armed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->dueUs = elapsedUs() + timeoutUs;
+    timer->periodUs = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs)
+{
+    if (timer->armed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (periodUs == 0)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    timer->armed = true;
+    timer->dueUs = elapsedUs() + periodUs;
+    timer->periodUs = periodUs;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    if (!timer->armed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+    if (timer == nullptr)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (timer->armed)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timers.erase(std::find(timers.begin(), timers.end(), timer));
+    delete timer;
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time()
+{
+    return static_cast<int64_t>(elapsedUs());
+}
+
+// Test runners and benchmarks bring their own main().
+#if !defined(PIO_UNIT_TESTING) && !defined(NATIVE_NO_MAIN)
+
+void setup();
+void loop();
+
+int main()
+{
+    startTime();
+    setup();
+    for (;;)
+    {
+        loop();
+    }
+}
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Just enough of the Arduino core for the libraries to build and run on
+// the host (the `native` environment). Time is the host's monotonic
+// clock from program start, or a virtual clock that only moves when told
+// to; pins read back whatever was last set with nativeSetPin().
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define HIGH 0x1
+#define LOW 0x0
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define IRAM_ATTR
+
+using std::max;
+using std::min;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+
+long random(long max);
+long random(long min, long max);
+
+// Host-only: drive an input pin (pulled-up pins start HIGH).
+void nativeSetPin(uint8_t pin, uint8_t level);
+
+// Host-only: switch millis()/micros() to a virtual clock starting at
+// `startUs`. It moves only through nativeAdvanceMicros() and delay(),
+// which then return at once, so timing runs exactly and instantly.
+// esp_timer callbacks due on the way fire at their own time.
+void nativeUseVirtualClock(uint32_t startUs = 0);
+void nativeAdvanceMicros(uint32_t us);
+bool nativeClockIsVirtual();
+
+#endif
@@ -0,0 +1,398 @@
+#include "M5GFX.h"
+#include <stdarg.h>
+#include <stdlib.h>
+
+namespace lgfx
+{
+
+LovyanGFX::LovyanGFX()
+: textSize_(1)
+, textColor_(TFT_WHITE)
+, textBackground_(TFT_BLACK)
+, stats_()
+, cursorX_(0)
+, cursorY_(0)
+, clipped_(false)
+, clipX_(0)
+, clipY_(0)
+, clipW_(0)
+, clipH_(0)
+{
+}
+
+LovyanGFX::~LovyanGFX()
+{
+}
+
+void LovyanGFX::setClipRect(int32_t x, int32_t y, int32_t w, int32_t h)
+{
+    clipped_ = true;
+    clipX_ = x;
+    clipY_ = y;
+    clipW_ = w;
+    clipH_ = h;
+}
+
+void LovyanGFX::clearClipRect()
+{
+    clipped_ = false;
+}
+
+void LovyanGFX::fillScreen(uint32_t color)
+{
+    fillRect(0, 0, width(), height(), color);
+}
+
+void LovyanGFX::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+    uint64_t pixels = clip(x, y, w, h);
+    if (pixels != 0)
+    {
+        stats_.fills++;
+        stats_.fillPixels += pixels;
+        paint(x, y, w, h, static_cast<uint16_t>(color));
+    }
+}
+
+void LovyanGFX::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data)
+{
+    int32_t left = x;
+    int32_t top = y;
+    int32_t width = w;
+    int32_t height = h;
+    uint64_t pixels = clip(left, top, width, height);
+    if (pixels != 0 && data != nullptr)
+    {
+        stats_.images++;
+        stats_.imagePixels += pixels;
+        paintImage(left, top, width, height, data + static_cast<size_t>(top - y) * w + (left - x), w);
+    }
+}
+
+void LovyanGFX::setTextSize(float size)
+{
+    textSize_ = (size < 1) ? 1 : static_cast<int32_t>(size);
+}
+
+void LovyanGFX::setTextColor(uint32_t color)
+{
+    // Transparent background, like M5GFX.
+    textColor_ = static_cast<uint16_t>(color);
+    textBackground_ = static_cast<uint16_t>(color);
+}
+
+void LovyanGFX::setTextColor(uint32_t color, uint32_t background)
+{
+    textColor_ = static_cast<uint16_t>(color);
+    textBackground_ = static_cast<uint16_t>(background);
+}
+
+void LovyanGFX::setCursor(int32_t x, int32_t y)
+{
+    cursorX_ = x;
+    cursorY_ = y;
+}
+
+int32_t LovyanGFX::getCursorX() const
+{
+    return cursorX_;
+}
+
+int32_t LovyanGFX::getCursorY() const
+{
+    return cursorY_;
+}
+
+size_t LovyanGFX::print(const char* text)
+{
+    return write(text, strlen(text));
+}
+
+size_t LovyanGFX::print(char c)
+{
+    return write(&c, 1);
+}
+
+size_t LovyanGFX::print(int value)
+{
+    char text[12];
+    int length = snprintf(text, sizeof(text), "%d", value);
+    return write(text, static_cast<size_t>(length));
+}
+
+size_t LovyanGFX::printf(const char* format, ...)
+{
+    char text[128];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0)
+    {
+        return 0;
+    }
+    return write(text, std::min(static_cast<size_t>(length), sizeof(text) - 1));
+}
+
+const LovyanGFX::Stats& LovyanGFX::stats() const
+{
+    return stats_;
+}
+
+void LovyanGFX::resetStats()
+{
+    stats_ = Stats();
+}
+
+uint64_t LovyanGFX::clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const
+{
+    int32_t left = std::max<int32_t>(x, 0);
+    int32_t top = std::max<int32_t>(y, 0);
+    int32_t right = std::min<int32_t>(x + w, width());
+    int32_t bottom = std::min<int32_t>(y + h, height());
+    if (clipped_)
+    {
+        left = std::max<int32_t>(left, clipX_);
+        top = std::max<int32_t>(top, clipY_);
+        right = std::min<int32_t>(right, clipX_ + clipW_);
+        bottom = std::min<int32_t>(bottom, clipY_ + clipH_);
+    }
+    if (right <= left || bottom <= top)
+    {
+        return 0;
+    }
+
+    x = left;
+    y = top;
+    w = right - left;
+    h = bottom - top;
+    return static_cast<uint64_t>(w) * static_cast<uint64_t>(h);
+}
+
+void LovyanGFX::paintGlyph(int32_t x, int32_t y, int32_t w, int32_t h, char c)
+{
+    paint(x, y, w, h, textBackground_);
+}
+
+size_t LovyanGFX::write(const char* text, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        if (text[i] == '\n')
+        {
+            cursorX_ = 0;
+            cursorY_ += kFontHeight * textSize_;
+            continue;
+        }
+
+        int32_t x = cursorX_;
+        int32_t y = cursorY_;
+        int32_t w = kFontWidth * textSize_;
+        int32_t h = kFontHeight * textSize_;
+        uint64_t pixels = clip(x, y, w, h);
+        if (pixels != 0)
+        {
+            stats_.glyphs++;
+            stats_.glyphPixels += pixels;
+            paintGlyph(x, y, w, h, text[i]);
+        }
+        cursorX_ += kFontWidth * textSize_;
+    }
+    return length;
+}
+
+} // namespace lgfx
+
+M5GFX::M5GFX()
+: rotation_(0)
+, brightness_(0)
+, asleep_(false)
+{
+}
+
+bool M5GFX::init()
+{
+    return true;
+}
+
+void M5GFX::setRotation(uint8_t rotation)
+{
+    rotation_ = rotation & 3;
+}
+
+void M5GFX::setBrightness(uint8_t brightness)
+{
+    brightness_ = brightness;
+}
+
+uint8_t M5GFX::getBrightness() const
+{
+    return brightness_;
+}
+
+void M5GFX::sleep()
+{
+    asleep_ = true;
+}
+
+void M5GFX::wakeup()
+{
+    asleep_ = false;
+}
+
+int32_t M5GFX::width() const
+{
+    return (rotation_ & 1) ? kPanelHeight : kPanelWidth;
+}
+
+int32_t M5GFX::height() const
+{
+    return (rotation_ & 1) ? kPanelWidth : kPanelHeight;
+}
+
+void M5GFX::startWrite()
+{
+}
+
+void M5GFX::endWrite()
+{
+}
+
+void M5GFX::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::swap565_t* data)
+{
+    uint64_t pixels = clip(x, y, w, h);
+    if (pixels != 0 && data != nullptr)
+    {
+        charge(pixels);
+    }
+}
+
+bool M5GFX::dmaBusy() const
+{
+    return false;
+}
+
+void M5GFX::waitDMA()
+{
+}
+
+void M5GFX::paint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+    charge(static_cast<uint64_t>(w) * static_cast<uint64_t>(h));
+}
+
+void M5GFX::paintImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, int32_t stride)
+{
+    charge(static_cast<uint64_t>(w) * static_cast<uint64_t>(h));
+}
+
+void M5GFX::charge(uint64_t pixels)
+{
+    stats_.windows++;
+    stats_.spiBytes += kWindowBytes + pixels * kBytesPerPixel;
+}
+
+M5Canvas::M5Canvas(lgfx::LovyanGFX* parent)
+: buffer_(nullptr)
+, width_(0)
+, height_(0)
+{
+}
+
+M5Canvas::~M5Canvas()
+{
+    deleteSprite();
+}
+
+void M5Canvas::setColorDepth(int bits)
+{
+    // Always 16 bits here.
+}
+
+void M5Canvas::setPsram(bool enabled)
+{
+}
+
+void* M5Canvas::createSprite(int32_t w, int32_t h)
+{
+    deleteSprite();
+    if (w <= 0 || h <= 0)
+    {
+        return nullptr;
+    }
+
+    buffer_ = static_cast<uint16_t*>(calloc(static_cast<size_t>(w) * static_cast<size_t>(h), sizeof(uint16_t)));
+    if (buffer_ != nullptr)
+    {
+        width_ = w;
+        height_ = h;
+    }
+    return buffer_;
+}
+
+void M5Canvas::deleteSprite()
+{
+    free(buffer_);
+    buffer_ = nullptr;
+    width_ = 0;
+    height_ = 0;
+}
+
+void* M5Canvas::getBuffer() const
+{
+    return buffer_;
+}
+
+int32_t M5Canvas::width() const
+{
+    return width_;
+}
+
+int32_t M5Canvas::height() const
+{
+    return height_;
+}
+
+void M5Canvas::paint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color)
+{
+    color = static_cast<uint16_t>((color << 8) | (color >> 8));
+    for (int32_t row = y; row < y + h; ++row)
+    {
+        uint16_t* pixel = buffer_ + static_cast<size_t>(row) * static_cast<size_t>(width_) + x;
+        for (int32_t i = 0; i < w; ++i)
+        {
+            pixel[i] = color;
+        }
+    }
+}
+
+void M5Canvas::paintImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, int32_t stride)
+{
+    for (int32_t row = 0; row < h; ++row)
+    {
+        memcpy(buffer_ + static_cast<size_t>(y + row) * static_cast<size_t>(width_) + x,
+               data + static_cast<size_t>(row) * static_cast<size_t>(stride), static_cast<size_t>(w) * sizeof(uint16_t));
+    }
+}
+
+void M5Canvas::paintGlyph(int32_t x, int32_t y, int32_t w, int32_t h, char c)
+{
+    if (textBackground_ != textColor_)
+    {
+        paint(x, y, w, h, textBackground_);
+    }
+
+    // Stand-in strokes over the whole cell: pixel n (row-major) is set
+    // when bit n % 8 of the character is.
+    uint8_t bits = static_cast<uint8_t>(c);
+    for (int32_t row = 0; row < h; ++row)
+    {
+        for (int32_t column = 0; column < w; ++column)
+        {
+            if (bits & (1u << ((row * w + column) % 8)))
+            {
+                paint(x + column, y + row, 1, 1, textColor_);
+            }
+        }
+    }
+}
@@ -0,0 +1,198 @@
+#ifndef NATIVE_M5GFX_H
+#define NATIVE_M5GFX_H
+
+#include <Arduino.h>
+
+// RGB565, as in M5GFX.
+static constexpr uint16_t TFT_BLACK = 0x0000;
+static constexpr uint16_t TFT_NAVY = 0x000F;
+static constexpr uint16_t TFT_DARKGREEN = 0x03E0;
+static constexpr uint16_t TFT_DARKGREY = 0x7BEF;
+static constexpr uint16_t TFT_LIGHTGREY = 0xD69A;
+static constexpr uint16_t TFT_BLUE = 0x001F;
+static constexpr uint16_t TFT_GREEN = 0x07E0;
+static constexpr uint16_t TFT_CYAN = 0x07FF;
+static constexpr uint16_t TFT_RED = 0xF800;
+static constexpr uint16_t TFT_MAGENTA = 0xF81F;
+static constexpr uint16_t TFT_YELLOW = 0xFFE0;
+static constexpr uint16_t TFT_ORANGE = 0xFDA0;
+static constexpr uint16_t TFT_WHITE = 0xFFFF;
+
+namespace lgfx
+{
+
+// Byte-swapped RGB565, the layout of a 16-bit sprite buffer.
+struct swap565_t
+{
+    uint16_t raw;
+};
+
+// Host stand-in for the drawing half of LovyanGFX, which M5GFX (the
+// panel) and M5Canvas (a sprite in RAM) share: the calls the UI makes,
+// with the text state of the built-in 6x8 font scaled by the text size.
+// Every call is counted in stats() so redraw cost can be measured off the
+// device.
+class LovyanGFX
+{
+  public:
+    // What the calls since resetStats() cost. SPI bytes follow the ST7789
+    // write path: each fill or glyph opens an address window (CASET,
+    // RASET, RAMWR: kWindowBytes) and streams two bytes per pixel. Glyphs
+    // are charged their whole cell, which is exact with a background
+    // colour and an upper bound without one. pushImage() is one window
+    // for the whole image. Drawing into a canvas costs no SPI at all.
+    struct Stats
+    {
+        uint32_t fills;
+        uint64_t fillPixels;
+        uint32_t glyphs;
+        uint64_t glyphPixels;
+        uint32_t images;
+        uint64_t imagePixels;
+        uint32_t windows;
+        uint64_t spiBytes;
+    };
+
+    static constexpr uint32_t kWindowBytes = 11;
+    static constexpr uint32_t kBytesPerPixel = 2;
+
+    static constexpr int kFontWidth = 6;
+    static constexpr int kFontHeight = 8;
+
+    LovyanGFX();
+    virtual ~LovyanGFX();
+
+    virtual int32_t width() const = 0;
+    virtual int32_t height() const = 0;
+
+    void setClipRect(int32_t x, int32_t y, int32_t w, int32_t h);
+    void clearClipRect();
+
+    void fillScreen(uint32_t color);
+    void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    // Byte-swapped RGB565 pixels (swap565_t order, as LovyanGFX takes a
+    // uint16_t image without setSwapBytes()), w per row.
+    void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+
+    void setTextSize(float size);
+    void setTextColor(uint32_t color);
+    void setTextColor(uint32_t color, uint32_t background);
+    void setCursor(int32_t x, int32_t y);
+    int32_t getCursorX() const;
+    int32_t getCursorY() const;
+
+    size_t print(const char* text);
+    size_t print(char c);
+    size_t print(int value);
+    // No format checking: the UI prints uint32_t with %lu, right on the
+    // ESP32 (unsigned long) but not on a 64-bit host.
+    size_t printf(const char* format, ...);
+
+    const Stats& stats() const;
+    void resetStats();
+
+  protected:
+    // Clips a block to the screen and the clip rect. Returns its pixels.
+    uint64_t clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const;
+
+    // Paint an already clipped block: the panel charges it to the bus, a
+    // canvas writes it to RAM.
+    virtual void paint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) = 0;
+    // One character cell, already clipped. The panel charges the cell.
+    virtual void paintGlyph(int32_t x, int32_t y, int32_t w, int32_t h, char c);
+    // Already clipped; `stride` pixels per source row.
+    virtual void paintImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, int32_t stride) = 0;
+
+    int32_t textSize_;
+    uint16_t textColor_;
+    uint16_t textBackground_;
+    Stats stats_;
+
+  private:
+    size_t write(const char* text, size_t length);
+
+    int32_t cursorX_;
+    int32_t cursorY_;
+    bool clipped_;
+    int32_t clipX_;
+    int32_t clipY_;
+    int32_t clipW_;
+    int32_t clipH_;
+};
+
+} // namespace lgfx
+
+// The panel of an M5StickC Plus2 (135x240). Nothing is shown; every
+// block is charged to the SPI bus.
+class M5GFX : public lgfx::LovyanGFX
+{
+  public:
+    static constexpr int kPanelWidth = 135;
+    static constexpr int kPanelHeight = 240;
+
+    M5GFX();
+
+    bool init();
+    void setRotation(uint8_t rotation);
+    void setBrightness(uint8_t brightness);
+    uint8_t getBrightness() const;
+    void sleep();
+    void wakeup();
+
+    int32_t width() const override;
+    int32_t height() const override;
+
+    // Bus transactions and DMA. The transfer is counted when it starts;
+    // on the host it is never still running.
+    void startWrite();
+    void endWrite();
+    void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, const lgfx::swap565_t* data);
+    bool dmaBusy() const;
+    void waitDMA();
+
+  protected:
+    void paint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override;
+    void paintImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, int32_t stride) override;
+
+  private:
+    void charge(uint64_t pixels);
+
+    uint8_t rotation_;
+    uint8_t brightness_;
+    bool asleep_;
+};
+
+// A sprite: the same drawing calls, into a 16-bit buffer in RAM. Like
+// the real one it holds byte-swapped RGB565, so an image pushed in the
+// wrong byte order reads back in the wrong colours.
+// Glyphs become a pattern unique to the character and colours, so changed
+// text changes the buffer the way real glyphs would.
+class M5Canvas : public lgfx::LovyanGFX
+{
+  public:
+    explicit M5Canvas(lgfx::LovyanGFX* parent = nullptr);
+    ~M5Canvas() override;
+
+    void setColorDepth(int bits);
+    void setPsram(bool enabled);
+
+    // Returns the buffer, or nullptr without the memory.
+    void* createSprite(int32_t w, int32_t h);
+    void deleteSprite();
+    void* getBuffer() const;
+
+    int32_t width() const override;
+    int32_t height() const override;
+
+  protected:
+    void paint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override;
+    void paintGlyph(int32_t x, int32_t y, int32_t w, int32_t h, char c) override;
+    void paintImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, int32_t stride) override;
+
+  private:
+    uint16_t* buffer_;
+    int32_t width_;
+    int32_t height_;
+};
+
+#endif
@@ -0,0 +1,124 @@
+#include "Preferences.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+using Namespace = std::map<std::string, std::vector<uint8_t>>;
+
+std::map<std::string, Namespace>& storage()
+{
+    static std::map<std::string, Namespace> namespaces;
+    return namespaces;
+}
+
+// NVS keys and namespace names are at most 15 characters.
+constexpr size_t kMaxKeyLength = 15;
+
+bool validKey(const char* key)
+{
+    return key != nullptr && key[0] != '\0' && strlen(key) <= kMaxKeyLength;
+}
+
+} // namespace
+
+Preferences::Preferences()
+: name_(nullptr)
+, started_(false)
+, readOnly_(false)
+{
+}
+
+Preferences::~Preferences()
+{
+    end();
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partitionLabel)
+{
+    if (started_ || !validKey(name))
+    {
+        return false;
+    }
+
+    // Read-only opens fail until something has created the namespace.
+    if (readOnly && storage().find(name) == storage().end())
+    {
+        return false;
+    }
+
+    storage()[name];
+    name_ = name;
+    readOnly_ = readOnly;
+    started_ = true;
+    return true;
+}
+
+void Preferences::end()
+{
+    started_ = false;
+}
+
+bool Preferences::clear()
+{
+    if (!started_ || readOnly_)
+    {
+        return false;
+    }
+    storage()[name_].clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key)
+{
+    if (!started_ || readOnly_ || !validKey(key))
+    {
+        return false;
+    }
+    return storage()[name_].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key)
+{
+    return started_ && validKey(key) && storage()[name_].count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length)
+{
+    if (!started_ || readOnly_ || !validKey(key) || value == nullptr || length == 0)
+    {
+        return 0;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    storage()[name_][key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char* key)
+{
+    if (!isKey(key))
+    {
+        return 0;
+    }
+    return storage()[name_][key].size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t maxLength)
+{
+    size_t length = getBytesLength(key);
+    if (length == 0 || buffer == nullptr || maxLength < length)
+    {
+        return 0;
+    }
+
+    memcpy(buffer, storage()[name_][key].data(), length);
+    return length;
+}
+
+void nativeErasePreferences()
+{
+    storage().clear();
+}
@@ -0,0 +1,34 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <Arduino.h>
+
+// In-memory NVS for the host. Namespaces and keys outlive the Preferences
+// object (as flash would) until nativeErasePreferences().
+class Preferences
+{
+  public:
+    Preferences();
+    ~Preferences();
+
+    bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBytes(const char* key, const void* value, size_t length);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t maxLength);
+
+  private:
+    const char* name_;
+    bool started_;
+    bool readOnly_;
+};
+
+// Host-only: forget every namespace.
+void nativeErasePreferences();
+
+#endif
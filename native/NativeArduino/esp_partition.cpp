@@ -0,0 +1,116 @@
+#include "esp_partition.h"
+#include <string.h>
+#include <memory>
+#include <vector>
+
+namespace
+{
+
+struct Partition
+{
+    esp_partition_t info;
+    std::vector<uint8_t> data;
+};
+
+std::vector<std::unique_ptr<Partition>> partitions;
+size_t openMaps = 0;
+
+const Partition* find(const esp_partition_t* info)
+{
+    for (const std::unique_ptr<Partition>& partition : partitions)
+    {
+        if (&partition->info == info)
+        {
+            return partition.get();
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label)
+{
+    for (const std::unique_ptr<Partition>& partition : partitions)
+    {
+        const esp_partition_t& info = partition->info;
+        if (info.type == type && (subtype == ESP_PARTITION_SUBTYPE_ANY || info.subtype == subtype) &&
+            (label == nullptr || strcmp(info.label, label) == 0))
+        {
+            return &info;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* info, size_t offset, void* out, size_t size)
+{
+    const Partition* partition = find(info);
+    if (partition == nullptr || out == nullptr)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset > partition->data.size() || size > partition->data.size() - offset)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    memcpy(out, partition->data.data() + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* info, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void** out, spi_flash_mmap_handle_t* handle)
+{
+    const Partition* partition = find(info);
+    if (partition == nullptr || out == nullptr || handle == nullptr)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (offset > partition->data.size() || size > partition->data.size() - offset)
+    {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    *out = partition->data.data() + offset;
+    *handle = static_cast<spi_flash_mmap_handle_t>(++openMaps);
+    return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle)
+{
+    if (openMaps > 0)
+    {
+        openMaps--;
+    }
+}
+
+void nativeSetPartition(const char* label, esp_partition_type_t type, uint8_t subtype, const void* data,
+                        size_t size)
+{
+    Partition* partition = nullptr;
+    for (const std::unique_ptr<Partition>& existing : partitions)
+    {
+        if (strcmp(existing->info.label, label) == 0)
+        {
+            partition = existing.get();
+        }
+    }
+    if (partition == nullptr)
+    {
+        partitions.emplace_back(new Partition());
+        partition = partitions.back().get();
+    }
+
+    partition->info = esp_partition_t{};
+    partition->info.type = type;
+    partition->info.subtype = static_cast<esp_partition_subtype_t>(subtype);
+    partition->info.size = static_cast<uint32_t>(size);
+    strncpy(partition->info.label, label, sizeof(partition->info.label) - 1);
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    partition->data.assign(bytes, bytes + size);
+}
+
+size_t nativeOpenPartitionMaps()
+{
+    return openMaps;
+}
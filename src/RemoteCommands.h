@@ -0,0 +1,24 @@
+// Generated by tools/build_irlib.py from remotes/lamp.csv.
+// Edit the sources and rebuild rather than this file.
+#ifndef REMOTE_COMMANDS_H
+#define REMOTE_COMMANDS_H
+
+#include <IrCommandList.h>
+
+static constexpr char kRemoteCommandNames[] =
+    "White/Yellow\0"
+    "Yellow>White\0"
+    "Colorful 1\0"
+    "Colorful 2\0"
+    "Off\0";
+
+static constexpr IrPackedCommand kLampPackedCommands[] = {
+    {0, {IrProtocolId::Nec, 0x00, 0x18}},
+    {13, {IrProtocolId::Nec, 0x00, 0x30}},
+    {26, {IrProtocolId::Nec, 0x00, 0x38}},
+    {37, {IrProtocolId::Nec, 0x00, 0x4A}},
+    {48, {IrProtocolId::Nec, 0x00, 0x62}},
+};
+static constexpr IrPackedCommandArray kLampCommands(kRemoteCommandNames, kLampPackedCommands, 5);
+
+#endif
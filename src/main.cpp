@@ -1,15 +1,31 @@
 #include <Arduino.h>
 #include <M5GFX.h>
 #include <Button.h>
+#include <ButtonGestures.h>
+#include <ButtonInput.h>
+#include <FrameBuffer.h>
+#include <GlyphAtlas.h>
 #include <ScrollList.h>
+#include <TextField.h>
 #include <ValueEditor.h>
 #include <IrBruteforce.h>
+#include <IrCodeLibrary.h>
 #include <IrCodeSender.h>
 #include <IrRemote.h>
 #include <IrRepeatSender.h>
+#include <IrTransmitter.h>
+#include "RemoteCommands.h"
 
 static M5GFX screen;
 
+// Screens that redraw large areas at once draw into this back buffer and
+// are presented by DMA, so they neither flicker nor hold up loop() while
+// the SPI transfer runs. See isBuffered().
+static FrameBuffer frameBuffer(screen);
+
+// Digits and hex for the code screens' fields, blitted instead of printed.
+static GlyphAtlas glyphAtlas;
+
 static constexpr uint8_t kButtonUpPin = 35;     // Up
 static constexpr uint8_t kButtonDownPin = 39;   // Down
 static constexpr uint8_t kButtonSelectPin = 37; // Select
@@ -18,17 +34,30 @@ static Button buttonUp(kButtonUpPin);
 static Button buttonDown(kButtonDownPin);
 static Button buttonSelect(kButtonSelectPin);
 
+static constexpr uint8_t kButtonPins[] = {kButtonUpPin, kButtonDownPin, kButtonSelectPin};
+static ButtonInput buttonInput(kButtonPins, sizeof(kButtonPins));
+
+// Gesture indices follow this order.
+static constexpr uint8_t kUp = 0;
+static constexpr uint8_t kDown = 1;
+static constexpr uint8_t kSelect = 2;
+static Button* const kGestureButtons[] = {&buttonUp, &buttonDown, &buttonSelect};
+static ButtonGestures gestures(kGestureButtons, sizeof(kGestureButtons) / sizeof(kGestureButtons[0]));
+
 static constexpr uint8_t kIrPin = 19; // M5StickC Plus2 IR LED
+static constexpr uint8_t kIrCore = 0; // loop() runs on core 1
+static IrTransmitter irTransmitter(kIrPin);
+static bool irHasTask = false;
 
-static constexpr IrCommand kLampCommands[] = {
-    {"White/Yellow",  0x00, 0x18},
-    {"Yellow>White",  0x00, 0x30},
-    {"Colorful 1",    0x00, 0x38},
-    {"Colorful 2",    0x00, 0x4A},
-    {"Off",           0x00, 0x62},
-};
-static constexpr size_t kLampCommandCount = sizeof(kLampCommands) / sizeof(kLampCommands[0]);
-static IrRemote lampRemote(screen, kIrPin, kLampCommands, kLampCommandCount);
+// Built-in remotes come from remotes/ (see custom_builtin_remotes in
+// platformio.ini).
+static IrRemote lampRemote(screen, irTransmitter, kLampCommands);
+
+// Remotes flashed separately into the irlib partition, one profile at a
+// time; rows are read from flash as they are drawn.
+static IrCodeLibrary codeLibrary;
+static IrLibraryProfile libraryProfile(codeLibrary);
+static IrRemote libraryRemote(screen, irTransmitter, libraryProfile);
 
 static constexpr const char* kItems[] = {
     "Brightness",
@@ -36,26 +65,35 @@ static constexpr const char* kItems[] = {
     "IR Bruteforce",
     "IR Send",
     "IR Repeat",
+    "Code Library",
 };
 
 static constexpr size_t kItemCount = sizeof(kItems) / sizeof(kItems[0]);
 static ScrollList list(screen, kItems, kItemCount);
-static ValueEditor valueEditor(screen);
+static ValueEditor valueEditor(frameBuffer.canvas());
 
 static constexpr int kBrightnessItemIndex = 0;
 static constexpr int kLampRemoteItemIndex = 1;
 static constexpr int kIrBruteforceItemIndex = 2;
 static constexpr int kIrSendItemIndex = 3;
 static constexpr int kIrRepeatItemIndex = 4;
-
-static IrBruteforce irBruteforce(screen, kIrPin);
-static IrCodeSender irCodeSender(screen, kIrPin);
-static IrRepeatSender irRepeatSender(screen, kIrPin);
+static constexpr int kCodeLibraryItemIndex = 5;
+
+static IrBruteforce irBruteforce(frameBuffer.canvas(), irTransmitter);
+static IrCodeSender irCodeSender(screen, irTransmitter);
+static IrRepeatSender irRepeatSender(screen, irTransmitter);
+// Sweeps and auto-repeat redraw at most this often however fast codes go
+// out, and not at all with the backlight off.
+static constexpr uint32_t kSweepRefreshHz = 10;
 static constexpr uint32_t kRepeatDelayMs = 500;
 static constexpr uint32_t kRepeatIntervalMs = 33;
 
 static constexpr uint32_t kLongPressMs = 3000;
 
+// loop() blocks on button edges; these bound the wait.
+static constexpr uint32_t kBusyPollMs = 10;
+static constexpr uint32_t kIdleSleepMs = 60000; // screen off, light sleep
+
 enum class ScreenMode
 {
     List,
@@ -64,14 +102,15 @@ enum class ScreenMode
     IrSend,
     IrRepeat,
     LampRemote,
+    CodeLibrary,
 };
 
 static ScreenMode screenMode = ScreenMode::List;
-static uint32_t upPressStartMs = 0;
-static uint32_t upLastRepeatMs = 0;
-static uint32_t downPressStartMs = 0;
-static uint32_t downLastRepeatMs = 0;
-static uint32_t selectPressStartMs = 0;
+static uint32_t lastInputMs = 0;
+static bool swallowWakePress = false;
+// On the code screens Up/Down chord with a held Select instead of stepping.
+static bool selectHeld = false;
+static uint8_t screenBrightness = 128;
 
 static uint8_t percentToBrightness(int percent)
 {
@@ -86,379 +125,612 @@ static uint8_t percentToBrightness(int percent)
     return static_cast<uint8_t>((percent * 255) / 100);
 }
 
-void setup()
+static void setScreenBrightness(uint8_t brightness)
 {
-    screen.init();
-    screen.setRotation(3);
-    screen.setBrightness(128);
+    screenBrightness = brightness;
+    screen.setBrightness(brightness);
 
-    buttonUp.begin();
-    buttonDown.begin();
-    buttonSelect.begin();
+    uint32_t refreshHz = (brightness == 0) ? 0 : kSweepRefreshHz;
+    irBruteforce.setRefreshHz(refreshHz);
+    irRepeatSender.setRefreshHz(refreshHz);
+}
+
+static Button* buttonForPin(uint8_t pin)
+{
+    switch (pin)
+    {
+        case kButtonUpPin:
+            return &buttonUp;
+        case kButtonDownPin:
+            return &buttonDown;
+        case kButtonSelectPin:
+            return &buttonSelect;
+        default:
+            return nullptr;
+    }
+}
 
-    irCodeSender.begin();
-    irRepeatSender.begin();
-    lampRemote.begin();
+// Something needs loop() to come round again soon: IR still going out, a
+// button held or still debouncing (hold-repeat and long press are timed),
+// or a screen that animates on its own.
+static bool loopBusy()
+{
+    return !irTransmitter.isIdle() ||
+           buttonInput.anyPressed() ||
+           buttonUp.settling() || buttonDown.settling() || buttonSelect.settling() ||
+           irBruteforce.isRunning() || irBruteforce.isBisecting() ||
+           irRepeatSender.isSending();
+}
 
-    valueEditor.setLabel("Brightness");
-    valueEditor.setSuffix("%");
-    valueEditor.setRange(0, 100);
-    valueEditor.setStep(5);
-    valueEditor.setValue(50);
+static void handleEdge(const ButtonEdge& edge)
+{
+    lastInputMs = millis();
 
-    list.draw();
+    // The press that woke the device only turns the screen back on.
+    if (swallowWakePress)
+    {
+        swallowWakePress = buttonInput.anyPressed();
+        return;
+    }
+
+    Button* button = buttonForPin(edge.pin);
+    if (button != nullptr)
+    {
+        button->on_edge(edge.level, edge.timeMs);
+    }
 }
 
-void loop()
+static void sleepUntilButton()
 {
-    bool updated = false;
+    frameBuffer.waitPresented();
+
+    // The backlight PWM stops in light sleep, so switch it off properly.
+    screen.setBrightness(0);
+    screen.sleep();
 
-    if (screenMode == ScreenMode::List)
+    if (buttonInput.lightSleep(0))
     {
-        buttonUp.read();
-        buttonDown.read();
-        buttonSelect.read();
+        swallowWakePress = true;
+    }
 
-        if (buttonUp.pressed())
-        {
-            updated = list.moveUp(true);
-        }
+    screen.wakeup();
+    screen.setBrightness(screenBrightness);
+    lastInputMs = millis();
+}
 
-        if (buttonDown.pressed())
+static void waitForInput()
+{
+    uint32_t timeoutMs = kBusyPollMs;
+    if (!irHasTask && !irTransmitter.isIdle())
+    {
+        // Without the IR task, come round faster while frames are queued
+        // so the loop does not stretch the inter-frame gap.
+        timeoutMs = 1;
+    }
+    else if (!loopBusy())
+    {
+        uint32_t idleMs = millis() - lastInputMs;
+        if (idleMs >= kIdleSleepMs)
         {
-            updated = list.moveDown(true) || updated;
+            sleepUntilButton();
+            return;
         }
+        timeoutMs = kIdleSleepMs - idleMs;
+    }
 
-        if (buttonSelect.pressed())
+    ButtonEdge edge;
+    if (!buttonInput.next(edge, timeoutMs))
+    {
+        if (swallowWakePress && !buttonInput.anyPressed())
         {
-            if (list.selectedIndex() == kBrightnessItemIndex)
-            {
-                screenMode = ScreenMode::Editor;
-                valueEditor.draw();
-            }
-            else if (list.selectedIndex() == kLampRemoteItemIndex)
-            {
-                screenMode = ScreenMode::LampRemote;
-                selectPressStartMs = 0;
-                lampRemote.draw();
-            }
-            else if (list.selectedIndex() == kIrBruteforceItemIndex)
-            {
-                screenMode = ScreenMode::IrBruteforce;
-                irBruteforce.start();
-            }
-            else if (list.selectedIndex() == kIrSendItemIndex)
-            {
-                screenMode = ScreenMode::IrSend;
-                selectPressStartMs = 0;
-                irCodeSender.draw();
-            }
-            else if (list.selectedIndex() == kIrRepeatItemIndex)
-            {
-                screenMode = ScreenMode::IrRepeat;
-                selectPressStartMs = 0;
-                irRepeatSender.draw();
-            }
+            swallowWakePress = false;
         }
+        return;
+    }
 
-        if (updated)
+    handleEdge(edge);
+    while (buttonInput.next(edge, 0))
+    {
+        handleEdge(edge);
+    }
+}
+
+// Screens built on frameBuffer.canvas(). The buffer is only allocated
+// while one of them is showing.
+static bool isBuffered(ScreenMode mode)
+{
+    switch (mode)
+    {
+        case ScreenMode::Editor:
+        case ScreenMode::IrBruteforce:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Switches screens. Whatever is still held was used by the switch, so
+// its release and hold timers must not act on the new screen.
+static void showScreen(ScreenMode mode)
+{
+    screenMode = mode;
+    gestures.suppressHeld();
+
+    if (isBuffered(mode))
+    {
+        frameBuffer.begin();
+        frameBuffer.invalidate();
+    }
+    else
+    {
+        frameBuffer.end();
+    }
+}
+
+static void showList()
+{
+    showScreen(ScreenMode::List);
+    list.draw();
+}
+
+// Press, then Repeat while held.
+static bool isStep(const GestureEvent& event)
+{
+    return event.type == GestureType::Press || event.type == GestureType::Repeat;
+}
+
+static bool isPress(const GestureEvent& event, uint8_t button)
+{
+    return event.type == GestureType::Press && event.button == button;
+}
+
+// Released before the long press fired.
+static bool isClick(const GestureEvent& event, uint8_t button)
+{
+    return event.type == GestureType::Release && event.button == button && !event.consumed;
+}
+
+static bool isLongPress(const GestureEvent& event, uint8_t button)
+{
+    return event.type == GestureType::LongPress && event.button == button;
+}
+
+static bool isUpDownChord(const GestureEvent& event)
+{
+    return event.type == GestureType::Chord &&
+           (event.button == kUp || event.button == kDown) &&
+           (event.other == kUp || event.other == kDown);
+}
+
+static void showLibraryProfile(size_t profile)
+{
+    libraryProfile.select(profile);
+    libraryRemote.setTitle(codeLibrary.available() ? libraryProfile.name() : "No code library");
+    libraryRemote.reset();
+    libraryRemote.draw();
+}
+
+static void handleList(const GestureEvent& event)
+{
+    if (isPress(event, kUp))
+    {
+        if (list.moveUp(true))
         {
-            list.draw();
+            list.update();
         }
     }
-    else if (screenMode == ScreenMode::Editor)
+    else if (isPress(event, kDown))
     {
-        uint32_t now = millis();
-        bool upState = (buttonUp.read() == Button::PRESSED);
-        bool upChanged = buttonUp.has_changed();
-
-        if (!upState)
+        if (list.moveDown(true))
         {
-            upPressStartMs = 0;
-            upLastRepeatMs = 0;
+            list.update();
         }
-        else if (upChanged)
+    }
+    else if (isPress(event, kSelect))
+    {
+        if (list.selectedIndex() == kBrightnessItemIndex)
         {
-            if (valueEditor.decrease())
-            {
-                screen.setBrightness(percentToBrightness(valueEditor.value()));
-                valueEditor.draw();
-            }
-            upPressStartMs = now;
-            upLastRepeatMs = now;
+            showScreen(ScreenMode::Editor);
+            valueEditor.draw();
         }
-        else if (upPressStartMs != 0 &&
-                 now - upPressStartMs >= kRepeatDelayMs &&
-                 now - upLastRepeatMs >= kRepeatIntervalMs)
+        else if (list.selectedIndex() == kLampRemoteItemIndex)
         {
-            if (valueEditor.decrease())
-            {
-                screen.setBrightness(percentToBrightness(valueEditor.value()));
-                valueEditor.draw();
-            }
-            upLastRepeatMs = now;
+            showScreen(ScreenMode::LampRemote);
+            lampRemote.draw();
         }
-
-        bool downState = (buttonDown.read() == Button::PRESSED);
-        bool downChanged = buttonDown.has_changed();
-
-        if (!downState)
+        else if (list.selectedIndex() == kIrBruteforceItemIndex)
         {
-            downPressStartMs = 0;
-            downLastRepeatMs = 0;
+            showScreen(ScreenMode::IrBruteforce);
+            irBruteforce.start();
         }
-        else if (downChanged)
+        else if (list.selectedIndex() == kIrSendItemIndex)
         {
-            if (valueEditor.increase())
-            {
-                screen.setBrightness(percentToBrightness(valueEditor.value()));
-                valueEditor.draw();
-            }
-            downPressStartMs = now;
-            downLastRepeatMs = now;
+            showScreen(ScreenMode::IrSend);
+            selectHeld = false;
+            irCodeSender.draw();
         }
-        else if (downPressStartMs != 0 &&
-                 now - downPressStartMs >= kRepeatDelayMs &&
-                 now - downLastRepeatMs >= kRepeatIntervalMs)
+        else if (list.selectedIndex() == kIrRepeatItemIndex)
         {
-            if (valueEditor.increase())
-            {
-                screen.setBrightness(percentToBrightness(valueEditor.value()));
-                valueEditor.draw();
-            }
-            downLastRepeatMs = now;
+            showScreen(ScreenMode::IrRepeat);
+            selectHeld = false;
+            irRepeatSender.draw();
         }
-
-        if (buttonSelect.pressed())
+        else if (list.selectedIndex() == kCodeLibraryItemIndex)
         {
-            screenMode = ScreenMode::List;
-            list.draw();
+            showScreen(ScreenMode::CodeLibrary);
+            selectHeld = false;
+            showLibraryProfile(libraryProfile.profile());
         }
     }
-    else if (screenMode == ScreenMode::IrBruteforce)
-    {
-        buttonUp.read();
-        buttonDown.read();
-
-        irBruteforce.tick();
+}
 
-        if (buttonSelect.pressed())
+static void handleEditor(const GestureEvent& event)
+{
+    // One 5% step per repeat; the range is short enough without speeding up.
+    if (isStep(event) && (event.button == kUp || event.button == kDown))
+    {
+        bool changed = (event.button == kUp) ? valueEditor.decrease() : valueEditor.increase();
+        if (changed)
         {
-            irBruteforce.stop();
-            screenMode = ScreenMode::List;
-            list.draw();
+            setScreenBrightness(percentToBrightness(valueEditor.value()));
+            valueEditor.draw();
         }
     }
-    else if (screenMode == ScreenMode::IrSend)
+    else if (isPress(event, kSelect))
     {
-        uint32_t now = millis();
-
-        // Up/down with hold-to-repeat
-        bool upState = (buttonUp.read() == Button::PRESSED);
-        bool upChanged = buttonUp.has_changed();
+        showList();
+    }
+}
 
-        if (!upState)
+static void handleIrBruteforce(const GestureEvent& event)
+{
+    if (irBruteforce.isPromptingResume())
+    {
+        if (isPress(event, kUp))
         {
-            upPressStartMs = 0;
-            upLastRepeatMs = 0;
+            irBruteforce.resumeSaved();
         }
-        else if (upChanged)
+        else if (isPress(event, kDown))
         {
-            irCodeSender.prev();
-            upPressStartMs = now;
-            upLastRepeatMs = now;
+            irBruteforce.restart();
         }
-        else if (upPressStartMs != 0 &&
-                 now - upPressStartMs >= kRepeatDelayMs &&
-                 now - upLastRepeatMs >= kRepeatIntervalMs)
+        else if (isPress(event, kSelect))
         {
-            irCodeSender.prev();
-            upLastRepeatMs = now;
+            irBruteforce.stop();
+            showList();
         }
-
-        bool downState = (buttonDown.read() == Button::PRESSED);
-        bool downChanged = buttonDown.has_changed();
-
-        if (!downState)
+    }
+    else if (irBruteforce.isEditingRange())
+    {
+        if (isStep(event) && event.button == kUp)
         {
-            downPressStartMs = 0;
-            downLastRepeatMs = 0;
+            irBruteforce.adjustRange(-static_cast<int>(event.steps));
         }
-        else if (downChanged)
+        else if (isStep(event) && event.button == kDown)
         {
-            irCodeSender.next();
-            downPressStartMs = now;
-            downLastRepeatMs = now;
+            irBruteforce.adjustRange(event.steps);
         }
-        else if (downPressStartMs != 0 &&
-                 now - downPressStartMs >= kRepeatDelayMs &&
-                 now - downLastRepeatMs >= kRepeatIntervalMs)
+        else if (isPress(event, kSelect))
         {
-            irCodeSender.next();
-            downLastRepeatMs = now;
+            irBruteforce.confirmRange();
         }
-
-        // Select: short press = send, hold 3s = back to menu
-        bool selectState = (buttonSelect.read() == Button::PRESSED);
-        bool selectChanged = buttonSelect.has_changed();
-
-        if (selectState && selectChanged)
+    }
+    else if (irBruteforce.isInSetup())
+    {
+        if (isPress(event, kUp))
         {
-            // Just pressed down
-            selectPressStartMs = now;
+            irBruteforce.moveSetupCursor(-1);
         }
-        else if (!selectState && selectChanged && selectPressStartMs != 0)
+        else if (isPress(event, kDown))
         {
-            // Released before long-press threshold -- send the code
-            if (now - selectPressStartMs < kLongPressMs)
-            {
-                irCodeSender.send();
-            }
-            selectPressStartMs = 0;
+            irBruteforce.moveSetupCursor(1);
         }
-        else if (selectState && selectPressStartMs != 0 &&
-                 now - selectPressStartMs >= kLongPressMs)
+        else if (isPress(event, kSelect))
         {
-            // Held long enough -- go back
-            selectPressStartMs = 0;
-            screenMode = ScreenMode::List;
-            list.draw();
+            if (irBruteforce.setupRow() == IrBruteforce::SetupRow::Back)
+            {
+                irBruteforce.stop();
+                showList();
+            }
+            else
+            {
+                irBruteforce.activateSetupRow();
+            }
         }
     }
-
-    else if (screenMode == ScreenMode::IrRepeat)
+    else if (irBruteforce.isBisecting())
     {
-        uint32_t now = millis();
-
-        // Up/down with hold-to-repeat for navigation
-        bool upState = (buttonUp.read() == Button::PRESSED);
-        bool upChanged = buttonUp.has_changed();
-
-        if (!upState)
+        // Select: short press = keep the half just replayed,
+        // hold 3s = give up and resume the sweep
+        if (isPress(event, kUp))
         {
-            upPressStartMs = 0;
-            upLastRepeatMs = 0;
+            irBruteforce.replay(IrHitBisector::Half::Lower);
         }
-        else if (upChanged)
+        else if (isPress(event, kDown))
         {
-            irRepeatSender.prev();
-            upPressStartMs = now;
-            upLastRepeatMs = now;
+            irBruteforce.replay(IrHitBisector::Half::Upper);
         }
-        else if (upPressStartMs != 0 &&
-                 now - upPressStartMs >= kRepeatDelayMs &&
-                 now - upLastRepeatMs >= kRepeatIntervalMs)
+        else if (isClick(event, kSelect))
         {
-            irRepeatSender.prev();
-            upLastRepeatMs = now;
+            irBruteforce.keepReplayed();
         }
-
-        bool downState = (buttonDown.read() == Button::PRESSED);
-        bool downChanged = buttonDown.has_changed();
-
-        if (!downState)
+        else if (isLongPress(event, kSelect))
         {
-            downPressStartMs = 0;
-            downLastRepeatMs = 0;
+            irBruteforce.resume();
         }
-        else if (downChanged)
+    }
+    else
+    {
+        if (isPress(event, kUp))
+        {
+            irBruteforce.markHit();
+        }
+        else if (isPress(event, kDown))
         {
-            irRepeatSender.next();
-            downPressStartMs = now;
-            downLastRepeatMs = now;
+            irBruteforce.setTurbo(!irBruteforce.turbo());
         }
-        else if (downPressStartMs != 0 &&
-                 now - downPressStartMs >= kRepeatDelayMs &&
-                 now - downLastRepeatMs >= kRepeatIntervalMs)
+        else if (isPress(event, kSelect))
         {
-            irRepeatSender.next();
-            downLastRepeatMs = now;
+            irBruteforce.stop();
+            showList();
         }
+    }
+}
 
-        // Auto-send tick
-        irRepeatSender.tick();
+// Select held, then Up or Down.
+static bool isSelectChord(const GestureEvent& event, uint8_t button)
+{
+    return event.type == GestureType::Chord && event.button == button && event.other == kSelect;
+}
+
+static void trackSelect(const GestureEvent& event)
+{
+    if (event.button == kSelect && (event.type == GestureType::Press || event.type == GestureType::Release))
+    {
+        selectHeld = event.type == GestureType::Press;
+    }
+}
 
-        // Select: short press = toggle sending, long hold = back
-        bool selectState = (buttonSelect.read() == Button::PRESSED);
-        bool selectChanged = buttonSelect.has_changed();
+static void handleIrSend(const GestureEvent& event)
+{
+    // Up/down move through codes: stepping (faster the longer they are
+    // held), one hex digit at a time or through recent codes.
+    // Select: short press = send (or next digit), with Up = how Up/down
+    // move, with Down = next protocol, hold 3s (or up+down) = back to menu
+    trackSelect(event);
 
-        if (selectState && selectChanged)
-        {
-            selectPressStartMs = now;
-        }
-        else if (!selectState && selectChanged && selectPressStartMs != 0)
+    if (isSelectChord(event, kUp))
+    {
+        irCodeSender.cycleEntry();
+    }
+    else if (isSelectChord(event, kDown))
+    {
+        irCodeSender.nextProtocol();
+    }
+    else if (isStep(event) && event.button == kUp && !selectHeld)
+    {
+        irCodeSender.prev(event.steps);
+    }
+    else if (isStep(event) && event.button == kDown && !selectHeld)
+    {
+        irCodeSender.next(event.steps);
+    }
+    else if (isClick(event, kSelect) && !irCodeSender.nextDigit())
+    {
+        irCodeSender.send();
+    }
+    else if (isLongPress(event, kSelect) || isUpDownChord(event))
+    {
+        showList();
+    }
+}
+
+static void handleIrRepeat(const GestureEvent& event)
+{
+    // Up/down move through codes as on the send screen.
+    // Select: short press = toggle sending (or next digit), with Up = how
+    // Up/down move, with Down = repeat codes or full frames, then the next
+    // protocol, hold 3s (or up+down) = back
+    trackSelect(event);
+
+    if (isSelectChord(event, kUp))
+    {
+        irRepeatSender.cycleEntry();
+    }
+    else if (isSelectChord(event, kDown))
+    {
+        irRepeatSender.nextMode();
+    }
+    else if (isStep(event) && event.button == kUp && !selectHeld)
+    {
+        irRepeatSender.prev(event.steps);
+    }
+    else if (isStep(event) && event.button == kDown && !selectHeld)
+    {
+        irRepeatSender.next(event.steps);
+    }
+    else if (isClick(event, kSelect) && !irRepeatSender.nextDigit())
+    {
+        if (irRepeatSender.isSending())
         {
-            if (now - selectPressStartMs < kLongPressMs)
-            {
-                // Toggle sending on/off
-                if (irRepeatSender.isSending())
-                {
-                    irRepeatSender.stopSending();
-                }
-                else
-                {
-                    irRepeatSender.startSending();
-                }
-            }
-            selectPressStartMs = 0;
+            irRepeatSender.stopSending();
         }
-        else if (selectState && selectPressStartMs != 0 &&
-                 now - selectPressStartMs >= kLongPressMs)
+        else
         {
-            irRepeatSender.stopSending();
-            selectPressStartMs = 0;
-            screenMode = ScreenMode::List;
-            list.draw();
+            irRepeatSender.startSending();
         }
     }
-    else if (screenMode == ScreenMode::LampRemote)
+    else if (isLongPress(event, kSelect) || isUpDownChord(event))
     {
-        uint32_t now = millis();
+        irRepeatSender.stopSending();
+        showList();
+    }
+}
 
-        buttonUp.read();
-        bool upChanged = buttonUp.has_changed();
-        if (buttonUp.read() == Button::PRESSED && upChanged)
+static void handleLampRemote(const GestureEvent& event)
+{
+    // Select: short press = send, hold 3s (or up+down) = back to menu
+    if (isPress(event, kUp))
+    {
+        if (lampRemote.moveUp(true))
         {
-            if (lampRemote.moveUp(true))
-            {
-                lampRemote.draw();
-            }
+            lampRemote.update();
         }
-
-        buttonDown.read();
-        bool downChanged = buttonDown.has_changed();
-        if (buttonDown.read() == Button::PRESSED && downChanged)
+    }
+    else if (isPress(event, kDown))
+    {
+        if (lampRemote.moveDown(true))
         {
-            if (lampRemote.moveDown(true))
-            {
-                lampRemote.draw();
-            }
+            lampRemote.update();
         }
+    }
+    else if (isClick(event, kSelect))
+    {
+        lampRemote.sendSelected();
+    }
+    else if (isLongPress(event, kSelect) || isUpDownChord(event))
+    {
+        showList();
+    }
+}
 
-        // Select: short press = send, hold 3s = back to menu
-        bool selectState = (buttonSelect.read() == Button::PRESSED);
-        bool selectChanged = buttonSelect.has_changed();
+static void handleCodeLibrary(const GestureEvent& event)
+{
+    // Up/down move through the profile's commands.
+    // Select: short press = send, with Up/Down = previous/next profile,
+    // hold 3s (or up+down) = back to menu
+    trackSelect(event);
 
-        if (selectState && selectChanged)
-        {
-            selectPressStartMs = now;
-        }
-        else if (!selectState && selectChanged && selectPressStartMs != 0)
+    size_t profiles = codeLibrary.profileCount();
+    if (isSelectChord(event, kUp) && profiles != 0)
+    {
+        showLibraryProfile((libraryProfile.profile() + profiles - 1) % profiles);
+    }
+    else if (isSelectChord(event, kDown) && profiles != 0)
+    {
+        showLibraryProfile((libraryProfile.profile() + 1) % profiles);
+    }
+    else if (isStep(event) && event.button == kUp && !selectHeld)
+    {
+        if (libraryRemote.moveUp(true))
         {
-            if (now - selectPressStartMs < kLongPressMs)
-            {
-                lampRemote.sendSelected();
-            }
-            selectPressStartMs = 0;
+            libraryRemote.update();
         }
-        else if (selectState && selectPressStartMs != 0 &&
-                 now - selectPressStartMs >= kLongPressMs)
+    }
+    else if (isStep(event) && event.button == kDown && !selectHeld)
+    {
+        if (libraryRemote.moveDown(true))
         {
-            selectPressStartMs = 0;
-            screenMode = ScreenMode::List;
-            list.draw();
+            libraryRemote.update();
         }
     }
+    else if (isClick(event, kSelect))
+    {
+        libraryRemote.sendSelected();
+    }
+    else if (isLongPress(event, kSelect) || isUpDownChord(event))
+    {
+        showList();
+    }
+}
+
+static void handleGesture(const GestureEvent& event)
+{
+    switch (screenMode)
+    {
+        case ScreenMode::List:
+            handleList(event);
+            break;
+
+        case ScreenMode::Editor:
+            handleEditor(event);
+            break;
+
+        case ScreenMode::IrBruteforce:
+            handleIrBruteforce(event);
+            break;
+
+        case ScreenMode::IrSend:
+            handleIrSend(event);
+            break;
+
+        case ScreenMode::IrRepeat:
+            handleIrRepeat(event);
+            break;
+
+        case ScreenMode::LampRemote:
+            handleLampRemote(event);
+            break;
+
+        case ScreenMode::CodeLibrary:
+            handleCodeLibrary(event);
+            break;
+    }
+}
+
+void setup()
+{
+    screen.init();
+    screen.setRotation(3);
+    setScreenBrightness(128);
+
+    if (glyphAtlas.begin())
+    {
+        TextField::setGlyphAtlas(&glyphAtlas);
+    }
+
+    buttonUp.begin();
+    buttonDown.begin();
+    buttonSelect.begin();
+    buttonInput.begin();
+    gestures.setRepeat(kRepeatDelayMs, kRepeatIntervalMs);
+    gestures.setLongPressMs(kLongPressMs);
+    lastInputMs = millis();
+
+    irHasTask = irTransmitter.begin() && irTransmitter.startTask(kIrCore);
+    codeLibrary.begin();
+
+    valueEditor.setLabel("Brightness");
+    valueEditor.setSuffix("%");
+    valueEditor.setRange(0, 100);
+    valueEditor.setStep(5);
+    valueEditor.setValue(50);
+
+    list.draw();
+}
+
+void loop()
+{
+    if (!irHasTask)
+    {
+        irTransmitter.tick();
+    }
+
+    gestures.tick(millis());
+
+    // Drawing below may touch the canvas the last present() is sending.
+    frameBuffer.waitPresented();
+
+    GestureEvent event;
+    while (gestures.poll(event))
+    {
+        handleGesture(event);
+    }
+
+    if (screenMode == ScreenMode::IrBruteforce)
+    {
+        irBruteforce.tick();
+    }
+    else if (screenMode == ScreenMode::IrRepeat)
+    {
+        // Auto-send tick
+        irRepeatSender.tick();
+    }
+
+    if (isBuffered(screenMode))
+    {
+        frameBuffer.present();
+    }
 
-    delay(10);
+    waitForInput();
 }
@@ -0,0 +1,117 @@
+// Button debouncing of timestamped edges, including across the point
+// where millis() wraps.
+//
+//   pio test -e native -f test_button
+
+#include <Arduino.h>
+#include <Button.h>
+#include <unity.h>
+
+namespace
+{
+
+constexpr uint8_t kPin = 37;
+constexpr uint16_t kDebounceMs = 50;
+
+Button* button;
+
+// Moves the virtual clock on to `ms`, for the calls that read millis().
+void advanceToMs(uint32_t ms)
+{
+    nativeAdvanceMicros(ms * 1000 - micros());
+}
+
+} // namespace
+
+void setUp()
+{
+    nativeUseVirtualClock(0);
+    nativeSetPin(kPin, HIGH);
+    button = new Button(kPin, kDebounceMs);
+    button->begin();
+}
+
+void tearDown()
+{
+    delete button;
+}
+
+void test_bounce_inside_window_is_ignored()
+{
+    button->on_edge(Button::PRESSED, 1000);
+    TEST_ASSERT_TRUE(button->has_changed());
+
+    button->on_edge(Button::RELEASED, 1010);
+    TEST_ASSERT_FALSE(button->has_changed());
+    TEST_ASSERT_TRUE(button->settling());
+
+    button->on_edge(Button::PRESSED, 1020);
+    TEST_ASSERT_FALSE(button->has_changed());
+    TEST_ASSERT_FALSE(button->settling());
+}
+
+void test_pending_bounce_settles_on_read()
+{
+    advanceToMs(1000);
+    button->on_edge(Button::PRESSED, 1000);
+    button->has_changed();
+    button->on_edge(Button::RELEASED, 1010);
+
+    advanceToMs(1000 + kDebounceMs - 1);
+    TEST_ASSERT_EQUAL(Button::PRESSED, button->read());
+
+    advanceToMs(1000 + kDebounceMs);
+    TEST_ASSERT_EQUAL(Button::RELEASED, button->read());
+    TEST_ASSERT_TRUE(button->has_changed());
+    TEST_ASSERT_FALSE(button->settling());
+}
+
+void test_debounce_across_millis_wrap()
+{
+    button->on_edge(Button::PRESSED, 1000);
+    button->on_edge(Button::RELEASED, 2000);
+    button->has_changed();
+
+    // Pressed 20 ms before the wrap. Once the window end (29 ms after it)
+    // no longer fits in 32 bits, a bounce must still count as early,
+    // both before and after the wrap.
+    const uint32_t pressMs = UINT32_MAX - 20;
+    button->on_edge(Button::PRESSED, pressMs);
+    TEST_ASSERT_TRUE(button->has_changed());
+
+    button->on_edge(Button::RELEASED, pressMs + 10);
+    TEST_ASSERT_FALSE(button->has_changed());
+    TEST_ASSERT_TRUE(button->settling());
+
+    button->on_edge(Button::RELEASED, 5);
+    TEST_ASSERT_FALSE(button->has_changed());
+
+    // 61 ms after the press, across the wrap.
+    button->on_edge(Button::RELEASED, 40);
+    TEST_ASSERT_TRUE(button->has_changed());
+    TEST_ASSERT_FALSE(button->settling());
+
+    advanceToMs(100);
+    TEST_ASSERT_EQUAL(Button::RELEASED, button->read());
+    TEST_ASSERT_FALSE(button->has_changed());
+}
+
+void test_short_tap_is_pressed_once()
+{
+    advanceToMs(2000);
+    button->on_edge(Button::PRESSED, 1000);
+    button->on_edge(Button::RELEASED, 1100);
+
+    TEST_ASSERT_TRUE(button->pressed());
+    TEST_ASSERT_FALSE(button->pressed());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bounce_inside_window_is_ignored);
+    RUN_TEST(test_pending_bounce_settles_on_read);
+    RUN_TEST(test_debounce_across_millis_wrap);
+    RUN_TEST(test_short_tap_is_pressed_once);
+    return UNITY_END();
+}
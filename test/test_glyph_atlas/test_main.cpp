@@ -0,0 +1,121 @@
+// GlyphAtlas blits against print() into an M5Canvas: the same pixels,
+// in the byte order the sprite keeps, for colours whose two bytes differ.
+//
+//   pio test -e native -f test_glyph_atlas
+
+#include <Arduino.h>
+#include <GlyphAtlas.h>
+#include <M5GFX.h>
+#include <unity.h>
+
+namespace
+{
+
+constexpr int kCellWidth = GlyphAtlas::kGlyphWidth * GlyphAtlas::kMaxTextSize;
+constexpr int kCellHeight = GlyphAtlas::kGlyphHeight * GlyphAtlas::kMaxTextSize;
+
+GlyphAtlas* atlas;
+M5Canvas* printed;
+M5Canvas* blitted;
+
+const uint16_t* pixels(const M5Canvas& canvas)
+{
+    return static_cast<const uint16_t*>(canvas.getBuffer());
+}
+
+void printCell(char c, uint8_t textSize, uint16_t color, uint16_t background)
+{
+    printed->fillScreen(TFT_BLACK);
+    printed->setTextSize(textSize);
+    printed->setTextColor(color, background);
+    printed->setCursor(0, 0);
+    printed->print(c);
+}
+
+void blitCell(char c, uint8_t textSize, uint16_t color, uint16_t background)
+{
+    blitted->fillScreen(TFT_BLACK);
+    TEST_ASSERT_TRUE(atlas->draw(*blitted, 0, 0, c, textSize, color, background));
+}
+
+} // namespace
+
+void setUp()
+{
+    atlas = new GlyphAtlas();
+    TEST_ASSERT_TRUE(atlas->begin());
+    printed = new M5Canvas();
+    blitted = new M5Canvas();
+    TEST_ASSERT_NOT_NULL(printed->createSprite(kCellWidth, kCellHeight));
+    TEST_ASSERT_NOT_NULL(blitted->createSprite(kCellWidth, kCellHeight));
+}
+
+void tearDown()
+{
+    delete blitted;
+    delete printed;
+    delete atlas;
+}
+
+void test_blit_matches_print_at_text_size_one()
+{
+    const uint16_t colors[][2] = {
+        {TFT_GREEN, TFT_DARKGREY},
+        {TFT_ORANGE, TFT_NAVY},
+        {TFT_WHITE, TFT_BLACK},
+    };
+    const char* text = "07AF:x";
+
+    for (const uint16_t* pair : colors)
+    {
+        for (const char* c = text; *c != '\0'; ++c)
+        {
+            printCell(*c, 1, pair[0], pair[1]);
+            blitCell(*c, 1, pair[0], pair[1]);
+            for (int i = 0; i < kCellWidth * kCellHeight; ++i)
+            {
+                TEST_ASSERT_EQUAL_HEX32_MESSAGE(pixels(*printed)[i], pixels(*blitted)[i], "pixel differs");
+            }
+        }
+    }
+}
+
+void test_scaled_blit_uses_printed_colours()
+{
+    // At larger sizes the stand-in's strokes are not the scaled font, so
+    // only the colours can be compared: the blit uses exactly the two
+    // values print() leaves in the sprite.
+    printCell('8', 3, TFT_GREEN, TFT_DARKGREY);
+    blitCell('8', 3, TFT_GREEN, TFT_DARKGREY);
+
+    uint16_t on = 0;
+    uint16_t off = pixels(*printed)[0];
+    for (int i = 0; i < kCellWidth * kCellHeight; ++i)
+    {
+        if (pixels(*printed)[i] != off)
+        {
+            on = pixels(*printed)[i];
+        }
+    }
+    TEST_ASSERT_TRUE(on != off);
+
+    bool sawOn = false;
+    bool sawOff = false;
+    for (int i = 0; i < kCellWidth * kCellHeight; ++i)
+    {
+        uint16_t pixel = pixels(*blitted)[i];
+        TEST_ASSERT_TRUE(pixel == on || pixel == off);
+        sawOn = sawOn || pixel == on;
+        sawOff = sawOff || pixel == off;
+    }
+    TEST_ASSERT_TRUE(sawOn);
+    TEST_ASSERT_TRUE(sawOff);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_blit_matches_print_at_text_size_one);
+    RUN_TEST(test_scaled_blit_uses_printed_colours);
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+// IrTransmitter queue behaviour against the fake RMT driver on a virtual
+// clock: frames leave in the order they were queued, repeats finish
+// before the next frame, and clear() drops only what has not started.
+//
+//   pio test -e native -f test_ir_transmitter
+
+#include <Arduino.h>
+#include <IrNecEncoder.h>
+#include <IrTransmitter.h>
+#include <IrWaveformCheck.h>
+#include <unity.h>
+
+namespace
+{
+
+constexpr uint8_t kPin = 19;
+constexpr uint32_t kTickUs = 1000;
+
+IrTransmitter* transmitter;
+
+// The 32 bits an NEC frame for address/command carries, MSB first.
+uint32_t necData(uint8_t address, uint8_t command)
+{
+    return (static_cast<uint32_t>(address) << 24) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(~address)) << 16) |
+           (static_cast<uint32_t>(command) << 8) |
+           static_cast<uint8_t>(~command);
+}
+
+// Ticks every kTickUs until the queue has drained. Returns false if it
+// never does.
+bool runUntilIdle()
+{
+    for (int i = 0; i < 10000; ++i)
+    {
+        transmitter->tick();
+        if (transmitter->isIdle())
+        {
+            return true;
+        }
+        nativeAdvanceMicros(kTickUs);
+    }
+    return false;
+}
+
+void expectNecFrame(size_t index, uint8_t address, uint8_t command)
+{
+    IrFrameCheck check = irCheckFrame(transmitter->driver().capture(index), kIrNecSpec);
+    TEST_ASSERT_TRUE_MESSAGE(check.ok, check.error);
+    TEST_ASSERT_EQUAL_HEX32(necData(address, command), check.data);
+}
+
+} // namespace
+
+void setUp()
+{
+    nativeUseVirtualClock(1000000);
+    transmitter = new IrTransmitter(kPin);
+    transmitter->begin();
+    transmitter->driver().setAutoFinish(true);
+}
+
+void tearDown()
+{
+    delete transmitter;
+}
+
+void test_frames_leave_in_queue_order()
+{
+    const uint8_t commands[] = {0x10, 0x20, 0x01, 0xFE, 0x7F};
+    for (uint8_t command : commands)
+    {
+        TEST_ASSERT_TRUE(transmitter->sendNEC(0x04, command));
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, transmitter->pending());
+
+    TEST_ASSERT_TRUE(runUntilIdle());
+    IrRmtDriver& driver = transmitter->driver();
+    TEST_ASSERT_EQUAL_UINT32(5, driver.framesWritten());
+    TEST_ASSERT_EQUAL_UINT32(5, transmitter->framesSent());
+    for (size_t i = 0; i < 5; ++i)
+    {
+        expectNecFrame(i, 0x04, commands[i]);
+        if (i > 0)
+        {
+            uint32_t periodUs = driver.capture(i).startUs - driver.capture(i - 1).startUs;
+            TEST_ASSERT_GREATER_THAN(kNecPeriodUs - 1, periodUs);
+            TEST_ASSERT_LESS_THAN(kNecPeriodUs + kTickUs + 1, periodUs);
+        }
+    }
+}
+
+void test_full_queue_refuses_until_a_slot_is_released()
+{
+    for (size_t i = 0; i < IrTransmitter::kQueueDepth; ++i)
+    {
+        TEST_ASSERT_TRUE(transmitter->sendNEC(0x00, static_cast<uint8_t>(i)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, transmitter->freeSlots());
+    TEST_ASSERT_FALSE(transmitter->sendNEC(0x00, 0xAA));
+    TEST_ASSERT_NULL(transmitter->reserve());
+
+    // The frame on the wire keeps its slot until it has gone out.
+    transmitter->tick();
+    TEST_ASSERT_FALSE(transmitter->sendNEC(0x00, 0xAA));
+
+    nativeAdvanceMicros(kNecPeriodUs);
+    transmitter->tick();
+    TEST_ASSERT_TRUE(transmitter->sendNEC(0x00, 0xAA));
+
+    TEST_ASSERT_TRUE(runUntilIdle());
+    TEST_ASSERT_EQUAL_UINT32(IrTransmitter::kQueueDepth + 1, transmitter->driver().framesWritten());
+    for (size_t i = 0; i < IrTransmitter::kQueueDepth; ++i)
+    {
+        expectNecFrame(i, 0x00, static_cast<uint8_t>(i));
+    }
+    expectNecFrame(IrTransmitter::kQueueDepth, 0x00, 0xAA);
+}
+
+void test_repeats_finish_before_the_next_frame()
+{
+    IrFrame* frame = transmitter->reserve();
+    TEST_ASSERT_NOT_NULL(frame);
+    IrNecEncoder::encode(0x01, 0x11, *frame);
+    frame->repeats = 2;
+    transmitter->commit();
+    transmitter->sendNEC(0x01, 0x22);
+
+    TEST_ASSERT_TRUE(runUntilIdle());
+    TEST_ASSERT_EQUAL_UINT32(4, transmitter->driver().framesWritten());
+    expectNecFrame(0, 0x01, 0x11);
+    expectNecFrame(1, 0x01, 0x11);
+    expectNecFrame(2, 0x01, 0x11);
+    expectNecFrame(3, 0x01, 0x22);
+    TEST_ASSERT_EQUAL_UINT32(2, transmitter->framesSent());
+}
+
+void test_clear_drops_only_frames_not_started()
+{
+    transmitter->sendNEC(0x02, 0x01);
+    transmitter->sendNEC(0x02, 0x02);
+    transmitter->sendNEC(0x02, 0x03);
+    transmitter->tick();
+
+    TEST_ASSERT_EQUAL_UINT32(2, transmitter->clear());
+    TEST_ASSERT_EQUAL_UINT32(1, transmitter->pending());
+
+    // Later frames queue behind the one still on the wire.
+    transmitter->sendNEC(0x02, 0x04);
+    TEST_ASSERT_TRUE(runUntilIdle());
+    TEST_ASSERT_EQUAL_UINT32(2, transmitter->driver().framesWritten());
+    expectNecFrame(0, 0x02, 0x01);
+    expectNecFrame(1, 0x02, 0x04);
+}
+
+void test_empty_frame_is_dropped()
+{
+    IrFrame* frame = transmitter->reserve();
+    IrNecEncoder::encode(0x03, 0x01, *frame);
+    frame->count = 0;
+    transmitter->commit();
+    transmitter->sendNEC(0x03, 0x02);
+
+    TEST_ASSERT_TRUE(runUntilIdle());
+    TEST_ASSERT_EQUAL_UINT32(1, transmitter->driver().framesWritten());
+    expectNecFrame(0, 0x03, 0x02);
+    TEST_ASSERT_EQUAL_UINT32(1, transmitter->framesSent());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_frames_leave_in_queue_order);
+    RUN_TEST(test_full_queue_refuses_until_a_slot_is_released);
+    RUN_TEST(test_repeats_finish_before_the_next_frame);
+    RUN_TEST(test_clear_drops_only_frames_not_started);
+    RUN_TEST(test_empty_frame_is_dropped);
+    return UNITY_END();
+}
@@ -0,0 +1,182 @@
+// The table-driven NEC encoder against a frame built one bit at a time
+// from the NEC timings, directly and through irEncodeBatch.
+//
+//   pio test -e native -f test_nec_encoder
+
+#include <Arduino.h>
+#include <IrFrame.h>
+#include <IrNecEncoder.h>
+#include <IrProtocols.h>
+#include <IrTransmitter.h>
+#include <unity.h>
+
+namespace
+{
+
+// Both ends of each byte, both bit orders, and a complement pair.
+const IrCode kCodes[] = {
+    {0x00, 0x00}, {0xFF, 0xFF}, {0x04, 0x08}, {0xA5, 0x5A}, {0x80, 0x01}, {0x01, 0x80},
+};
+const IrCode kExtendedCodes[] = {
+    {0x1234, 0x56}, {0x00FF, 0x00}, {0xFF00, 0xFF}, {0xABCD, 0xEF}, {0x0000, 0x01}, {0xFFFF, 0x7E},
+};
+constexpr size_t kCodeCount = sizeof(kCodes) / sizeof(kCodes[0]);
+constexpr size_t kExtendedCodeCount = sizeof(kExtendedCodes) / sizeof(kExtendedCodes[0]);
+
+// The wire bytes, MSB first, as marks and spaces.
+void referenceFrame(uint8_t first, uint8_t second, uint8_t command, IrFrame& frame)
+{
+    const uint8_t bytes[] = {first, second, command, static_cast<uint8_t>(~command)};
+
+    IrFrameBuilder builder(frame);
+    builder.mark(kNecHdrMarkUs);
+    builder.space(kNecHdrSpaceUs);
+    for (uint8_t value : bytes)
+    {
+        for (int bit = 7; bit >= 0; --bit)
+        {
+            builder.mark(kNecBitMarkUs);
+            builder.space(((value >> bit) & 1) ? kNecOneSpaceUs : kNecZeroSpaceUs);
+        }
+    }
+    builder.mark(kNecBitMarkUs);
+    builder.finish();
+}
+
+void referenceNec(const IrCode& code, IrFrame& frame)
+{
+    uint8_t address = static_cast<uint8_t>(code.address);
+    referenceFrame(address, static_cast<uint8_t>(~address), static_cast<uint8_t>(code.command), frame);
+}
+
+void referenceNecExtended(const IrCode& code, IrFrame& frame)
+{
+    referenceFrame(static_cast<uint8_t>(code.address >> 8), static_cast<uint8_t>(code.address),
+                   static_cast<uint8_t>(code.command), frame);
+}
+
+void expectItems(const IrFrame& expected, const IrItem* items, size_t count)
+{
+    TEST_ASSERT_EQUAL_UINT32(expected.count, count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(expected.items[i].val, items[i].val, "item differs");
+    }
+}
+
+void expectFrame(const IrFrame& expected, const IrFrame& frame)
+{
+    TEST_ASSERT_EQUAL_UINT32(kNecFrameItems, frame.count);
+    expectItems(expected, frame.items, frame.count);
+    TEST_ASSERT_EQUAL_UINT32(expected.durationUs, frame.durationUs);
+    TEST_ASSERT_EQUAL_UINT32(kNecCarrierHz, frame.carrierHz);
+    TEST_ASSERT_EQUAL_UINT32(kNecMinGapUs, frame.gapUs);
+    TEST_ASSERT_EQUAL_UINT8(0, frame.repeats);
+}
+
+// Queues the codes with irEncodeBatch and checks what reaches the driver.
+template <typename Protocol>
+void expectBatch(const IrCode* codes, size_t count, void (*reference)(const IrCode&, IrFrame&))
+{
+    nativeUseVirtualClock(1000000);
+    IrTransmitter transmitter(19);
+    transmitter.begin();
+    transmitter.driver().setAutoFinish(true);
+
+    TEST_ASSERT_EQUAL_UINT32(count, irEncodeBatch<Protocol>(codes, count, transmitter, IrPacing::MinimumGap));
+    for (int i = 0; i < 10000 && !transmitter.isIdle(); ++i)
+    {
+        transmitter.tick();
+        nativeAdvanceMicros(1000);
+    }
+
+    IrRmtDriver& driver = transmitter.driver();
+    TEST_ASSERT_EQUAL_UINT32(count, driver.framesWritten());
+    for (size_t i = 0; i < count; ++i)
+    {
+        IrFrame expected;
+        reference(codes[i], expected);
+        const IrCapturedFrame& capture = driver.capture(i);
+        expectItems(expected, capture.items.data(), capture.items.size());
+        TEST_ASSERT_EQUAL_UINT32(expected.durationUs, capture.durationUs);
+        TEST_ASSERT_EQUAL_UINT32(kNecCarrierHz, capture.carrierHz);
+    }
+}
+
+} // namespace
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_reference_frame_layout()
+{
+    // Header, 32 bits, stop bit ending on the zero space that ends the
+    // RMT transfer.
+    IrFrame frame;
+    referenceNec(IrCode{0x00, 0x00}, frame);
+    TEST_ASSERT_EQUAL_UINT32(kNecFrameItems, frame.count);
+    TEST_ASSERT_EQUAL_UINT32(kNecHdrMarkUs, irItemMarkUs(frame.items[0]));
+    TEST_ASSERT_EQUAL_UINT32(kNecHdrSpaceUs, irItemSpaceUs(frame.items[0]));
+    TEST_ASSERT_EQUAL_UINT32(kNecBitMarkUs, irItemMarkUs(frame.items[kNecFrameItems - 1]));
+    TEST_ASSERT_EQUAL_UINT32(0, irItemSpaceUs(frame.items[kNecFrameItems - 1]));
+}
+
+void test_encode_matches_reference()
+{
+    for (const IrCode& code : kCodes)
+    {
+        IrFrame expected;
+        IrFrame frame;
+        referenceNec(code, expected);
+        IrNecEncoder::encode(static_cast<uint8_t>(code.address), static_cast<uint8_t>(code.command), frame);
+        expectFrame(expected, frame);
+        TEST_ASSERT_EQUAL_UINT32(kNecPeriodUs, frame.periodUs);
+    }
+}
+
+void test_encode_extended_matches_reference()
+{
+    for (const IrCode& code : kExtendedCodes)
+    {
+        IrFrame expected;
+        IrFrame frame;
+        referenceNecExtended(code, expected);
+        IrNecEncoder::encodeExtended(code.address, static_cast<uint8_t>(code.command), frame);
+        expectFrame(expected, frame);
+    }
+}
+
+void test_minimum_gap_pacing_drops_the_period()
+{
+    IrFrame frame;
+    IrNecEncoder::encode(0x04, 0x08, frame, IrPacing::MinimumGap);
+    TEST_ASSERT_EQUAL_UINT32(0, frame.periodUs);
+    TEST_ASSERT_EQUAL_UINT32(kNecMinGapUs, frame.gapUs);
+}
+
+void test_batch_nec_matches_reference()
+{
+    expectBatch<IrProtocolNec>(kCodes, kCodeCount, referenceNec);
+}
+
+void test_batch_nec_extended_matches_reference()
+{
+    expectBatch<IrProtocolNecExtended>(kExtendedCodes, kExtendedCodeCount, referenceNecExtended);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_reference_frame_layout);
+    RUN_TEST(test_encode_matches_reference);
+    RUN_TEST(test_encode_extended_matches_reference);
+    RUN_TEST(test_minimum_gap_pacing_drops_the_period);
+    RUN_TEST(test_batch_nec_matches_reference);
+    RUN_TEST(test_batch_nec_extended_matches_reference);
+    return UNITY_END();
+}
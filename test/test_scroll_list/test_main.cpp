@@ -0,0 +1,217 @@
+// ScrollList selection, scrolling and what each update() repaints.
+//
+//   pio test -e native -f test_scroll_list
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <ScrollList.h>
+#include <unity.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// A 240x135 screen that remembers every fill and the text printed at
+// each cursor row, so a test can see which list rows were repainted.
+class RecordingScreen : public lgfx::LovyanGFX
+{
+  public:
+    struct Fill
+    {
+        int32_t x;
+        int32_t y;
+        int32_t w;
+        int32_t h;
+        uint16_t color;
+    };
+
+    int32_t width() const override
+    {
+        return 240;
+    }
+
+    int32_t height() const override
+    {
+        return 135;
+    }
+
+    void forget()
+    {
+        fills.clear();
+        glyphs.clear();
+        resetStats();
+    }
+
+    // Text whose glyphs start at row y, in the order they were drawn.
+    std::string textAt(int32_t y) const
+    {
+        std::string text;
+        for (const Glyph& glyph : glyphs)
+        {
+            if (glyph.y == y)
+            {
+                text += glyph.c;
+            }
+        }
+        return text;
+    }
+
+    std::vector<Fill> fills;
+
+  protected:
+    void paint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override
+    {
+        fills.push_back(Fill{x, y, w, h, color});
+    }
+
+    void paintGlyph(int32_t x, int32_t y, int32_t w, int32_t h, char c) override
+    {
+        glyphs.push_back(Glyph{y, c});
+    }
+
+    void paintImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, int32_t stride) override
+    {
+    }
+
+  private:
+    struct Glyph
+    {
+        int32_t y;
+        char c;
+    };
+
+    std::vector<Glyph> glyphs;
+};
+
+const char* const kItems[] = {"Alpha", "Bravo", "Charlie", "Delta", "Echo",
+                              "Foxtrot", "Golf", "Hotel", "India", "Juliet"};
+constexpr size_t kItemCount = sizeof(kItems) / sizeof(kItems[0]);
+
+// (135 - 8 - 4) / 20 = 6 rows on screen.
+constexpr int kListTop = 8;
+constexpr int kLineHeight = 20;
+constexpr int kVisibleRows = 6;
+
+int rowY(int row)
+{
+    return kListTop + row * kLineHeight;
+}
+
+RecordingScreen* screen;
+ScrollList* list;
+
+} // namespace
+
+void setUp()
+{
+    screen = new RecordingScreen();
+    list = new ScrollList(*screen, kItems, kItemCount);
+    list->setLayout(kListTop, 8, kLineHeight, 2, 4);
+    list->setColors(TFT_WHITE, TFT_BLACK, TFT_DARKGREY, TFT_BLACK);
+}
+
+void tearDown()
+{
+    delete list;
+    delete screen;
+}
+
+void test_draw_paints_visible_rows()
+{
+    list->draw();
+
+    TEST_ASSERT_EQUAL_STRING("Alpha", screen->textAt(rowY(0)).c_str());
+    TEST_ASSERT_EQUAL_STRING("Foxtrot", screen->textAt(rowY(kVisibleRows - 1)).c_str());
+    TEST_ASSERT_EQUAL_STRING("", screen->textAt(rowY(kVisibleRows)).c_str());
+}
+
+void test_move_stops_or_wraps_at_ends()
+{
+    TEST_ASSERT_FALSE(list->moveUp(false));
+    TEST_ASSERT_EQUAL_INT(0, list->selectedIndex());
+
+    TEST_ASSERT_TRUE(list->moveUp(true));
+    TEST_ASSERT_EQUAL_INT(kItemCount - 1, list->selectedIndex());
+
+    TEST_ASSERT_FALSE(list->moveDown(false));
+    TEST_ASSERT_TRUE(list->moveDown(true));
+    TEST_ASSERT_EQUAL_INT(0, list->selectedIndex());
+}
+
+void test_update_without_scroll_repaints_two_rows()
+{
+    list->draw();
+    screen->forget();
+
+    list->moveDown(false);
+    list->update();
+
+    // The old row back to normal, the new one highlighted: one fill each
+    // and nothing else on screen touched.
+    TEST_ASSERT_EQUAL_UINT32(2, screen->fills.size());
+    TEST_ASSERT_EQUAL_UINT16(TFT_BLACK, screen->fills[0].color);
+    TEST_ASSERT_EQUAL_UINT16(TFT_DARKGREY, screen->fills[1].color);
+    TEST_ASSERT_EQUAL_STRING("Alpha", screen->textAt(rowY(0)).c_str());
+    TEST_ASSERT_EQUAL_STRING("Bravo", screen->textAt(rowY(1)).c_str());
+    TEST_ASSERT_EQUAL_STRING("", screen->textAt(rowY(2)).c_str());
+}
+
+void test_update_after_scroll_repaints_rows_in_place()
+{
+    list->draw();
+    for (int i = 0; i < kVisibleRows; ++i)
+    {
+        list->moveDown(false);
+    }
+    screen->forget();
+    list->update();
+
+    // One row scrolled off the top: every row shows the next item, and
+    // the screen is not cleared first.
+    TEST_ASSERT_EQUAL_UINT32(kVisibleRows, screen->fills.size());
+    TEST_ASSERT_EQUAL_STRING("Bravo", screen->textAt(rowY(0)).c_str());
+    TEST_ASSERT_EQUAL_STRING("Golf", screen->textAt(rowY(kVisibleRows - 1)).c_str());
+    for (const RecordingScreen::Fill& fill : screen->fills)
+    {
+        TEST_ASSERT_LESS_OR_EQUAL(kLineHeight, fill.h);
+    }
+}
+
+void test_update_without_change_paints_nothing()
+{
+    list->draw();
+    screen->forget();
+
+    list->update();
+    TEST_ASSERT_EQUAL_UINT32(0, screen->fills.size());
+
+    // A move that fails changes nothing either.
+    list->moveUp(false);
+    list->update();
+    TEST_ASSERT_EQUAL_UINT32(0, screen->fills.size());
+}
+
+void test_wrap_to_end_scrolls_to_last_page()
+{
+    list->draw();
+    list->moveUp(true);
+    screen->forget();
+    list->update();
+
+    TEST_ASSERT_EQUAL_STRING("Echo", screen->textAt(rowY(0)).c_str());
+    TEST_ASSERT_EQUAL_STRING("Juliet", screen->textAt(rowY(kVisibleRows - 1)).c_str());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_draw_paints_visible_rows);
+    RUN_TEST(test_move_stops_or_wraps_at_ends);
+    RUN_TEST(test_update_without_scroll_repaints_two_rows);
+    RUN_TEST(test_update_after_scroll_repaints_rows_in_place);
+    RUN_TEST(test_update_without_change_paints_nothing);
+    RUN_TEST(test_wrap_to_end_scrolls_to_last_page);
+    return UNITY_END();
+}
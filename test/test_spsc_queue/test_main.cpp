@@ -0,0 +1,206 @@
+// SpscQueue semantics, then a producer and a consumer thread hammering a
+// small ring: every item arrives intact and in order or was cancelled,
+// and nothing is lost or seen twice.
+//
+//   pio test -e native -f test_spsc_queue
+//
+// For the memory ordering to be checked rather than just exercised, run
+// it under ThreadSanitizer:
+//
+//   PLATFORMIO_BUILD_FLAGS="-fsanitize=thread" pio test -e native -f test_spsc_queue
+
+#include <SpscQueue.h>
+#include <unity.h>
+
+#include <atomic>
+#include <stdint.h>
+#include <thread>
+
+namespace
+{
+
+struct Item
+{
+    uint64_t seq;
+    uint64_t check; // ~seq, so a torn or stale slot shows
+};
+
+constexpr size_t kDepth = 8;
+constexpr uint64_t kStressItems = 20000000;
+constexpr uint64_t kCancelEvery = 4099; // prime, so it drifts against the ring
+constexpr uint64_t kHoldEvery = 127;
+
+} // namespace
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void test_reserve_commit_claim_release()
+{
+    SpscQueue<int, 4> queue;
+    TEST_ASSERT_NULL(queue.claim());
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int* slot = queue.reserve();
+        TEST_ASSERT_NOT_NULL(slot);
+        *slot = i;
+        queue.commit();
+    }
+    TEST_ASSERT_NULL(queue.reserve());
+    TEST_ASSERT_EQUAL_UINT32(4, queue.waiting());
+
+    // A held item is returned again until released, and keeps its slot.
+    int* held = queue.claim();
+    TEST_ASSERT_EQUAL_INT(0, *held);
+    TEST_ASSERT_TRUE(queue.claim() == held);
+    TEST_ASSERT_EQUAL_UINT32(3, queue.waiting());
+    TEST_ASSERT_EQUAL_UINT32(0, queue.freeSlots());
+    queue.release();
+    TEST_ASSERT_EQUAL_UINT32(1, queue.freeSlots());
+
+    int value = -1;
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(1, value);
+    TEST_ASSERT_TRUE(queue.push(4));
+    TEST_ASSERT_TRUE(queue.push(5));
+    TEST_ASSERT_FALSE(queue.push(6));
+
+    for (int expected = 2; expected <= 5; ++expected)
+    {
+        TEST_ASSERT_TRUE(queue.pop(value));
+        TEST_ASSERT_EQUAL_INT(expected, value);
+    }
+    TEST_ASSERT_FALSE(queue.pop(value));
+}
+
+void test_cancel_spares_the_held_item()
+{
+    SpscQueue<int, 4> queue;
+    queue.push(1);
+    queue.push(2);
+    queue.push(3);
+
+    int* held = queue.claim();
+    TEST_ASSERT_EQUAL_UINT32(2, queue.cancel());
+    TEST_ASSERT_EQUAL_UINT32(0, queue.waiting());
+    TEST_ASSERT_EQUAL_UINT32(0, queue.cancel());
+
+    // Cancelled slots come back only once the held one is released.
+    TEST_ASSERT_EQUAL_INT(1, *held);
+    queue.reclaim();
+    TEST_ASSERT_EQUAL_UINT32(1, queue.freeSlots());
+    queue.release();
+    TEST_ASSERT_EQUAL_UINT32(4, queue.freeSlots());
+    TEST_ASSERT_NULL(queue.claim());
+
+    // Cancelled with nothing held: claim() hands the slots back.
+    queue.push(4);
+    queue.push(5);
+    queue.cancel();
+    TEST_ASSERT_NULL(queue.claim());
+    TEST_ASSERT_EQUAL_UINT32(4, queue.freeSlots());
+    queue.push(6);
+    int value = 0;
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(6, value);
+}
+
+void test_producer_consumer_stress()
+{
+    SpscQueue<Item, kDepth> queue;
+    std::atomic<bool> producerDone(false);
+    uint64_t cancelled = 0;
+
+    std::thread producer([&] {
+        uint64_t seq = 0;
+        while (seq < kStressItems)
+        {
+            Item* slot = queue.reserve();
+            if (slot == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            slot->seq = seq;
+            slot->check = ~seq;
+            queue.commit();
+            seq++;
+
+            if (seq % kCancelEvery == 0)
+            {
+                cancelled += queue.cancel();
+            }
+        }
+        producerDone.store(true, std::memory_order_release);
+    });
+
+    uint64_t consumed = 0;
+    uint64_t torn = 0;
+    uint64_t outOfOrder = 0;
+    uint64_t next = 0; // lowest sequence number still allowed
+    for (;;)
+    {
+        bool done = producerDone.load(std::memory_order_acquire);
+        Item* item = queue.claim();
+        if (item == nullptr)
+        {
+            if (done)
+            {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+
+        Item copy = *item;
+        if (copy.check != ~copy.seq)
+        {
+            torn++;
+        }
+        if (copy.seq < next)
+        {
+            outOfOrder++;
+        }
+        next = copy.seq + 1;
+
+        // Now and then keep the item over a few claims, as the
+        // transmitter does while a frame is on the wire.
+        if (copy.seq % kHoldEvery == 0)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                if (queue.claim() != item)
+                {
+                    outOfOrder++;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+        queue.release();
+        consumed++;
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, torn);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_TRUE(consumed + cancelled == kStressItems);
+    TEST_ASSERT_GREATER_THAN(0, consumed);
+    TEST_ASSERT_EQUAL_UINT32(0, queue.waiting());
+    TEST_ASSERT_EQUAL_UINT32(kDepth, queue.freeSlots());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_reserve_commit_claim_release);
+    RUN_TEST(test_cancel_spares_the_held_item);
+    RUN_TEST(test_producer_consumer_stress);
+    return UNITY_END();
+}
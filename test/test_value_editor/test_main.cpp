@@ -0,0 +1,157 @@
+// ValueEditor stepping, clamping and how the value is printed.
+//
+//   pio test -e native -f test_value_editor
+
+#include <Arduino.h>
+#include <M5GFX.h>
+#include <ValueEditor.h>
+#include <unity.h>
+
+#include <string>
+
+namespace
+{
+
+// Keeps the text printed at the value's size (3) and drops the rest.
+class TextScreen : public lgfx::LovyanGFX
+{
+  public:
+    int32_t width() const override
+    {
+        return 240;
+    }
+
+    int32_t height() const override
+    {
+        return 135;
+    }
+
+    std::string value;
+
+  protected:
+    void paint(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override
+    {
+    }
+
+    void paintGlyph(int32_t x, int32_t y, int32_t w, int32_t h, char c) override
+    {
+        if (textSize_ == 3)
+        {
+            value += c;
+        }
+    }
+
+    void paintImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data, int32_t stride) override
+    {
+    }
+};
+
+TextScreen* screen;
+ValueEditor* editor;
+
+std::string shown()
+{
+    screen->value.clear();
+    editor->draw();
+    return screen->value;
+}
+
+} // namespace
+
+void setUp()
+{
+    screen = new TextScreen();
+    editor = new ValueEditor(*screen);
+}
+
+void tearDown()
+{
+    delete editor;
+    delete screen;
+}
+
+void test_adjust_moves_by_steps()
+{
+    editor->setRange(0, 100);
+    editor->setStep(5);
+    editor->setValue(50);
+
+    TEST_ASSERT_TRUE(editor->adjust(3));
+    TEST_ASSERT_EQUAL_INT(65, editor->value());
+    TEST_ASSERT_TRUE(editor->adjust(-2));
+    TEST_ASSERT_EQUAL_INT(55, editor->value());
+    TEST_ASSERT_TRUE(editor->increase());
+    TEST_ASSERT_EQUAL_INT(60, editor->value());
+    TEST_ASSERT_TRUE(editor->decrease());
+    TEST_ASSERT_EQUAL_INT(55, editor->value());
+}
+
+void test_adjust_clamps_to_range()
+{
+    editor->setRange(10, 20);
+    editor->setStep(4);
+    editor->setValue(18);
+
+    // Part of a step still reaches the end; past it nothing changes.
+    TEST_ASSERT_TRUE(editor->adjust(1));
+    TEST_ASSERT_EQUAL_INT(20, editor->value());
+    TEST_ASSERT_FALSE(editor->adjust(1));
+    TEST_ASSERT_FALSE(editor->adjust(100));
+    TEST_ASSERT_EQUAL_INT(20, editor->value());
+
+    TEST_ASSERT_TRUE(editor->adjust(-100));
+    TEST_ASSERT_EQUAL_INT(10, editor->value());
+    TEST_ASSERT_FALSE(editor->adjust(-1));
+    TEST_ASSERT_FALSE(editor->adjust(0));
+}
+
+void test_set_value_and_range_clamp()
+{
+    editor->setRange(0, 255);
+    editor->setValue(300);
+    TEST_ASSERT_EQUAL_INT(255, editor->value());
+    editor->setValue(-1);
+    TEST_ASSERT_EQUAL_INT(0, editor->value());
+
+    editor->setValue(200);
+    editor->setRange(0, 127);
+    TEST_ASSERT_EQUAL_INT(127, editor->value());
+}
+
+void test_draws_decimal_with_suffix()
+{
+    editor->setRange(0, 1000);
+    editor->setSuffix(" ms");
+    editor->setValue(250);
+
+    TEST_ASSERT_EQUAL_STRING("250 ms", shown().c_str());
+}
+
+void test_draws_hex_in_two_digits()
+{
+    editor->setRange(0, 255);
+    editor->setHex(true);
+
+    editor->setValue(0x0A);
+    TEST_ASSERT_EQUAL_STRING("0x0A", shown().c_str());
+    editor->setValue(0xFF);
+    TEST_ASSERT_EQUAL_STRING("0xFF", shown().c_str());
+
+    // Stepping is unchanged by the display mode.
+    editor->adjust(-0x10);
+    TEST_ASSERT_EQUAL_STRING("0xEF", shown().c_str());
+
+    editor->setHex(false);
+    TEST_ASSERT_EQUAL_STRING("239", shown().c_str());
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_adjust_moves_by_steps);
+    RUN_TEST(test_adjust_clamps_to_range);
+    RUN_TEST(test_set_value_and_range_clamp);
+    RUN_TEST(test_draws_decimal_with_suffix);
+    RUN_TEST(test_draws_hex_in_two_digits);
+    return UNITY_END();
+}
@@ -0,0 +1,225 @@
+#!/usr/bin/env python3
+"""Build the IR code library image for the "irlib" flash partition, and
+optionally a header of constexpr command tables for remotes built into
+the firmware.
+
+Inputs are LIRC, Pronto, IRDB CSV or the firmware's own CSV; see
+irimport.py. The image layout matches
+lib/IrCodeLibrary/IrCodeLibraryFormat.h and is checked against the irlib
+size in partitions.csv.
+
+    python3 tools/build_irlib.py remotes/*.csv lircd/*.conf -o irlib.bin
+    esptool.py write_flash 0x290000 irlib.bin
+
+The offset is the irlib row of partitions.csv. The firmware picks the
+library up on the next boot; flashing the app leaves it alone.
+"pio run -e m5stick-c -t irlib" does both for everything in remotes/.
+
+    python3 tools/build_irlib.py remotes/lamp.csv --header src/RemoteCommands.h
+
+writes one IrPackedCommandArray per profile, named after it (Lamp ->
+kLampCommands), over a single pool of names. Each command carries its
+protocol as an IrProtocolId, so built-in remotes can mix protocols as
+the image does.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+import irimport
+
+MAGIC = b"IRLB"
+VERSION = 1
+HEADER = struct.Struct("<4sHHIIIIIII")
+PROFILE = struct.Struct("<III")
+COMMAND = struct.Struct("<IHHB3x")
+INDEX = struct.Struct("<I")
+
+PARTITION_LABEL = "irlib"
+
+# irimport's protocol numbers as IrProtocolId enumerators.
+PROTOCOL_IDS = {
+    irimport.NEC: "Nec",
+    irimport.NEC_EXT: "NecExtended",
+    irimport.SAMSUNG32: "Samsung32",
+    irimport.SONY12: "Sony12",
+    irimport.RC5: "Rc5",
+    irimport.RC6: "Rc6",
+}
+REPO = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def align4(offset):
+    return (offset + 3) & ~3
+
+
+def build_image(commands):
+    """Lay out `commands` (file order kept within each profile)."""
+    # Profiles in byte order of their UTF-8 names, as strcmp() sees them.
+    ordered = sorted(commands, key=lambda command: command.profile.encode("utf-8"))
+
+    strings = bytearray()
+    offsets = {}
+
+    def string(text):
+        if text not in offsets:
+            offsets[text] = len(strings)
+            strings.extend(text.encode("utf-8") + b"\0")
+        return offsets[text]
+
+    profiles = []
+    records = []
+    for number, command in enumerate(ordered):
+        if not profiles or command.profile != ordered[profiles[-1][1]].profile:
+            profiles.append([string(command.profile), number, 0])
+        profiles[-1][2] += 1
+        records.append((string(command.name), command.address, command.command, command.protocol))
+
+    code_index = sorted(range(len(ordered)), key=lambda number: (ordered[number].key(), number))
+    if not strings:
+        strings.append(0)
+
+    profiles_offset = align4(HEADER.size)
+    commands_offset = align4(profiles_offset + len(profiles) * PROFILE.size)
+    index_offset = align4(commands_offset + len(records) * COMMAND.size)
+    strings_offset = align4(index_offset + len(code_index) * INDEX.size)
+    image_bytes = strings_offset + len(strings)
+
+    image = bytearray(image_bytes)
+    HEADER.pack_into(image, 0, MAGIC, VERSION, HEADER.size, image_bytes, len(profiles), len(records),
+                     profiles_offset, commands_offset, index_offset, strings_offset)
+    for number, profile in enumerate(profiles):
+        PROFILE.pack_into(image, profiles_offset + number * PROFILE.size, *profile)
+    for number, record in enumerate(records):
+        COMMAND.pack_into(image, commands_offset + number * COMMAND.size, *record)
+    for number, command in enumerate(code_index):
+        INDEX.pack_into(image, index_offset + number * INDEX.size, command)
+    image[strings_offset:] = strings
+    return bytes(image), len(profiles)
+
+
+def partition(path):
+    """Offset and size of the irlib partition in a partition table."""
+    with open(path, encoding="utf-8") as table:
+        for line in table:
+            fields = [field.strip() for field in line.split("#", 1)[0].split(",")]
+            if len(fields) >= 5 and fields[0] == PARTITION_LABEL:
+                return int(fields[3], 0), int(fields[4], 0)
+    raise SystemExit("%s has no %s partition" % (path, PARTITION_LABEL))
+
+
+def write_image(commands, path, capacity):
+    image, profile_count = build_image(commands)
+    if len(image) > capacity:
+        raise SystemExit("image is %d bytes, the %s partition only %d" % (len(image), PARTITION_LABEL, capacity))
+
+    with open(path, "wb") as output:
+        output.write(image)
+    print("%s: %d profiles, %d commands, %d of %d bytes" % (path, profile_count, len(commands), len(image), capacity))
+
+
+def identifier(profile):
+    words = re.findall(r"[A-Za-z0-9]+", profile)
+    name = "".join(word[:1].upper() + word[1:] for word in words)
+    if not name or name[0].isdigit():
+        name = "Remote" + name
+    return name
+
+
+def c_string(text):
+    out = []
+    for byte in text.encode("utf-8"):
+        if byte in (0x22, 0x5C):
+            out.append("\\" + chr(byte))
+        elif 0x20 <= byte < 0x7F:
+            out.append(chr(byte))
+        else:
+            out.append("\\%03o" % byte)
+    return "".join(out)
+
+
+def build_header(commands, sources):
+    """IrPackedCommandArray tables for the commands of each profile, in the
+    order the profiles first appear."""
+    profiles = {}
+    for command in commands:
+        profiles.setdefault(command.profile, []).append(command)
+
+    names = {}
+    pool = []
+    size = 0
+    for profile in profiles.values():
+        for command in profile:
+            if command.name not in names:
+                names[command.name] = size
+                pool.append(command.name)
+                size += len(command.name.encode("utf-8")) + 1
+    if size > 0xFFFF:
+        raise SystemExit("header: %d bytes of names, more than 16-bit offsets reach" % size)
+
+    seen = {}
+    for profile in profiles:
+        name = identifier(profile)
+        if name in seen:
+            raise SystemExit("header: profiles %r and %r both make k%sCommands" % (seen[name], profile, name))
+        seen[name] = profile
+
+    lines = [
+        "// Generated by tools/build_irlib.py from %s." % ", ".join(sources),
+        "// Edit the sources and rebuild rather than this file.",
+        "#ifndef REMOTE_COMMANDS_H",
+        "#define REMOTE_COMMANDS_H",
+        "",
+        "#include <IrCommandList.h>",
+        "",
+        "static constexpr char kRemoteCommandNames[] =",
+    ]
+    lines += ['    "%s\\0"' % c_string(text) for text in pool] or ['    ""']
+    lines[-1] += ";"
+    for profile, entries in profiles.items():
+        name = identifier(profile)
+        lines += ["", "static constexpr IrPackedCommand k%sPackedCommands[] = {" % name]
+        lines += ["    {%d, {IrProtocolId::%s, 0x%02X, 0x%02X}}," % (names[command.name],
+                  PROTOCOL_IDS[command.protocol], command.address, command.command) for command in entries]
+        lines += [
+            "};",
+            "static constexpr IrPackedCommandArray k%sCommands(kRemoteCommandNames, k%sPackedCommands, %d);"
+            % (name, name, len(entries)),
+        ]
+    lines += ["", "#endif", ""]
+    return "\n".join(lines)
+
+
+def write_header(commands, path, sources):
+    """Leaves the file alone when nothing changed, so it does not force a
+    rebuild."""
+    text = build_header(commands, sources)
+    if os.path.exists(path):
+        with open(path, encoding="utf-8") as existing:
+            if existing.read() == text:
+                return
+    with open(path, "w", encoding="utf-8", newline="\n") as output:
+        output.write(text)
+    print("%s: %d built-in remotes" % (path, text.count("IrPackedCommandArray k")))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("inputs", nargs="+", metavar="file[=profile]", help="remote files to merge")
+    parser.add_argument("-o", "--output", help="image to write (irlib.bin unless --header is given)")
+    parser.add_argument("--header", help="C++ header of built-in remotes to write")
+    parser.add_argument("--partitions", default=os.path.join(REPO, "partitions.csv"))
+    args = parser.parse_args()
+
+    commands = irimport.read_files(args.inputs)
+    if args.header:
+        write_header(commands, args.header, [argument.partition("=")[0] for argument in args.inputs])
+    if args.output or not args.header:
+        write_image(commands, args.output or "irlib.bin", partition(args.partitions)[1])
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,392 @@
+"""Read remote definitions into one list of commands.
+
+Every reader returns Command objects in the firmware's own terms: the
+IrProtocolId number and the address and command the encoders in
+lib/IrTransmitter take. NEC-family bytes are as sent MSB first
+(IrNecEncoder), so an IRDB or Pronto code, which numbers bits LSB first,
+comes out bit-reversed.
+
+Formats, picked by extension (or by the CSV's header row):
+
+    .csv            profile,name,protocol,address,command in firmware terms
+    .csv (IRDB)     functionname,protocol,device,subdevice,function
+    .conf, .lircd   LIRC remotes, one profile per "begin remote"
+    .pronto, .txt   "Name: 0000 006D ..." per line; 0000 (learned),
+                    5000 (RC5) and 6000 (RC6) codes
+
+A file's profile is its LIRC remote name, or else the file name without
+its extension; "path=Profile" on the command line names it explicitly.
+Codes that cannot be expressed in a supported protocol are reported and
+left out.
+"""
+
+import csv
+import os
+import re
+import sys
+
+# IrProtocolId: number, address bits, command bits.
+PROTOCOLS = {
+    "nec": (0, 8, 8),
+    "necext": (1, 16, 8),
+    "samsung32": (2, 8, 8),
+    "sony12": (3, 5, 7),
+    "rc5": (4, 5, 7),
+    "rc6": (5, 8, 8),
+}
+NEC, NEC_EXT, SAMSUNG32, SONY12, RC5, RC6 = (PROTOCOLS[name][0] for name in
+                                             ("nec", "necext", "samsung32", "sony12", "rc5", "rc6"))
+PROTOCOL_NAMES = {number: name for name, (number, _, _) in PROTOCOLS.items()}
+
+# Header mark and space, in microseconds.
+NEC_HEADER = (9000, 4500)
+SAMSUNG_HEADER = (4500, 4500)
+SONY_HEADER = (2400, 600)
+TOLERANCE = 0.25
+
+
+class Command:
+    def __init__(self, profile, name, protocol, address, command):
+        self.profile = profile
+        self.name = name
+        self.protocol = protocol
+        self.address = address
+        self.command = command
+
+    def key(self):
+        return (self.protocol, self.address, self.command)
+
+
+class Warnings:
+    """Collects what a file could not import, printed once per file."""
+
+    def __init__(self, path):
+        self.path = path
+        self.skipped = {}
+
+    def skip(self, reason):
+        self.skipped[reason] = self.skipped.get(reason, 0) + 1
+
+    def report(self, out=sys.stderr):
+        for reason, count in sorted(self.skipped.items()):
+            print("%s: skipped %d: %s" % (self.path, count, reason), file=out)
+
+
+def reverse_bits(value, bits):
+    result = 0
+    for _ in range(bits):
+        result = (result << 1) | (value & 1)
+        value >>= 1
+    return result
+
+
+def near(measured, nominal):
+    return abs(measured - nominal) <= nominal * TOLERANCE
+
+
+def near_pair(pair, nominal):
+    return near(pair[0], nominal[0]) and near(pair[1], nominal[1])
+
+
+def parse_number(text):
+    return int(text.strip(), 0)
+
+
+def protocol_entry(text):
+    entry = PROTOCOLS.get(re.sub(r"[\s_]", "", text).lower())
+    if entry is None:
+        raise ValueError("unknown protocol %r" % text)
+    return entry
+
+
+def checked(profile, name, protocol, address, command):
+    """A Command, or ValueError if a field is too wide for the protocol."""
+    _, address_bits, command_bits = PROTOCOLS[PROTOCOL_NAMES[protocol]]
+    if not 0 <= address < (1 << address_bits):
+        raise ValueError("address %#x does not fit %s" % (address, PROTOCOL_NAMES[protocol]))
+    if not 0 <= command < (1 << command_bits):
+        raise ValueError("command %#x does not fit %s" % (command, PROTOCOL_NAMES[protocol]))
+    return Command(profile, name, protocol, address, command)
+
+
+def from_nec_bytes(profile, name, value):
+    """32 bits as sent, MSB first: address | ~address (or a second address
+    byte) | command | ~command."""
+    first, second, command, check = ((value >> shift) & 0xFF for shift in (24, 16, 8, 0))
+    if check != command ^ 0xFF:
+        raise ValueError("command check byte")
+    if second == first ^ 0xFF:
+        return Command(profile, name, NEC, first, command)
+    return Command(profile, name, NEC_EXT, (first << 8) | second, command)
+
+
+def from_samsung_bytes(profile, name, value):
+    first, second, command, check = ((value >> shift) & 0xFF for shift in (24, 16, 8, 0))
+    if first != second or check != command ^ 0xFF:
+        raise ValueError("not a Samsung32 code")
+    return Command(profile, name, SAMSUNG32, first, command)
+
+
+def from_sony_bits(profile, name, value, bits):
+    """Sony sends LSB first; `value` holds the bits as sent, first bit
+    highest, as LIRC and the pulse decoder below give them."""
+    if bits != 12:
+        raise ValueError("Sony%d" % bits)
+    sent = reverse_bits(value, 12)
+    return Command(profile, name, SONY12, sent >> 7, sent & 0x7F)
+
+
+def from_pulses(profile, name, header, value, bits):
+    if near_pair(header, NEC_HEADER) and bits == 32:
+        return from_nec_bytes(profile, name, value)
+    if near_pair(header, SAMSUNG_HEADER) and bits == 32:
+        return from_samsung_bytes(profile, name, value)
+    if near_pair(header, SONY_HEADER):
+        return from_sony_bits(profile, name, value, bits)
+    raise ValueError("unrecognised timing")
+
+
+# --- firmware CSV -----------------------------------------------------------
+
+def read_firmware_csv(rows, path, profile):
+    commands = []
+    for line, row in enumerate(rows, start=2):
+        try:
+            number, _, _ = protocol_entry(row["protocol"])
+            commands.append(checked(row.get("profile", "").strip() or profile, row["name"].strip(), number,
+                                    parse_number(row["address"]), parse_number(row["command"])))
+        except (KeyError, AttributeError, ValueError) as error:
+            raise SystemExit("%s:%d: %s" % (path, line, error))
+    return commands
+
+
+# --- IRDB CSV ---------------------------------------------------------------
+
+def from_irdb(profile, name, protocol, device, subdevice, function):
+    protocol = protocol.strip().lower()
+    if protocol in ("nec", "nec1", "nec2"):
+        if subdevice < 0 or subdevice == device ^ 0xFF:
+            return checked(profile, name, NEC, reverse_bits(device, 8), reverse_bits(function, 8))
+        return checked(profile, name, NEC_EXT, (reverse_bits(device, 8) << 8) | reverse_bits(subdevice, 8),
+                       reverse_bits(function, 8))
+    if protocol in ("necx1", "necx2"):
+        if subdevice >= 0 and subdevice != device:
+            raise ValueError("NECx with a different subdevice")
+        return checked(profile, name, SAMSUNG32, reverse_bits(device, 8), reverse_bits(function, 8))
+    if protocol == "sony12":
+        return checked(profile, name, SONY12, device, function)
+    if protocol == "rc5":
+        return checked(profile, name, RC5, device, function)
+    if protocol == "rc6":
+        return checked(profile, name, RC6, device, function)
+    raise ValueError("protocol %s" % protocol)
+
+
+def read_irdb_csv(rows, profile, warnings):
+    commands = []
+    for row in rows:
+        try:
+            commands.append(from_irdb(profile, row["functionname"].strip(), row["protocol"],
+                                      int(row["device"]), int(row["subdevice"]), int(row["function"])))
+        except (KeyError, AttributeError, TypeError, ValueError) as error:
+            warnings.skip(str(error))
+    return commands
+
+
+def read_csv_file(path, profile, warnings):
+    with open(path, newline="", encoding="utf-8") as source:
+        rows = csv.DictReader(source)
+        fields = [field.strip().lower() for field in rows.fieldnames or []]
+        rows.fieldnames = fields
+        if "functionname" in fields:
+            return read_irdb_csv(rows, profile, warnings)
+        return read_firmware_csv(rows, path, profile)
+
+
+# --- LIRC -------------------------------------------------------------------
+
+def lirc_command(remote, name, code):
+    flags = remote.get("flags", "").upper()
+    if "RAW_CODES" in flags:
+        raise ValueError("raw codes")
+
+    bits = int(remote.get("bits", "0"), 0)
+    pre_bits = int(remote.get("pre_data_bits", "0"), 0)
+    post_bits = int(remote.get("post_data_bits", "0"), 0)
+    value = (int(remote.get("pre_data", "0"), 0) << bits) | code
+    value = (value << post_bits) | int(remote.get("post_data", "0"), 0)
+    bits += pre_bits + post_bits
+    profile = remote["name"]
+
+    if "RC5" in flags:
+        # Second start bit (the inverted RC5X command bit), toggle, 5
+        # address bits, 6 command bits; a leading first start bit is
+        # optional.
+        if bits == 14:
+            bits, value = 13, value & 0x1FFF
+        if bits != 13:
+            raise ValueError("RC5 with %d bits" % bits)
+        extended = 0 if value & 0x1000 else 0x40
+        return checked(profile, name, RC5, (value >> 6) & 0x1F, (value & 0x3F) | extended)
+    if "RC6" in flags:
+        # Leader, mode, toggle, then address and command.
+        if bits >= 20 and (value >> 17) & 0x7 != 0:
+            raise ValueError("RC6 mode other than 0")
+        return checked(profile, name, RC6, (value >> 8) & 0xFF, value & 0xFF)
+
+    header = tuple(int(part, 0) for part in remote.get("header", "0 0").split()[:2])
+    return from_pulses(profile, name, header, value, bits)
+
+
+def read_lirc(path, profile, warnings):
+    commands = []
+    remote = None
+    in_codes = False
+    in_raw = False
+    with open(path, encoding="utf-8", errors="replace") as source:
+        for line in source:
+            words = line.split("#", 1)[0].split()
+            if not words:
+                continue
+            keyword = words[0].lower()
+            if keyword == "begin" and len(words) > 1:
+                block = words[1].lower()
+                if block == "remote":
+                    remote = {"name": profile}
+                elif block == "codes":
+                    in_codes = True
+                elif block == "raw_codes":
+                    in_raw = True
+                continue
+            if keyword == "end" and len(words) > 1:
+                block = words[1].lower()
+                if block == "remote":
+                    remote = None
+                elif block == "codes":
+                    in_codes = False
+                elif block == "raw_codes":
+                    in_raw = False
+                continue
+            if remote is None:
+                continue
+
+            if in_raw:
+                if keyword == "name":
+                    warnings.skip("raw codes")
+            elif in_codes:
+                try:
+                    commands.append(lirc_command(remote, words[0], int(words[1], 0)))
+                except (IndexError, ValueError) as error:
+                    warnings.skip(str(error))
+            elif len(words) > 1:
+                remote[keyword] = " ".join(words[1:]) if keyword != "name" else words[1]
+    return commands
+
+
+# --- Pronto -----------------------------------------------------------------
+
+def pronto_command(profile, name, words):
+    kind = words[0]
+    if kind == 0x5000 and len(words) >= 6:
+        return checked(profile, name, RC5, words[4], words[5])
+    if kind == 0x6000 and len(words) >= 6:
+        return checked(profile, name, RC6, words[4], words[5])
+    if kind != 0x0000 or len(words) < 4:
+        raise ValueError("Pronto type %04X" % kind)
+
+    once, repeat = words[2], words[3]
+    if len(words) < 4 + 2 * (once + repeat):
+        raise ValueError("short Pronto code")
+    pairs = once if once else repeat
+    start = 4 if once else 4 + 2 * once
+    tick = words[1] * 0.241246  # us per carrier cycle
+    timing = [(words[start + 2 * i] * tick, words[start + 2 * i + 1] * tick) for i in range(pairs)]
+    if len(timing) < 2:
+        raise ValueError("too few pulses")
+
+    header, body = timing[0], timing[1:]
+    if near_pair(header, SONY_HEADER):
+        # Pulse width: a long mark is a one; the last space is the gap.
+        value = 0
+        for mark, _ in body:
+            value = (value << 1) | (1 if mark > 900 else 0)
+        return from_pulses(profile, name, header, value, len(body))
+
+    # Pulse distance: a long space is a one; a stop mark ends the frame.
+    bits = body[:32]
+    value = 0
+    for _, space in bits:
+        value = (value << 1) | (1 if space > 1120 else 0)
+    return from_pulses(profile, name, header, value, len(bits) if len(body) > 32 else 0)
+
+
+def read_pronto(path, profile, warnings):
+    commands = []
+    with open(path, encoding="utf-8", errors="replace") as source:
+        for line in source:
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            name, separator, code = line.partition(":")
+            if not separator:
+                warnings.skip("line without a name")
+                continue
+            try:
+                words = [int(word, 16) for word in code.split()]
+                commands.append(pronto_command(profile, name.strip(), words))
+            except ValueError as error:
+                warnings.skip(str(error))
+    return commands
+
+
+# --- everything together ----------------------------------------------------
+
+READERS = {
+    ".csv": read_csv_file,
+    ".conf": read_lirc,
+    ".lircd": read_lirc,
+    ".pronto": read_pronto,
+    ".txt": read_pronto,
+}
+
+
+def read_file(argument, out=sys.stderr):
+    """`argument` is a path, or path=Profile."""
+    path, _, profile = argument.partition("=")
+    if not profile:
+        base = os.path.basename(path)
+        profile = base.split(".", 1)[0] if not base.startswith(".") else base
+
+    reader = READERS.get(os.path.splitext(path)[1].lower())
+    if reader is None:
+        raise SystemExit("%s: unknown format" % path)
+    warnings = Warnings(path)
+    commands = reader(path, profile, warnings)
+    warnings.report(out)
+    return commands
+
+
+def deduplicate(commands, out=sys.stderr):
+    """Drops repeats within a profile: the same code again, or the same
+    name for a second code. The first one wins."""
+    seen_codes = set()
+    seen_names = set()
+    kept = []
+    for command in commands:
+        code = (command.profile, command.key())
+        name = (command.profile, command.name)
+        if code in seen_codes or name in seen_names:
+            continue
+        seen_codes.add(code)
+        seen_names.add(name)
+        kept.append(command)
+    if len(kept) != len(commands):
+        print("dropped %d duplicate commands" % (len(commands) - len(kept)), file=out)
+    return kept
+
+
+def read_files(arguments, out=sys.stderr):
+    commands = []
+    for argument in arguments:
+        commands.extend(read_file(argument, out))
+    return deduplicate(commands, out)
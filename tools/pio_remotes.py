@@ -0,0 +1,42 @@
+"""PlatformIO pre-script for the remotes in remotes/.
+
+Regenerates src/RemoteCommands.h from the files named in
+custom_builtin_remotes, and on the ESP32 adds an "irlib" target that
+builds every file in remotes/ into the code library and flashes it to
+the irlib partition:
+
+    pio run -e m5stick-c -t irlib
+"""
+
+import glob
+import os
+import sys
+
+Import("env")  # noqa: F821 -- provided by SCons
+
+project = env.subst("$PROJECT_DIR")  # noqa: F821
+sys.path.insert(0, os.path.join(project, "tools"))
+
+import build_irlib  # noqa: E402
+import irimport  # noqa: E402
+
+builtin = env.GetProjectOption("custom_builtin_remotes", "").split()  # noqa: F821
+if builtin:
+    build_irlib.write_header(irimport.read_files([os.path.join(project, path) for path in builtin]),
+                             os.path.join(project, "src", "RemoteCommands.h"), builtin)
+
+if env.get("PIOPLATFORM") == "espressif32":  # noqa: F821
+    offset, capacity = build_irlib.partition(os.path.join(project, "partitions.csv"))
+    image = os.path.join(env.subst("$BUILD_DIR"), "irlib.bin")  # noqa: F821
+
+    def build_library(target, source, env):
+        remotes = sorted(glob.glob(os.path.join(project, "remotes", "*.*")))
+        build_irlib.write_image(irimport.read_files(remotes), image, capacity)
+
+    env.AddCustomTarget(  # noqa: F821
+        name="irlib",
+        dependencies=None,
+        actions=[build_library, '"$PYTHONEXE" "$UPLOADER" --chip esp32 write_flash 0x%x "%s"' % (offset, image)],
+        title="IR code library",
+        description="Build remotes/ into the irlib partition and flash it",
+    )